@@ -0,0 +1,105 @@
+// arena基准：模拟每个请求构建几千个小容器，请求结束时全部丢弃
+//   每个请求 2000 个 int 容器，大小在 0..32 之间（N=8，约3/4会溢出到堆上），逐个push_back填充
+//   global heap   std::vector / minivector 用全局堆（malloc），请求结束时逐个释放
+//   arena         minivector + arena_allocator：从 monotonic_arena 切分，请求结束时 reset()
+//   pmr           pmr_minivector / std::pmr::vector 通过 memory_resource 虚函数分配
+//   std::pmr::monotonic_buffer_resource 作为参照（每个请求结束时 release()，块全部还给上游）
+// 单位：微秒/请求
+// 用法: ./arena_bench [请求数，默认2000] [每个请求的容器数，默认2000]
+#include "arena.hpp"
+#include "minivector.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template<typename P>
+static void escape(const P& p)
+{
+    asm volatile("" : : "g"(&p) : "memory");
+}
+
+// make_vec() 返回一个空容器；Before/After 在每个请求前后调用（创建/重置arena）
+template<typename Vec, typename MakeVec, typename Before, typename After>
+static void run(const char* name, long requests, const std::vector<int>& sizes, MakeVec make_vec, Before before,
+                After after)
+{
+    std::vector<Vec> live;
+    live.reserve(sizes.size());
+    long sum = 0;
+    auto start = Clock::now();
+    for(long r = 0; r < requests; r++)
+    {
+        before();
+        for(int size : sizes)
+        {
+            live.push_back(make_vec());
+            Vec& v = live.back();
+            for(int i = 0; i < size; i++) v.push_back(i);
+        }
+        for(const Vec& v : live) sum += static_cast<long>(v.size());
+        escape(live);
+        live.clear(); // 请求结束：所有容器析构
+        after();
+    }
+    double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / requests;
+    std::cout << std::left << std::setw(44) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << us << std::setw(14) << us * 1000 / sizes.size() << "   (" << sum / requests
+              << " elements/request)" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    long requests = argc > 1 ? std::stol(argv[1]) : 2000;
+    size_t per_request = argc > 2 ? std::stoul(argv[2]) : 2000;
+
+    std::vector<int> sizes(per_request);
+    std::mt19937 rng(42);
+    for(int& s : sizes) s = static_cast<int>(rng() % 33);
+
+    std::cout << requests << " requests x " << per_request << " vectors of 0..32 ints\n\n"
+              << std::left << std::setw(44) << "" << std::right << std::setw(12) << "us/request" << std::setw(14)
+              << "ns/vector" << std::endl;
+
+    auto nothing = []() {};
+
+    run<std::vector<int>>("std::vector (global heap)", requests, sizes, []() { return std::vector<int>(); },
+                          nothing, nothing);
+    run<minivector<int, 8>>("minivector<8> (global heap)", requests, sizes, []() { return minivector<int, 8>(); },
+                            nothing, nothing);
+
+    {
+        monotonic_arena arena;
+        using Vec = minivector<int, 8, arena_allocator<int>>;
+        run<Vec>("minivector<8> + arena_allocator", requests, sizes, [&]() { return Vec(arena_allocator<int>(arena)); },
+                 nothing, [&]() { arena.reset(); });
+        std::cout << "    arena after last request: " << arena.chunk_count() << " chunk(s)" << std::endl;
+    }
+    {
+        monotonic_arena arena;
+        std::pmr::polymorphic_allocator<int> alloc(&arena);
+        run<pmr_minivector<int, 8>>("pmr_minivector<8> + monotonic_arena", requests, sizes,
+                                    [&]() { return pmr_minivector<int, 8>(alloc); }, nothing, [&]() { arena.reset(); });
+    }
+    {
+        monotonic_arena arena;
+        std::pmr::polymorphic_allocator<int> alloc(&arena);
+        run<std::pmr::vector<int>>("std::pmr::vector + monotonic_arena", requests, sizes,
+                                   [&]() { return std::pmr::vector<int>(alloc); }, nothing, [&]() { arena.reset(); });
+    }
+    {
+        // 标准库的单调资源：release() 会把所有块还给上游，下一个请求重新申请
+        std::pmr::monotonic_buffer_resource resource;
+        std::pmr::polymorphic_allocator<int> alloc(&resource);
+        run<pmr_minivector<int, 8>>("pmr_minivector<8> + std monotonic_buffer", requests, sizes,
+                                    [&]() { return pmr_minivector<int, 8>(alloc); }, nothing,
+                                    [&]() { resource.release(); });
+    }
+    return 0;
+}
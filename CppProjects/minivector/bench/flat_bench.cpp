@@ -0,0 +1,269 @@
+// flat_set / flat_map 基准：与节点容器（std::set / std::map / std::unordered_map）比较，元素个数 8 .. 100000
+//   insert   逐个插入n个随机键建表（含析构）
+//   bulk     用区间一次建表（flat_*：追加后排序、去重）
+//   find     随机查找，一半命中
+//   iterate  顺序遍历
+//   churn    删除一个已有的键再插入一个新键，大小不变（flat_* 每次都要移动后半段）
+// "std::vector + lower_bound" 是同样的有序数组但用 std::lower_bound 查找，对比无分支二分的效果
+// 最后一组模拟 stretype.cpp 的 client_fds（std::set<int, std::greater<int>>）：
+//   断开一个连接、取 *begin() 更新 max_fd、新连接复用这个fd、再遍历全部fd（FD_SET）
+// 单位：纳秒/元素（或纳秒/次操作）
+// 用法: ./flat_bench [最大元素个数，默认100000]
+#include "flat_map.hpp"
+#include "flat_set.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template<typename P>
+static void escape(const P& p)
+{
+    asm volatile("" : : "g"(&p) : "memory");
+}
+
+// 对照组：有序std::vector，查找用std::lower_bound（有分支的二分）
+class sorted_vector
+{
+    private:
+        std::vector<int> data;
+
+    public:
+        using value_type = int;
+
+        sorted_vector() = default;
+
+        template<typename It>
+        sorted_vector(It first, It last) : data(first, last)
+        {
+            std::sort(data.begin(), data.end());
+            data.erase(std::unique(data.begin(), data.end()), data.end());
+        }
+
+        std::vector<int>::const_iterator begin() const { return data.begin(); }
+        std::vector<int>::const_iterator end() const { return data.end(); }
+        size_t size() const { return data.size(); }
+
+        std::vector<int>::const_iterator find(int key) const
+        {
+            auto it = std::lower_bound(data.begin(), data.end(), key);
+            return it != data.end() and *it == key ? it : data.end();
+        }
+
+        void insert(int key)
+        {
+            auto it = std::lower_bound(data.begin(), data.end(), key);
+            if(it == data.end() or *it != key) data.insert(it, key);
+        }
+
+        size_t erase(int key)
+        {
+            auto it = std::lower_bound(data.begin(), data.end(), key);
+            if(it == data.end() or *it != key) return 0;
+            data.erase(it);
+            return 1;
+        }
+};
+
+template<typename C, typename = void>
+struct is_map : std::false_type {};
+
+template<typename C>
+struct is_map<C, std::void_t<typename C::mapped_type>> : std::true_type {};
+
+template<typename C>
+static void add(C& c, int key)
+{
+    if constexpr(is_map<C>::value) c.emplace(key, key);
+    else c.insert(key);
+}
+
+template<typename C>
+static long value_of(const C&, const typename C::value_type& v)
+{
+    if constexpr(is_map<C>::value) return v.second;
+    else return v;
+}
+
+template<typename F>
+static double time_ns(long ops, F f)
+{
+    auto start = Clock::now();
+    f();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+struct workload
+{
+    std::vector<int> keys;    // 互不相同
+    std::vector<int> lookups; // 一半来自keys
+    std::vector<int> fresh;   // 不在keys里，churn时插入
+};
+
+static workload make_workload(size_t n)
+{
+    std::mt19937 rng(static_cast<unsigned>(n));
+    std::set<int> seen;
+    workload w;
+    while(w.keys.size() < n)
+    {
+        int k = static_cast<int>(rng() >> 1);
+        if(seen.insert(k).second) w.keys.push_back(k);
+    }
+    for(int i = 0; i < 1000000; i++)
+        w.lookups.push_back(i % 2 ? w.keys[rng() % n] : static_cast<int>(rng() >> 1));
+    while(w.fresh.size() < 20000)
+    {
+        int k = static_cast<int>(rng() >> 1);
+        if(seen.insert(k).second) w.fresh.push_back(k);
+    }
+    return w;
+}
+
+template<typename C>
+static void run(const char* name, const workload& w)
+{
+    size_t n = w.keys.size();
+    long reps = std::max(1L, 400000L / static_cast<long>(n));
+    long check = 0;
+
+    double insert = time_ns(reps * static_cast<long>(n), [&]()
+    {
+        for(long r = 0; r < reps; r++)
+        {
+            C c;
+            for(int k : w.keys) add(c, k);
+            check += static_cast<long>(c.size());
+        }
+    });
+
+    using value_type = std::conditional_t<is_map<C>::value, std::pair<int, int>, int>;
+    std::vector<value_type> values;
+    for(int k : w.keys)
+    {
+        if constexpr(is_map<C>::value) values.emplace_back(k, k);
+        else values.push_back(k);
+    }
+    double bulk = time_ns(reps * static_cast<long>(n), [&]()
+    {
+        for(long r = 0; r < reps; r++)
+        {
+            C c(values.begin(), values.end());
+            check += static_cast<long>(c.size());
+        }
+    });
+
+    C c(values.begin(), values.end());
+    double find = time_ns(static_cast<long>(w.lookups.size()), [&]()
+    {
+        long hits = 0;
+        for(int k : w.lookups) hits += c.find(k) != c.end();
+        check += hits;
+    });
+
+    long passes = std::max(1L, 2000000L / static_cast<long>(n));
+    double iterate = time_ns(passes * static_cast<long>(n), [&]()
+    {
+        for(long p = 0; p < passes; p++)
+        {
+            long sum = 0;
+            for(const auto& v : c) sum += value_of(c, v);
+            check += sum;
+            escape(c);
+        }
+    });
+
+    long churn_ops = static_cast<long>(w.fresh.size());
+    double churn = time_ns(churn_ops, [&]()
+    {
+        for(long i = 0; i < churn_ops; i++)
+        {
+            c.erase(w.keys[static_cast<size_t>(i) % n]);
+            add(c, w.fresh[static_cast<size_t>(i)]);
+            add(c, w.keys[static_cast<size_t>(i) % n]); // 放回去，下一轮还能删到
+            c.erase(w.fresh[static_cast<size_t>(i)]);
+        }
+        escape(c);
+    }) / 2;
+
+    std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << insert << std::setw(10) << bulk << std::setw(10) << find << std::setprecision(2)
+              << std::setw(10) << iterate << std::setprecision(1) << std::setw(10) << churn << "   (checksum "
+              << check % 1000 << ")" << std::endl;
+}
+
+// stretype.cpp 的fd集合：按降序排列，*begin() 就是最大的fd
+template<typename Set>
+static void run_fds(const char* name, int count, long rounds)
+{
+    Set fds;
+    for(int fd = 4; fd < 4 + count; fd++) fds.insert(fd);
+    std::mt19937 rng(1);
+    long check = 0;
+    double ns = time_ns(rounds, [&]()
+    {
+        for(long r = 0; r < rounds; r++)
+        {
+            int fd = 4 + static_cast<int>(rng() % static_cast<unsigned>(count));
+            fds.erase(fd);
+            int max_fd = fds.empty() ? 3 : *fds.begin();
+            fds.insert(fd); // accept() 复用最小的空闲fd
+            max_fd = std::max(max_fd, *fds.begin());
+            long mask = 0;
+            for(int f : fds) mask ^= f; // select前逐个FD_SET
+            check += max_fd + mask;
+        }
+    });
+    std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << ns << "   (checksum " << check % 1000 << ")" << std::endl;
+}
+
+template<typename... Containers>
+struct suite
+{
+    template<typename... Names>
+    static void run_all(const workload& w, Names... names)
+    {
+        (run<Containers>(names, w), ...);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    size_t largest = argc > 1 ? std::stoul(argv[1]) : 100000;
+    std::cout << "ns per element / operation" << std::endl;
+    for(size_t n : {8, 64, 512, 4096, 32768, 100000})
+    {
+        if(n > largest) break;
+        workload w = make_workload(n);
+        std::cout << "\n" << std::left << std::setw(30) << (std::to_string(n) + " elements") << std::right
+                  << std::setw(10) << "insert" << std::setw(10) << "bulk" << std::setw(10) << "find" << std::setw(10)
+                  << "iterate" << std::setw(10) << "churn" << std::endl;
+        suite<std::set<int>, sorted_vector, flat_set<int>>::run_all(w, "  std::set<int>", "  std::vector + lower_bound",
+                                                                    "  flat_set<int>");
+        suite<std::map<int, int>, std::unordered_map<int, int>, flat_map<int, int>>::run_all(
+            w, "  std::map<int, int>", "  std::unordered_map<int, int>", "  flat_map<int, int>");
+    }
+
+    std::cout << "\nselect fd set (erase, max_fd, insert, walk), ns per round" << std::endl;
+    for(int count : {16, 64, 512})
+    {
+        std::string n = std::to_string(count);
+        run_fds<std::set<int, std::greater<int>>>(("  std::set<int, greater>, " + n + " fds").c_str(), count, 200000);
+        run_fds<flat_set<int, std::greater<int>, 64>>(("  flat_set<int, greater, 64>, " + n + " fds").c_str(), count,
+                                                      200000);
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+// minivector基准：与std::vector比较，元素类型分小（int）、大（64字节的平凡类型）、不可按字节搬家（std::string）
+//   push small   反复构造只有8个元素的容器（minivector放在内联缓冲区里，不分配）
+//   push large   不预留容量追加100万个元素（扩容次数与每次搬家的代价）
+//   insert front 在头部插入直到4000个元素（每次后移整个数组）
+//   erase front  从头部删除直到为空
+//   iterate      顺序遍历100万个元素求和
+// 单位：纳秒/元素（或纳秒/次操作）
+// 用法: ./minivector_bench [large的元素个数，默认1000000]
+#include "minivector.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template<typename P>
+static void escape(const P& p)
+{
+    asm volatile("" : : "g"(&p) : "memory");
+}
+
+struct Big
+{
+    long fields[8];
+};
+
+template<typename T>
+static T make(long i);
+
+template<>
+int make<int>(long i) { return static_cast<int>(i); }
+
+template<>
+Big make<Big>(long i) { return Big{{i, i, i, i, i, i, i, i}}; }
+
+// 超过SSO长度，拷贝时要分配；移动只是换指针
+template<>
+std::string make<std::string>(long i) { return std::string(24, static_cast<char>('a' + i % 26)); }
+
+static long value_of(int x) { return x; }
+static long value_of(const Big& x) { return x.fields[7]; }
+static long value_of(const std::string& x) { return static_cast<long>(x.size()); }
+
+template<typename F>
+static double time_ns(long ops, F f)
+{
+    auto start = Clock::now();
+    f();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+template<typename Vec>
+static void run(const char* name, long large)
+{
+    using T = typename Vec::value_type;
+    const long small_rounds = 200000, small_size = 8, edge = 4000;
+
+    double push_small = time_ns(small_rounds * small_size, [&]()
+    {
+        for(long r = 0; r < small_rounds; r++)
+        {
+            Vec v;
+            for(long i = 0; i < small_size; i++) v.push_back(make<T>(i));
+            escape(v);
+        }
+    });
+
+    Vec big;
+    double push_large = time_ns(large, [&]()
+    {
+        for(long i = 0; i < large; i++) big.push_back(make<T>(i));
+        escape(big);
+    });
+
+    long sum = 0;
+    const int passes = 20;
+    double iterate = time_ns(large * passes, [&]()
+    {
+        for(int p = 0; p < passes; p++)
+            for(const T& x : big) sum += value_of(x);
+    });
+
+    Vec v;
+    double insert_front = time_ns(edge, [&]()
+    {
+        for(long i = 0; i < edge; i++) v.insert(v.begin(), make<T>(i));
+    });
+    double erase_front = time_ns(edge, [&]()
+    {
+        while(!v.empty()) v.erase(v.begin());
+    });
+
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << push_small << std::setw(12) << push_large << std::setw(14) << insert_front
+              << std::setw(13) << erase_front << std::setw(10) << iterate << "   (checksum " << sum % 1000 << ")"
+              << std::endl;
+}
+
+template<typename T>
+static void compare(const char* type, long large)
+{
+    std::cout << "\n" << std::left << std::setw(28) << type << std::right << std::setw(12) << "push small"
+              << std::setw(12) << "push large" << std::setw(14) << "insert front" << std::setw(13) << "erase front"
+              << std::setw(10) << "iterate" << std::endl;
+    run<std::vector<T>>("  std::vector", large);
+    run<minivector<T, 16>>("  minivector<16>", large);
+}
+
+int main(int argc, char* argv[])
+{
+    long large = argc > 1 ? std::stol(argv[1]) : 1000000;
+    std::cout << "ns per element / operation" << std::endl;
+    compare<int>("int", large);
+    compare<Big>("Big (64 bytes)", large);
+    compare<std::string>("std::string", large);
+    return 0;
+}
@@ -0,0 +1,201 @@
+// soa_vector基准：一张连接表（每行7个字段，AoS一行48字节），比较只扫描某一列时 AoS 与 SoA 的差别
+//   fill         逐行push_back（不预留容量）
+//   sum bytes_in 对一个8字节字段求和：AoS每行要把48字节读进缓存，SoA只读8字节
+//   idle count   统计 last_active 早于阈值的连接（超时扫描）
+//   touch        给一个字段加1（读写同一列）
+//   whole row    每行所有字段都用到：AoS一行在一条缓存行里，SoA要同时读7个数组
+// SoA分两种访问：column<I>() 拿到的连续数组；以及通过行代理 std::get<I>(row)
+// 单位：纳秒/行
+// 用法: ./soa_bench [行数，默认10000000] [每项重复次数，默认5]
+#include "soa_vector.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template<typename P>
+static void escape(const P& p)
+{
+    asm volatile("" : : "g"(&p) : "memory");
+}
+
+struct conn
+{
+    int32_t fd;
+    uint32_t events;
+    int64_t last_active;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t requests;
+    uint32_t state;
+};
+
+static_assert(sizeof(conn) == 48, "conn layout");
+
+// 字段顺序与conn相同
+using conn_table = soa_vector<int32_t, uint32_t, int64_t, uint64_t, uint64_t, uint64_t, uint32_t>;
+enum { FD, EVENTS, LAST_ACTIVE, BYTES_IN, BYTES_OUT, REQUESTS, STATE };
+
+static conn make_conn(long i)
+{
+    uint64_t x = static_cast<uint64_t>(i) * 2654435761u;
+    return conn{static_cast<int32_t>(i), static_cast<uint32_t>(x & 7), static_cast<int64_t>(x % 100000),
+                x % 65536, x % 4096, x % 100, static_cast<uint32_t>(i & 3)};
+}
+
+template<typename F>
+static double time_ns(long rows, int passes, F f)
+{
+    auto start = Clock::now();
+    for(int p = 0; p < passes; p++) f();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / rows / passes;
+}
+
+static void row_header()
+{
+    std::cout << std::left << std::setw(24) << "" << std::right << std::setw(10) << "fill" << std::setw(14)
+              << "sum bytes_in" << std::setw(12) << "idle count" << std::setw(10) << "touch" << std::setw(12)
+              << "whole row" << std::endl;
+}
+
+static void report(const char* name, double fill, double sum, double idle, double touch, double whole, uint64_t check)
+{
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2);
+    if(fill < 0) std::cout << std::setw(10) << "-";
+    else std::cout << std::setw(10) << fill;
+    std::cout << std::setw(14) << sum << std::setw(12) << idle << std::setw(10) << touch << std::setw(12) << whole
+              << "   (checksum " << check % 1000 << ")" << std::endl;
+}
+
+static void run_aos(long rows, int passes)
+{
+    std::vector<conn> table;
+    double fill = time_ns(rows, 1, [&]()
+    {
+        for(long i = 0; i < rows; i++) table.push_back(make_conn(i));
+        escape(table);
+    });
+
+    uint64_t check = 0;
+    double sum = time_ns(rows, passes, [&]()
+    {
+        uint64_t s = 0;
+        for(const conn& c : table) s += c.bytes_in;
+        check += s;
+    });
+    double idle = time_ns(rows, passes, [&]()
+    {
+        uint64_t n = 0;
+        for(const conn& c : table) n += c.last_active < 5000;
+        check += n;
+    });
+    double touch = time_ns(rows, passes, [&]()
+    {
+        for(conn& c : table) c.requests++;
+        escape(table);
+    });
+    double whole = time_ns(rows, passes, [&]()
+    {
+        uint64_t s = 0;
+        for(const conn& c : table)
+            s += static_cast<uint64_t>(c.fd) + c.events + static_cast<uint64_t>(c.last_active) + c.bytes_in + c.bytes_out
+                 + c.requests + c.state;
+        check += s;
+    });
+    report("AoS std::vector<conn>", fill, sum, idle, touch, whole, check);
+}
+
+static void run_soa(long rows, int passes)
+{
+    conn_table table;
+    double fill = time_ns(rows, 1, [&]()
+    {
+        for(long i = 0; i < rows; i++)
+        {
+            conn c = make_conn(i);
+            table.emplace_back(c.fd, c.events, c.last_active, c.bytes_in, c.bytes_out, c.requests, c.state);
+        }
+        escape(table);
+    });
+
+    uint64_t check = 0;
+    double sum = time_ns(rows, passes, [&]()
+    {
+        uint64_t s = 0;
+        for(uint64_t b : table.column<BYTES_IN>()) s += b;
+        check += s;
+    });
+    double idle = time_ns(rows, passes, [&]()
+    {
+        uint64_t n = 0;
+        for(int64_t t : table.column<LAST_ACTIVE>()) n += t < 5000;
+        check += n;
+    });
+    double touch = time_ns(rows, passes, [&]()
+    {
+        for(uint64_t& r : table.column<REQUESTS>()) r++;
+        escape(table);
+    });
+    double whole = time_ns(rows, passes, [&]()
+    {
+        const int32_t* fd = table.data<FD>();
+        const uint32_t* events = table.data<EVENTS>();
+        const int64_t* last = table.data<LAST_ACTIVE>();
+        const uint64_t* in = table.data<BYTES_IN>();
+        const uint64_t* out = table.data<BYTES_OUT>();
+        const uint64_t* req = table.data<REQUESTS>();
+        const uint32_t* state = table.data<STATE>();
+        uint64_t s = 0;
+        for(size_t i = 0, n = table.size(); i < n; i++)
+            s += static_cast<uint64_t>(fd[i]) + events[i] + static_cast<uint64_t>(last[i]) + in[i] + out[i] + req[i]
+                 + state[i];
+        check += s;
+    });
+    report("SoA column<I>()", fill, sum, idle, touch, whole, check);
+
+    // 同一张表，通过行代理访问：看编译器能否把tuple的引用优化掉
+    check = 0;
+    sum = time_ns(rows, passes, [&]()
+    {
+        uint64_t s = 0;
+        for(auto row : table) s += std::get<BYTES_IN>(row);
+        check += s;
+    });
+    idle = time_ns(rows, passes, [&]()
+    {
+        uint64_t n = 0;
+        for(auto row : table) n += std::get<LAST_ACTIVE>(row) < 5000;
+        check += n;
+    });
+    touch = time_ns(rows, passes, [&]()
+    {
+        for(auto row : table) std::get<REQUESTS>(row)++;
+        escape(table);
+    });
+    whole = time_ns(rows, passes, [&]()
+    {
+        uint64_t s = 0;
+        for(auto [fd, events, last, in, out, req, state] : table)
+            s += static_cast<uint64_t>(fd) + events + static_cast<uint64_t>(last) + in + out + req + state;
+        check += s;
+    });
+    report("SoA row proxy", -1, sum, idle, touch, whole, check);
+}
+
+int main(int argc, char* argv[])
+{
+    long rows = argc > 1 ? std::stol(argv[1]) : 10000000;
+    int passes = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    std::cout << rows << " rows, AoS " << rows * sizeof(conn) / (1 << 20) << " MB, one 8-byte column "
+              << rows * sizeof(uint64_t) / (1 << 20) << " MB; ns per row\n\n";
+    row_header();
+    run_aos(rows, passes); // 依次运行，同一时刻只有一张表占内存
+    run_soa(rows, passes);
+    return 0;
+}
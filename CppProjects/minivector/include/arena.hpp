@@ -0,0 +1,198 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+// 单调分配的arena：从大块里顺序切分，单个对象不归还，整个arena一次性释放
+// 典型用法是每个请求一个arena：请求里的临时容器都从它分配，请求结束时 reset()
+//
+// 块（chunk）用链表串起来，每个块开头是一个块头；块用完后按2倍增长申请下一块（上限 kMaxChunk）
+// reset() 只保留最近（最大）的那一块，其余还给上游，下一个请求通常就不需要再申请内存
+// 归还的恰好是最近一次分配时（如容器扩容前的那块）把游标退回去，这块内存马上可以复用
+//
+// 继承 std::pmr::memory_resource，可以交给 pmr_minivector / std::pmr 容器使用；
+// 也可以通过 arena_allocator 直接调用（非虚函数，可内联）
+// 不是线程安全的：一个arena只在一个线程里使用
+class monotonic_arena : public std::pmr::memory_resource
+{
+    private:
+        struct chunk_header
+        {
+            chunk_header* next;
+            size_t size; // 含块头
+        };
+
+        static constexpr size_t kMaxChunk = size_t(1) << 24;
+
+        chunk_header* chunks = nullptr; // 链表头是当前在切分的块
+        char* cursor = nullptr;
+        char* limit = nullptr;
+        size_t next_size;
+        size_t used = 0;
+        std::pmr::memory_resource* upstream;
+
+        static char* payload(chunk_header* chunk) noexcept
+        {
+            return reinterpret_cast<char*>(chunk + 1);
+        }
+
+        // 当前块放不下时申请新块，新块至少能放下这次请求
+        __attribute__((noinline)) void* allocate_slow(size_t bytes, size_t align)
+        {
+            size_t need = sizeof(chunk_header) + bytes + align;
+            size_t size = std::max(next_size, need);
+            auto* chunk = static_cast<chunk_header*>(upstream->allocate(size, alignof(std::max_align_t)));
+            chunk->next = chunks;
+            chunk->size = size;
+            chunks = chunk;
+            cursor = payload(chunk);
+            limit = reinterpret_cast<char*>(chunk) + size;
+            next_size = std::min(size * 2, std::max(kMaxChunk, size));
+            return allocate_bytes(bytes, align);
+        }
+
+        void free_chunks(chunk_header* chunk) noexcept
+        {
+            while(chunk)
+            {
+                chunk_header* next = chunk->next;
+                upstream->deallocate(chunk, chunk->size, alignof(std::max_align_t));
+                chunk = next;
+            }
+        }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t align) override
+        {
+            return allocate_bytes(bytes, align);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t) override
+        {
+            deallocate_bytes(p, bytes);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    public:
+        explicit monotonic_arena(size_t initial_chunk = 4096,
+                                 std::pmr::memory_resource* up = std::pmr::new_delete_resource())
+            : next_size(initial_chunk), upstream(up) {}
+
+        monotonic_arena(const monotonic_arena&) = delete;
+        monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+        ~monotonic_arena() override
+        {
+            free_chunks(chunks);
+        }
+
+        // 快路径：对齐游标、检查剩余空间
+        void* allocate_bytes(size_t bytes, size_t align)
+        {
+            uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor) + align - 1) & ~(uintptr_t(align) - 1);
+            if(cursor == nullptr or aligned + bytes > reinterpret_cast<uintptr_t>(limit))
+                return allocate_slow(bytes, align);
+            cursor = reinterpret_cast<char*>(aligned + bytes);
+            used += bytes;
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        // 只有最近一次分配能被收回
+        void deallocate_bytes(void* p, size_t bytes) noexcept
+        {
+            if(static_cast<char*>(p) + bytes == cursor)
+            {
+                cursor = static_cast<char*>(p);
+                used -= bytes;
+            }
+        }
+
+        // 丢弃所有对象（不调用析构），保留当前块供下一轮使用
+        // 从arena分配的容器要在reset之前销毁：之后它们的析构还会归还内存
+        void reset() noexcept
+        {
+            if(!chunks) return;
+            free_chunks(chunks->next);
+            chunks->next = nullptr;
+            cursor = payload(chunks);
+            used = 0;
+        }
+
+        // 连同当前块一起还给上游
+        void release() noexcept
+        {
+            free_chunks(chunks);
+            chunks = nullptr;
+            cursor = limit = nullptr;
+            used = 0;
+        }
+
+        // 自上次reset以来切出去的字节数（不含对齐填充）
+        size_t bytes_used() const noexcept
+        {
+            return used;
+        }
+
+        size_t chunk_count() const noexcept
+        {
+            size_t n = 0;
+            for(chunk_header* c = chunks; c; c = c->next) n++;
+            return n;
+        }
+};
+
+// 直接从monotonic_arena分配的分配器：只有一个指针，分配不经过虚函数
+template<typename T>
+class arena_allocator
+{
+    private:
+        monotonic_arena* arena;
+
+        template<typename U>
+        friend class arena_allocator;
+
+    public:
+        using value_type = T;
+
+        arena_allocator(monotonic_arena& a) noexcept : arena(&a) {}
+
+        template<typename U>
+        arena_allocator(const arena_allocator<U>& other) noexcept : arena(other.arena) {}
+
+        T* allocate(size_t n)
+        {
+            return static_cast<T*>(arena->allocate_bytes(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_t n) noexcept
+        {
+            arena->deallocate_bytes(p, n * sizeof(T));
+        }
+
+        monotonic_arena* resource() const noexcept
+        {
+            return arena;
+        }
+
+        template<typename U>
+        bool operator==(const arena_allocator<U>& other) const noexcept
+        {
+            return arena == other.arena;
+        }
+
+        template<typename U>
+        bool operator!=(const arena_allocator<U>& other) const noexcept
+        {
+            return arena != other.arena;
+        }
+};
+
+#endif // ARENA_HPP
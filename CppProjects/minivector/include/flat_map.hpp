@@ -0,0 +1,184 @@
+#ifndef FLAT_MAP_HPP
+#define FLAT_MAP_HPP
+
+#include "flat_tree.hpp"
+
+#include <stdexcept>
+#include <tuple>
+
+// 有序数组实现的映射：std::pair<Key, T> 按键有序地存放在 minivector 里，不超过N个时不分配堆内存
+// 与 std::map / std::unordered_map 相比：没有节点分配，查找是对连续内存的二分，遍历就是顺序读数组；
+// 插入/删除是O(n)的移动（Key和T都能按字节搬家时是一次memmove）
+// 元素类型是 std::pair<Key, T>（键不是const，整块搬动时才能memmove），通过迭代器修改键会破坏顺序
+// 插入、删除会使所有迭代器和元素引用失效
+template<typename Key, typename T, typename Compare = std::less<Key>, size_t N = 8,
+         typename Alloc = std::allocator<std::pair<Key, T>>>
+class flat_map : public flat_tree<Key, std::pair<Key, T>, Compare, N, Alloc>
+{
+    private:
+        using base = flat_tree<Key, std::pair<Key, T>, Compare, N, Alloc>;
+        template<typename K>
+        using if_transparent = typename base::template if_transparent<K>;
+
+    public:
+        using mapped_type = T;
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        // 只比较键
+        class value_compare
+        {
+            private:
+                Compare comp;
+            public:
+                explicit value_compare(const Compare& c) : comp(c) {}
+                bool operator()(const value_type& a, const value_type& b) const { return comp(a.first, b.first); }
+        };
+
+        flat_map() : base(Compare()) {}
+
+        explicit flat_map(const Compare& comp, const Alloc& alloc = Alloc()) : base(comp, alloc) {}
+
+        explicit flat_map(const Alloc& alloc) : base(Compare(), alloc) {}
+
+        template<typename InputIt, typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+        flat_map(InputIt first, InputIt last, const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+            : base(comp, alloc)
+        {
+            this->insert_range(first, last);
+        }
+
+        flat_map(std::initializer_list<value_type> init, const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+            : flat_map(init.begin(), init.end(), comp, alloc) {}
+
+        value_compare value_comp() const { return value_compare(this->key_comp()); }
+
+        T& at(const Key& key)
+        {
+            size_t i = this->find_index(key);
+            if(i == this->size()) throw std::out_of_range("flat_map::at");
+            return this->data[i].second;
+        }
+
+        const T& at(const Key& key) const
+        {
+            size_t i = this->find_index(key);
+            if(i == this->size()) throw std::out_of_range("flat_map::at");
+            return this->data[i].second;
+        }
+
+        template<typename K, typename = if_transparent<K>>
+        T& at(const K& key)
+        {
+            size_t i = this->find_index(key);
+            if(i == this->size()) throw std::out_of_range("flat_map::at");
+            return this->data[i].second;
+        }
+
+        template<typename K, typename = if_transparent<K>>
+        const T& at(const K& key) const
+        {
+            size_t i = this->find_index(key);
+            if(i == this->size()) throw std::out_of_range("flat_map::at");
+            return this->data[i].second;
+        }
+
+        T& operator[](const Key& key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        T& operator[](Key&& key)
+        {
+            return try_emplace(std::move(key)).first->second;
+        }
+
+        // 键不存在时才构造值（已存在时args不会被移动）
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            auto [i, inserted] = this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                                   std::forward_as_tuple(std::forward<Args>(args)...));
+            return {this->begin() + i, inserted};
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+        {
+            auto [i, inserted] = this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                                   std::forward_as_tuple(std::forward<Args>(args)...));
+            return {this->begin() + i, inserted};
+        }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj)
+        {
+            auto result = try_emplace(key, std::forward<M>(obj));
+            if(!result.second) result.first->second = std::forward<M>(obj);
+            return result;
+        }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj)
+        {
+            auto result = try_emplace(std::move(key), std::forward<M>(obj));
+            if(!result.second) result.first->second = std::forward<M>(obj);
+            return result;
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            auto [i, inserted] = this->emplace_key(value.first, value);
+            return {this->begin() + i, inserted};
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value)
+        {
+            auto [i, inserted] = this->emplace_key(value.first, std::move(value));
+            return {this->begin() + i, inserted};
+        }
+
+        iterator insert(const_iterator hint, const value_type& value)
+        {
+            size_t i = this->emplace_key_hint(static_cast<size_t>(hint - this->begin()), value.first, value).first;
+            return this->begin() + i; // 插入可能扩容，之后才能取begin()
+        }
+
+        iterator insert(const_iterator hint, value_type&& value)
+        {
+            size_t i = this->emplace_key_hint(static_cast<size_t>(hint - this->begin()), value.first, std::move(value)).first;
+            return this->begin() + i;
+        }
+
+        // 批量插入：排序后与原有元素归并，见 flat_tree::insert_range
+        template<typename InputIt, typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+        void insert(InputIt first, InputIt last)
+        {
+            this->insert_range(first, last);
+        }
+
+        void insert(std::initializer_list<value_type> init)
+        {
+            this->insert_range(init.begin(), init.end());
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args)
+        {
+            return insert(value_type(std::forward<Args>(args)...));
+        }
+
+        void swap(flat_map& other)
+        {
+            std::swap(static_cast<base&>(*this), static_cast<base&>(other));
+        }
+};
+
+template<typename Key, typename T, typename Compare, size_t N, typename Alloc>
+void swap(flat_map<Key, T, Compare, N, Alloc>& a, flat_map<Key, T, Compare, N, Alloc>& b)
+{
+    a.swap(b);
+}
+
+#endif // FLAT_MAP_HPP
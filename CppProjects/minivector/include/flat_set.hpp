@@ -0,0 +1,94 @@
+#ifndef FLAT_SET_HPP
+#define FLAT_SET_HPP
+
+#include "flat_tree.hpp"
+
+// 有序数组实现的集合：元素连续存放在 minivector 里，不超过N个时不分配堆内存
+// 与 std::set 相比：没有每个元素一个节点的分配，查找/遍历缓存友好；插入/删除是O(n)的移动
+// 适合元素不多、查找和遍历多于增删的场合（如服务器里的连接fd集合）
+//   flat_set<int, std::greater<int>> fds; // *fds.begin() 是最大的fd
+// 插入、删除会使所有迭代器失效
+template<typename Key, typename Compare = std::less<Key>, size_t N = 8, typename Alloc = std::allocator<Key>>
+class flat_set : public flat_tree<Key, Key, Compare, N, Alloc>
+{
+    private:
+        using base = flat_tree<Key, Key, Compare, N, Alloc>;
+
+    public:
+        using typename base::iterator;
+        using typename base::const_iterator;
+        using value_compare = Compare;
+
+        flat_set() : base(Compare()) {}
+
+        explicit flat_set(const Compare& comp, const Alloc& alloc = Alloc()) : base(comp, alloc) {}
+
+        explicit flat_set(const Alloc& alloc) : base(Compare(), alloc) {}
+
+        template<typename InputIt, typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+        flat_set(InputIt first, InputIt last, const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+            : base(comp, alloc)
+        {
+            this->insert_range(first, last);
+        }
+
+        flat_set(std::initializer_list<Key> init, const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+            : flat_set(init.begin(), init.end(), comp, alloc) {}
+
+        value_compare value_comp() const { return this->key_comp(); }
+
+        std::pair<iterator, bool> insert(const Key& key)
+        {
+            auto [i, inserted] = this->emplace_key(key, key);
+            return {this->begin() + i, inserted};
+        }
+
+        std::pair<iterator, bool> insert(Key&& key)
+        {
+            auto [i, inserted] = this->emplace_key(key, std::move(key));
+            return {this->begin() + i, inserted};
+        }
+
+        iterator insert(const_iterator hint, const Key& key)
+        {
+            size_t i = this->emplace_key_hint(static_cast<size_t>(hint - this->begin()), key, key).first;
+            return this->begin() + i; // 插入可能扩容，之后才能取begin()
+        }
+
+        iterator insert(const_iterator hint, Key&& key)
+        {
+            size_t i = this->emplace_key_hint(static_cast<size_t>(hint - this->begin()), key, std::move(key)).first;
+            return this->begin() + i;
+        }
+
+        // 批量插入：排序后与原有元素归并，见 flat_tree::insert_range
+        template<typename InputIt, typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+        void insert(InputIt first, InputIt last)
+        {
+            this->insert_range(first, last);
+        }
+
+        void insert(std::initializer_list<Key> init)
+        {
+            this->insert_range(init.begin(), init.end());
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args)
+        {
+            return insert(Key(std::forward<Args>(args)...));
+        }
+
+        void swap(flat_set& other)
+        {
+            std::swap(static_cast<base&>(*this), static_cast<base&>(other));
+        }
+};
+
+template<typename Key, typename Compare, size_t N, typename Alloc>
+void swap(flat_set<Key, Compare, N, Alloc>& a, flat_set<Key, Compare, N, Alloc>& b)
+{
+    a.swap(b);
+}
+
+#endif // FLAT_SET_HPP
@@ -0,0 +1,331 @@
+#ifndef FLAT_TREE_HPP
+#define FLAT_TREE_HPP
+
+#include "minivector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+// 无分支二分查找：返回第一个不满足 less(*it, key) 的位置（同 std::lower_bound）
+// 每一步只根据比较结果选择下一段的起点（编译成cmov），循环次数只取决于n，不会因为分支预测失败而停顿
+template<typename T, typename K, typename Less>
+const T* branchless_lower_bound(const T* first, size_t n, const K& key, Less less)
+{
+    if(n == 0) return first;
+    while(n > 1)
+    {
+        size_t half = n / 2;
+        first = less(first[half], key) ? first + half : first;
+        n -= half;
+    }
+    return first + less(*first, key);
+}
+
+// 第一个满足 less(key, *it) 的位置（同 std::upper_bound）
+template<typename T, typename K, typename Less>
+const T* branchless_upper_bound(const T* first, size_t n, const K& key, Less less)
+{
+    if(n == 0) return first;
+    while(n > 1)
+    {
+        size_t half = n / 2;
+        first = less(key, first[half]) ? first : first + half;
+        n -= half;
+    }
+    return first + !less(key, *first);
+}
+
+// 空基类优化：std::less / std::greater 这类无状态的比较器不占空间
+template<typename Compare, bool Empty = std::is_empty<Compare>::value and !std::is_final<Compare>::value>
+class compare_holder : private Compare
+{
+    public:
+        explicit compare_holder(const Compare& comp) : Compare(comp) {}
+        const Compare& get_comp() const noexcept { return *this; }
+};
+
+template<typename Compare>
+class compare_holder<Compare, false>
+{
+    private:
+        Compare comp;
+    public:
+        explicit compare_holder(const Compare& c) : comp(c) {}
+        const Compare& get_comp() const noexcept { return comp; }
+};
+
+// flat_set / flat_map 的公共部分：元素按键有序、键唯一地存放在一个 minivector 里
+// Value 与 Key 相同时是集合（元素只读），否则 Value 是 std::pair<Key, T>
+// 查找是二分（无分支），插入/删除要移动后面的元素（O(n)，可按字节搬家的类型是一次memmove）
+// 比较器带 is_transparent（如 std::less<>）时查找类函数接受任何能与键比较的类型，不构造临时的Key
+template<typename Key, typename Value, typename Compare, size_t N, typename Alloc>
+class flat_tree : private compare_holder<Compare>
+{
+    protected:
+        static constexpr bool is_map = !std::is_same<Key, Value>::value;
+
+        using holder = compare_holder<Compare>;
+        using storage = minivector<Value, N, Alloc>;
+
+        storage data;
+
+        template<typename C, typename = void>
+        struct transparent : std::false_type {};
+
+        template<typename C>
+        struct transparent<C, std::void_t<typename C::is_transparent>> : std::true_type {};
+
+        // 只有比较器是透明的时候，才启用接受任意类型K的重载；迭代器不算键（erase(it)要走按位置删除）
+        template<typename K>
+        using if_transparent =
+            std::enable_if_t<transparent<Compare>::value and !std::is_convertible<K, const Value*>::value>;
+
+        static const Key& key_of(const Value& v) noexcept
+        {
+            if constexpr(is_map) return v.first;
+            else return v;
+        }
+
+        bool less(const Value& a, const Value& b) const
+        {
+            return this->get_comp()(key_of(a), key_of(b));
+        }
+
+        template<typename K>
+        size_t lower_index(const K& key) const
+        {
+            const Compare& comp = this->get_comp();
+            const Value* at = branchless_lower_bound(data.data(), data.size(), key,
+                                                     [&comp](const Value& v, const K& k) { return comp(key_of(v), k); });
+            return static_cast<size_t>(at - data.data());
+        }
+
+        template<typename K>
+        size_t upper_index(const K& key) const
+        {
+            const Compare& comp = this->get_comp();
+            const Value* at = branchless_upper_bound(data.data(), data.size(), key,
+                                                     [&comp](const K& k, const Value& v) { return comp(k, key_of(v)); });
+            return static_cast<size_t>(at - data.data());
+        }
+
+        // 找不到时返回size()
+        template<typename K>
+        size_t find_index(const K& key) const
+        {
+            size_t i = lower_index(key);
+            if(i != data.size() and this->get_comp()(key, key_of(data[i]))) return data.size();
+            return i;
+        }
+
+        // 键不存在时才用args构造元素
+        template<typename K, typename... Args>
+        std::pair<size_t, bool> emplace_key(const K& key, Args&&... args)
+        {
+            size_t i = lower_index(key);
+            if(i != data.size() and !this->get_comp()(key, key_of(data[i]))) return {i, false};
+            data.emplace(data.begin() + i, std::forward<Args>(args)...);
+            return {i, true};
+        }
+
+        // 带位置提示的插入：key恰好该放在hint处（例如按顺序追加）时省去二分
+        template<typename K, typename... Args>
+        std::pair<size_t, bool> emplace_key_hint(size_t hint, const K& key, Args&&... args)
+        {
+            const Compare& comp = this->get_comp();
+            if((hint == data.size() or comp(key, key_of(data[hint])))
+               and (hint == 0 or comp(key_of(data[hint - 1]), key)))
+            {
+                data.emplace(data.begin() + hint, std::forward<Args>(args)...);
+                return {hint, true};
+            }
+            return emplace_key(key, std::forward<Args>(args)...);
+        }
+
+        // 批量插入：先全部追加到尾部，把新的一段排序去重，再与原来的有序段原地归并
+        // 比逐个插入（每个都要移动后面的元素）少得多：O(m log m + n)
+        // 与 std::set 相同，键重复时保留先插入的（原有的元素、区间里靠前的元素）
+        // 排序/归并抛异常时，追加的元素被丢弃（归并已开始时整个容器被清空），容器仍然有序
+        template<typename InputIt>
+        void insert_range(InputIt first, InputIt last)
+        {
+            size_t old_len = data.size();
+            data.insert(data.end(), first, last);
+            if(data.size() == old_len) return;
+            auto value_less = [this](const Value& a, const Value& b) { return less(a, b); };
+            auto equivalent = [this](const Value& a, const Value& b) { return !less(a, b); }; // 已排序，a不大于b
+            Value* begin = data.data();
+            Value* mid = begin + old_len;
+            Value* end = begin + data.size();
+            bool merging = false;
+            try
+            {
+                std::stable_sort(mid, end, value_less);
+                end = std::unique(mid, end, equivalent);
+                if(old_len != 0 and !less(*(mid - 1), *mid)) // 新的一段不是整体排在后面，需要归并
+                {
+                    merging = true;
+                    std::inplace_merge(begin, mid, end, value_less);
+                    end = std::unique(begin, end, equivalent);
+                }
+            }
+            catch(...)
+            {
+                if(merging) data.clear();
+                else data.erase(data.begin() + old_len, data.end());
+                throw;
+            }
+            data.erase(end, data.end());
+        }
+
+        explicit flat_tree(const Compare& comp) : holder(comp) {}
+
+        flat_tree(const Compare& comp, const Alloc& alloc) : holder(comp), data(alloc) {}
+
+    public:
+        using key_type = Key;
+        using value_type = Value;
+        using key_compare = Compare;
+        using allocator_type = Alloc;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        // 集合的元素只读；映射的元素可写，但不能修改键
+        using iterator = std::conditional_t<is_map, Value*, const Value*>;
+        using const_iterator = const Value*;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        key_compare key_comp() const { return this->get_comp(); }
+        allocator_type get_allocator() const { return data.get_allocator(); }
+
+        iterator begin() noexcept { return data.data(); }
+        const_iterator begin() const noexcept { return data.data(); }
+        const_iterator cbegin() const noexcept { return data.data(); }
+        iterator end() noexcept { return data.data() + data.size(); }
+        const_iterator end() const noexcept { return data.data() + data.size(); }
+        const_iterator cend() const noexcept { return end(); }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+        size_t size() const noexcept { return data.size(); }
+        bool empty() const noexcept { return data.empty(); }
+        size_t capacity() const noexcept { return data.capacity(); }
+        size_t max_size() const noexcept { return data.max_size(); }
+        void reserve(size_t n) { data.reserve(n); }
+        void shrink_to_fit() { data.shrink_to_fit(); }
+        void clear() noexcept { data.clear(); }
+
+        iterator find(const Key& key) { return begin() + find_index(key); }
+        const_iterator find(const Key& key) const { return begin() + find_index(key); }
+        iterator lower_bound(const Key& key) { return begin() + lower_index(key); }
+        const_iterator lower_bound(const Key& key) const { return begin() + lower_index(key); }
+        iterator upper_bound(const Key& key) { return begin() + upper_index(key); }
+        const_iterator upper_bound(const Key& key) const { return begin() + upper_index(key); }
+        bool contains(const Key& key) const { return find_index(key) != size(); }
+        size_t count(const Key& key) const { return contains(key); }
+
+        std::pair<iterator, iterator> equal_range(const Key& key)
+        {
+            iterator at = find(key);
+            return {at, at == end() ? at : at + 1};
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const Key& key) const
+        {
+            const_iterator at = find(key);
+            return {at, at == end() ? at : at + 1};
+        }
+
+        // 异构查找（比较器透明时）：与键等价的元素可能不止一个，equal_range/count 按上下界计算
+        template<typename K, typename = if_transparent<K>>
+        iterator find(const K& key) { return begin() + find_index(key); }
+        template<typename K, typename = if_transparent<K>>
+        const_iterator find(const K& key) const { return begin() + find_index(key); }
+        template<typename K, typename = if_transparent<K>>
+        iterator lower_bound(const K& key) { return begin() + lower_index(key); }
+        template<typename K, typename = if_transparent<K>>
+        const_iterator lower_bound(const K& key) const { return begin() + lower_index(key); }
+        template<typename K, typename = if_transparent<K>>
+        iterator upper_bound(const K& key) { return begin() + upper_index(key); }
+        template<typename K, typename = if_transparent<K>>
+        const_iterator upper_bound(const K& key) const { return begin() + upper_index(key); }
+        template<typename K, typename = if_transparent<K>>
+        bool contains(const K& key) const { return find_index(key) != size(); }
+        template<typename K, typename = if_transparent<K>>
+        size_t count(const K& key) const { return upper_index(key) - lower_index(key); }
+
+        template<typename K, typename = if_transparent<K>>
+        std::pair<iterator, iterator> equal_range(const K& key)
+        {
+            return {begin() + lower_index(key), begin() + upper_index(key)};
+        }
+
+        template<typename K, typename = if_transparent<K>>
+        std::pair<const_iterator, const_iterator> equal_range(const K& key) const
+        {
+            return {begin() + lower_index(key), begin() + upper_index(key)};
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            return data.erase(pos);
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            return data.erase(first, last);
+        }
+
+        size_t erase(const Key& key)
+        {
+            size_t i = find_index(key);
+            if(i == size()) return 0;
+            data.erase(data.begin() + i);
+            return 1;
+        }
+
+        template<typename K, typename = if_transparent<K>>
+        size_t erase(const K& key)
+        {
+            size_t first = lower_index(key), last = upper_index(key);
+            data.erase(data.begin() + first, data.begin() + last);
+            return last - first;
+        }
+
+        // 按条件删除，一次遍历
+        template<typename Pred>
+        size_t erase_if(Pred pred)
+        {
+            auto end = std::remove_if(data.begin(), data.end(), pred);
+            size_t removed = static_cast<size_t>(data.end() - end);
+            data.erase(end, data.end());
+            return removed;
+        }
+};
+
+template<typename Key, typename Value, typename Compare, size_t N, typename Alloc>
+bool operator==(const flat_tree<Key, Value, Compare, N, Alloc>& a, const flat_tree<Key, Value, Compare, N, Alloc>& b)
+{
+    return a.size() == b.size() and std::equal(a.begin(), a.end(), b.begin());
+}
+
+template<typename Key, typename Value, typename Compare, size_t N, typename Alloc>
+bool operator!=(const flat_tree<Key, Value, Compare, N, Alloc>& a, const flat_tree<Key, Value, Compare, N, Alloc>& b)
+{
+    return !(a == b);
+}
+
+template<typename Key, typename Value, typename Compare, size_t N, typename Alloc>
+bool operator<(const flat_tree<Key, Value, Compare, N, Alloc>& a, const flat_tree<Key, Value, Compare, N, Alloc>& b)
+{
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+}
+
+#endif // FLAT_TREE_HPP
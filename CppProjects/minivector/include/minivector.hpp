@@ -0,0 +1,719 @@
+#ifndef MINIVECTOR_HPP
+#define MINIVECTOR_HPP
+
+#include <algorithm>
+#include <cstddef> // size_t
+#include <cstdlib> // std::malloc / std::realloc
+#include <cstring> // std::memcpy / std::memmove
+#include <initializer_list>
+#include <iterator>
+#include <memory> // std::allocator_traits
+#include <memory_resource> // std::pmr::polymorphic_allocator
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// 能否按字节搬家：把对象memcpy到新地址、不调用旧对象的析构，等价于“移动构造+析构”
+// 默认只认可平凡可拷贝的类型；自己的类型（例如只含一个指针的句柄）可以特化为true
+// 注意libstdc++的std::string内部有指向自身的指针，不能搬
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// std::pair 的赋值运算符是自定义的，所以不是平凡可拷贝的；两个成员都能按字节搬家时整体也能（flat_map的元素）
+template<typename A, typename B>
+struct is_trivially_relocatable<std::pair<A, B>>
+    : std::integral_constant<bool, is_trivially_relocatable<A>::value and is_trivially_relocatable<B>::value> {};
+
+// 内联缓冲区：N个元素的未初始化内存，N为0时没有
+template<typename T, size_t N>
+struct inline_buffer
+{
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+
+    T* data() noexcept { return reinterpret_cast<T*>(bytes); }
+    const T* data() const noexcept { return reinterpret_cast<const T*>(bytes); }
+};
+
+template<typename T>
+struct inline_buffer<T, 0>
+{
+    T* data() noexcept { return nullptr; }
+    const T* data() const noexcept { return nullptr; }
+};
+
+// 空基类优化：无状态的分配器（std::allocator）不占空间；polymorphic_allocator 这类有状态的存成成员
+template<typename Alloc, bool Empty = std::is_empty<Alloc>::value and !std::is_final<Alloc>::value>
+class allocator_holder : private Alloc
+{
+    public:
+        explicit allocator_holder(const Alloc& alloc) : Alloc(alloc) {}
+        Alloc& get_alloc() noexcept { return *this; }
+        const Alloc& get_alloc() const noexcept { return *this; }
+};
+
+template<typename Alloc>
+class allocator_holder<Alloc, false>
+{
+    private:
+        Alloc alloc;
+    public:
+        explicit allocator_holder(const Alloc& a) : alloc(a) {}
+        Alloc& get_alloc() noexcept { return alloc; }
+        const Alloc& get_alloc() const noexcept { return alloc; }
+};
+
+// 带小缓冲区优化（SBO）的vector：不超过N个元素时放在对象内部，不分配堆内存
+// 与std::vector的区别：
+//   扩容按1.5倍（旧块释放后，几次之后新块可以复用之前释放的内存；2倍永远放不下）
+//   可按字节搬家的类型扩容时用realloc、中间插入/删除时直接memmove，不逐个移动构造和析构
+//   强异常保证只在尾部追加（push_back/emplace_back扩容）时提供：移动可能抛异常的类型改用拷贝搬家；
+//   中间插入/删除只保证基本异常安全（与std::vector相同）
+// 迭代器就是T*；扩容、移动整个容器（内联元素会被搬走）后都会失效
+//
+// Alloc 为 std::allocator 时内存直接来自 malloc/realloc；其他分配器（arena_allocator、polymorphic_allocator）
+// 通过 allocator_traits 分配和构造元素，元素也会按 uses-allocator 规则拿到分配器（如 pmr::string）
+// 分配器不同且不随移动赋值传播时（polymorphic_allocator），移动赋值逐个移动元素，不接管对方的内存
+template<typename T, size_t N = 8, typename Alloc = std::allocator<T>>
+class minivector : private allocator_holder<Alloc>
+{
+    private:
+        T* ptr;
+        size_t len;
+        size_t cap;
+        inline_buffer<T, N> buffer;
+
+        using holder = allocator_holder<Alloc>;
+        using alloc_traits = std::allocator_traits<Alloc>;
+
+        static_assert(std::is_same<typename Alloc::value_type, T>::value, "Alloc::value_type must be T");
+
+        static constexpr bool relocatable = is_trivially_relocatable<T>::value;
+        static constexpr bool nothrow_relocate = relocatable or std::is_nothrow_move_constructible<T>::value;
+
+        // 默认分配器：超过malloc对齐的类型用带对齐的operator new，其余用malloc，可按字节搬家的类型扩容时可以realloc
+        static constexpr bool default_alloc = std::is_same<Alloc, std::allocator<T>>::value;
+        static constexpr bool overaligned = alignof(T) > alignof(std::max_align_t);
+        static constexpr bool use_realloc = default_alloc and relocatable and !overaligned;
+
+        bool heap_allocated() const noexcept
+        {
+            return ptr != buffer.data();
+        }
+
+        T* allocate(size_t n)
+        {
+            if constexpr(!default_alloc)
+                return alloc_traits::allocate(holder::get_alloc(), n);
+            else if constexpr(overaligned)
+                return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+            else
+            {
+                void* p = std::malloc(n * sizeof(T));
+                if(!p) throw std::bad_alloc();
+                return static_cast<T*>(p);
+            }
+        }
+
+        void deallocate(T* p, size_t n) noexcept
+        {
+            if constexpr(!default_alloc)
+                alloc_traits::deallocate(holder::get_alloc(), p, n);
+            else if constexpr(overaligned)
+                ::operator delete(p, std::align_val_t(alignof(T)));
+            else
+                std::free(p);
+        }
+
+        template<typename... Args>
+        T* construct(T* p, Args&&... args)
+        {
+            alloc_traits::construct(holder::get_alloc(), p, std::forward<Args>(args)...);
+            return p;
+        }
+
+        void destroy(T* first, T* last) noexcept
+        {
+            if constexpr(!std::is_trivially_destructible<T>::value)
+                for(; first != last; ++first) alloc_traits::destroy(holder::get_alloc(), first);
+        }
+
+        // 在未初始化的to上拷贝构造[first, last)，中途失败时销毁已构造的部分
+        template<typename InputIt>
+        void construct_copy(InputIt first, InputIt last, T* to)
+        {
+            T* cur = to;
+            try
+            {
+                for(; first != last; ++first, ++cur) construct(cur, *first);
+            }
+            catch(...)
+            {
+                destroy(to, cur);
+                throw;
+            }
+        }
+
+        // 把from上的n个元素搬到未初始化的to上，from上的对象随之结束
+        // 逐个搬家时移动构造可能抛异常的类型用拷贝：中途失败时from原封不动
+        void relocate(T* from, size_t n, T* to)
+        {
+            if constexpr(relocatable)
+            {
+                if(n) std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+            }
+            else
+            {
+                size_t i = 0;
+                try
+                {
+                    for(; i < n; i++) construct(to + i, std::move_if_noexcept(from[i]));
+                }
+                catch(...)
+                {
+                    destroy(to, to + i);
+                    throw;
+                }
+                destroy(from, from + n);
+            }
+        }
+
+        size_t next_capacity(size_t need) const
+        {
+            if(need > max_size()) throw std::length_error("minivector: too many elements");
+            size_t grown = cap + cap / 2;
+            return std::max({need, grown, size_t(4)});
+        }
+
+        void free_heap() noexcept
+        {
+            if(heap_allocated()) deallocate(ptr, cap);
+        }
+
+        // 释放堆内存，回到空的内联缓冲区（调用前元素已销毁）
+        void reset_to_inline() noexcept
+        {
+            free_heap();
+            ptr = buffer.data();
+            cap = N;
+        }
+
+        // 换到容量为new_cap的新堆内存上
+        // 已在堆上且可按字节搬家时用realloc：原地扩展，或者（大块时）由内核重新映射页面，都不用拷贝元素
+        void reallocate(size_t new_cap)
+        {
+            if constexpr(use_realloc)
+            {
+                if(heap_allocated())
+                {
+                    void* p = std::realloc(static_cast<void*>(ptr), new_cap * sizeof(T));
+                    if(!p) throw std::bad_alloc(); // 失败时旧内存原样保留
+                    ptr = static_cast<T*>(p);
+                    cap = new_cap;
+                    return;
+                }
+            }
+            T* p = allocate(new_cap);
+            try
+            {
+                relocate(ptr, len, p);
+            }
+            catch(...)
+            {
+                deallocate(p, new_cap);
+                throw;
+            }
+            free_heap();
+            ptr = p;
+            cap = new_cap;
+        }
+
+        // 扩容的慢路径：先在新内存上构造新元素（参数可能引用旧元素），再搬旧元素
+        // realloc会让旧元素立即失效，所以那种情况下先在栈上构造好新元素
+        // 不内联，让emplace_back的快路径只剩一次比较和一次构造
+        template<typename... Args>
+        __attribute__((noinline)) T& grow_emplace_back(Args&&... args)
+        {
+            size_t new_cap = next_capacity(len + 1);
+            if constexpr(use_realloc)
+            {
+                if(heap_allocated())
+                {
+                    T value(std::forward<Args>(args)...);
+                    reallocate(new_cap);
+                    T* slot = construct(ptr + len, std::move(value));
+                    len++;
+                    return *slot;
+                }
+            }
+            T* p = allocate(new_cap);
+            T* slot = p + len;
+            try
+            {
+                construct(slot, std::forward<Args>(args)...);
+            }
+            catch(...)
+            {
+                deallocate(p, new_cap);
+                throw;
+            }
+            try
+            {
+                relocate(ptr, len, p);
+            }
+            catch(...)
+            {
+                destroy(slot, slot + 1);
+                deallocate(p, new_cap);
+                throw;
+            }
+            free_heap();
+            ptr = p;
+            cap = new_cap;
+            len++;
+            return *slot;
+        }
+
+        // 接管other的元素：调用前自己为空且在内联缓冲区，两边的分配器相等
+        void take(minivector&& other) noexcept(nothrow_relocate)
+        {
+            if(other.heap_allocated())
+            {
+                ptr = other.ptr;
+                cap = other.cap;
+                other.ptr = other.buffer.data();
+                other.cap = N;
+            }
+            else
+            {
+                relocate(other.ptr, other.len, ptr);
+            }
+            len = other.len;
+            other.len = 0;
+        }
+
+        // 分配器不同：在自己的内存里逐个移动构造，other保留它的内存
+        void move_elements(minivector&& other)
+        {
+            reserve(other.len);
+            relocate(other.ptr, other.len, ptr);
+            len = other.len;
+            other.len = 0;
+        }
+
+    public:
+        using value_type = T;
+        using allocator_type = Alloc;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using iterator = T*;
+        using const_iterator = const T*;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        static constexpr size_t inline_capacity = N;
+
+        minivector() noexcept(noexcept(Alloc())) : minivector(Alloc()) {}
+
+        explicit minivector(const Alloc& alloc) noexcept : holder(alloc), len(0), cap(N)
+        {
+            ptr = buffer.data();
+        }
+
+        explicit minivector(size_t n, const Alloc& alloc = Alloc()) : minivector(alloc)
+        {
+            resize(n);
+        }
+
+        minivector(size_t n, const T& value, const Alloc& alloc = Alloc()) : minivector(alloc)
+        {
+            resize(n, value);
+        }
+
+        // 委托构造：默认构造完成后对象就算构造好了，函数体里抛异常时析构函数会负责清理
+        template<typename InputIt, typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+        minivector(InputIt first, InputIt last, const Alloc& alloc = Alloc()) : minivector(alloc)
+        {
+            insert(end(), first, last);
+        }
+
+        minivector(std::initializer_list<T> init, const Alloc& alloc = Alloc())
+            : minivector(init.begin(), init.end(), alloc) {}
+
+        minivector(const minivector& other)
+            : minivector(other, alloc_traits::select_on_container_copy_construction(other.get_alloc())) {}
+
+        minivector(const minivector& other, const Alloc& alloc) : minivector(alloc)
+        {
+            if(other.len > N)
+            {
+                ptr = allocate(other.len);
+                cap = other.len;
+            }
+            construct_copy(other.begin(), other.end(), ptr);
+            len = other.len;
+        }
+
+        // 堆上的元素直接接管指针；内联的元素要一个个搬过来
+        minivector(minivector&& other) noexcept(nothrow_relocate) : minivector(other.get_alloc())
+        {
+            take(std::move(other));
+        }
+
+        minivector(minivector&& other, const Alloc& alloc) : minivector(alloc)
+        {
+            if(holder::get_alloc() == other.get_alloc()) take(std::move(other));
+            else move_elements(std::move(other));
+        }
+
+        ~minivector()
+        {
+            destroy(ptr, ptr + len);
+            free_heap();
+        }
+
+        minivector& operator=(const minivector& other)
+        {
+            if(this == &other) return *this;
+            if constexpr(alloc_traits::propagate_on_container_copy_assignment::value)
+            {
+                if(holder::get_alloc() != other.get_alloc())
+                {
+                    clear();
+                    reset_to_inline(); // 旧内存要还给旧的分配器
+                }
+                holder::get_alloc() = other.get_alloc();
+            }
+            if(other.len > cap)
+            {
+                clear();
+                T* p = allocate(other.len);
+                try
+                {
+                    construct_copy(other.begin(), other.end(), p);
+                }
+                catch(...)
+                {
+                    deallocate(p, other.len);
+                    throw;
+                }
+                free_heap();
+                ptr = p;
+                cap = other.len;
+            }
+            else if(other.len > len)
+            {
+                std::copy(other.begin(), other.begin() + len, ptr);
+                construct_copy(other.begin() + len, other.end(), ptr + len);
+            }
+            else
+            {
+                std::copy(other.begin(), other.end(), ptr);
+                destroy(ptr + other.len, ptr + len);
+            }
+            len = other.len;
+            return *this;
+        }
+
+        // other在堆上且分配器相等（或随赋值传播）时直接接管；
+        // other在内联缓冲区时搬进自己现有的存储（容量一定够），自己的堆内存保留
+        minivector& operator=(minivector&& other) noexcept(nothrow_relocate
+            and (alloc_traits::propagate_on_container_move_assignment::value or alloc_traits::is_always_equal::value))
+        {
+            if(this == &other) return *this;
+            clear();
+            if constexpr(alloc_traits::propagate_on_container_move_assignment::value)
+            {
+                if(holder::get_alloc() != other.get_alloc())
+                {
+                    reset_to_inline();
+                    holder::get_alloc() = std::move(other.get_alloc());
+                }
+            }
+            if(other.heap_allocated() and holder::get_alloc() == other.get_alloc())
+            {
+                reset_to_inline();
+                take(std::move(other));
+            }
+            else
+            {
+                move_elements(std::move(other));
+            }
+            return *this;
+        }
+
+        minivector& operator=(std::initializer_list<T> init)
+        {
+            clear();
+            insert(end(), init.begin(), init.end());
+            return *this;
+        }
+
+        Alloc get_allocator() const noexcept
+        {
+            return holder::get_alloc();
+        }
+
+        // 元素访问
+
+        T& operator[](size_t i) noexcept { return ptr[i]; }
+        const T& operator[](size_t i) const noexcept { return ptr[i]; }
+
+        T& at(size_t i)
+        {
+            if(i >= len) throw std::out_of_range("minivector::at");
+            return ptr[i];
+        }
+
+        const T& at(size_t i) const
+        {
+            if(i >= len) throw std::out_of_range("minivector::at");
+            return ptr[i];
+        }
+
+        T& front() noexcept { return ptr[0]; }
+        const T& front() const noexcept { return ptr[0]; }
+        T& back() noexcept { return ptr[len - 1]; }
+        const T& back() const noexcept { return ptr[len - 1]; }
+        T* data() noexcept { return ptr; }
+        const T* data() const noexcept { return ptr; }
+
+        // 迭代器
+
+        iterator begin() noexcept { return ptr; }
+        const_iterator begin() const noexcept { return ptr; }
+        const_iterator cbegin() const noexcept { return ptr; }
+        iterator end() noexcept { return ptr + len; }
+        const_iterator end() const noexcept { return ptr + len; }
+        const_iterator cend() const noexcept { return ptr + len; }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+        // 容量
+
+        bool empty() const noexcept { return len == 0; }
+        size_t size() const noexcept { return len; }
+        size_t capacity() const noexcept { return cap; }
+        size_t max_size() const noexcept { return size_t(-1) / sizeof(T) / 2; }
+
+        // 元素是否还在对象内部
+        bool is_inline() const noexcept { return !heap_allocated(); }
+
+        void reserve(size_t n)
+        {
+            if(n > cap)
+            {
+                if(n > max_size()) throw std::length_error("minivector: too many elements");
+                reallocate(n);
+            }
+        }
+
+        // 放得下时搬回内联缓冲区，否则按当前大小重新分配
+        void shrink_to_fit()
+        {
+            if(!heap_allocated() or len == cap) return;
+            if(len <= N)
+            {
+                T* old = ptr;
+                size_t old_cap = cap;
+                relocate(old, len, buffer.data());
+                deallocate(old, old_cap);
+                ptr = buffer.data();
+                cap = N;
+            }
+            else
+            {
+                reallocate(len);
+            }
+        }
+
+        // 修改
+
+        void clear() noexcept
+        {
+            destroy(ptr, ptr + len);
+            len = 0;
+        }
+
+        template<typename... Args>
+        T& emplace_back(Args&&... args)
+        {
+            if(len == cap) return grow_emplace_back(std::forward<Args>(args)...);
+            T* slot = construct(ptr + len, std::forward<Args>(args)...);
+            len++;
+            return *slot;
+        }
+
+        void push_back(const T& value)
+        {
+            emplace_back(value);
+        }
+
+        void push_back(T&& value)
+        {
+            emplace_back(std::move(value));
+        }
+
+        void pop_back() noexcept
+        {
+            len--;
+            destroy(ptr + len, ptr + len + 1);
+        }
+
+        // 在pos处构造一个元素，后面的元素后移一位
+        template<typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args)
+        {
+            size_t index = static_cast<size_t>(pos - ptr);
+            if(index == len)
+            {
+                emplace_back(std::forward<Args>(args)...);
+                return ptr + index;
+            }
+            T value(std::forward<Args>(args)...); // 参数可能引用本容器里的元素，挪动之前先构造出来
+            if(len == cap) reallocate(next_capacity(len + 1));
+            T* at = ptr + index;
+            if constexpr(relocatable and std::is_nothrow_move_constructible<T>::value)
+            {
+                std::memmove(static_cast<void*>(at + 1), static_cast<const void*>(at), (len - index) * sizeof(T));
+                construct(at, std::move(value));
+                len++;
+            }
+            else
+            {
+                construct(ptr + len, std::move(ptr[len - 1]));
+                len++;
+                std::move_backward(at, ptr + len - 2, ptr + len - 1);
+                *at = std::move(value);
+            }
+            return at;
+        }
+
+        iterator insert(const_iterator pos, const T& value)
+        {
+            return emplace(pos, value);
+        }
+
+        iterator insert(const_iterator pos, T&& value)
+        {
+            return emplace(pos, std::move(value));
+        }
+
+        // 区间插入：先追加到尾部，再旋转到pos处
+        template<typename InputIt, typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+        iterator insert(const_iterator pos, InputIt first, InputIt last)
+        {
+            size_t index = static_cast<size_t>(pos - ptr);
+            size_t old_len = len;
+            using category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr(std::is_base_of<std::forward_iterator_tag, category>::value)
+                reserve(len + static_cast<size_t>(std::distance(first, last)));
+            for(; first != last; ++first) emplace_back(*first);
+            std::rotate(ptr + index, ptr + old_len, ptr + len);
+            return ptr + index;
+        }
+
+        iterator insert(const_iterator pos, std::initializer_list<T> init)
+        {
+            return insert(pos, init.begin(), init.end());
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        // 删除[first, last)，后面的元素前移
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            T* from = ptr + (first - ptr);
+            T* to = ptr + (last - ptr);
+            if(from == to) return from;
+            if constexpr(relocatable)
+            {
+                destroy(from, to);
+                std::memmove(static_cast<void*>(from), static_cast<const void*>(to), (ptr + len - to) * sizeof(T));
+            }
+            else
+            {
+                T* new_end = std::move(to, ptr + len, from);
+                destroy(new_end, ptr + len);
+            }
+            len -= static_cast<size_t>(to - from);
+            return from;
+        }
+
+        void resize(size_t n)
+        {
+            if(n > cap) reallocate(next_capacity(n));
+            for(; len < n; len++) construct(ptr + len);
+            if(n < len)
+            {
+                destroy(ptr + n, ptr + len);
+                len = n;
+            }
+        }
+
+        void resize(size_t n, const T& value)
+        {
+            if(n > cap)
+            {
+                if(&value >= ptr and &value < ptr + len)
+                {
+                    T copy(value); // value在本容器里，扩容后就失效了
+                    resize(n, copy);
+                    return;
+                }
+                reallocate(next_capacity(n));
+            }
+            for(; len < n; len++) construct(ptr + len, value);
+            if(n < len)
+            {
+                destroy(ptr + n, ptr + len);
+                len = n;
+            }
+        }
+
+        void swap(minivector& other)
+        {
+            minivector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+};
+
+// 使用 std::pmr::memory_resource 的版本：分配器类型统一，内存来源在运行时指定（如每个请求一个arena）
+template<typename T, size_t N = 8>
+using pmr_minivector = minivector<T, N, std::pmr::polymorphic_allocator<T>>;
+
+template<typename T, size_t N, typename Alloc>
+bool operator==(const minivector<T, N, Alloc>& a, const minivector<T, N, Alloc>& b)
+{
+    return a.size() == b.size() and std::equal(a.begin(), a.end(), b.begin());
+}
+
+template<typename T, size_t N, typename Alloc>
+bool operator!=(const minivector<T, N, Alloc>& a, const minivector<T, N, Alloc>& b)
+{
+    return !(a == b);
+}
+
+template<typename T, size_t N, typename Alloc>
+bool operator<(const minivector<T, N, Alloc>& a, const minivector<T, N, Alloc>& b)
+{
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+}
+
+template<typename T, size_t N, typename Alloc>
+void swap(minivector<T, N, Alloc>& a, minivector<T, N, Alloc>& b)
+{
+    a.swap(b);
+}
+
+#endif // MINIVECTOR_HPP
@@ -0,0 +1,523 @@
+#ifndef SOA_VECTOR_HPP
+#define SOA_VECTOR_HPP
+
+#include "minivector.hpp" // is_trivially_relocatable
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// 一列的视图：连续、按 soa_vector::alignment 对齐的数组，可以直接交给SIMD循环或标准算法
+template<typename T>
+class column_span
+{
+    private:
+        T* ptr;
+        size_t len;
+
+    public:
+        column_span(T* p, size_t n) noexcept : ptr(p), len(n) {}
+
+        T* data() const noexcept { return ptr; }
+        size_t size() const noexcept { return len; }
+        bool empty() const noexcept { return len == 0; }
+        T* begin() const noexcept { return ptr; }
+        T* end() const noexcept { return ptr + len; }
+        T& operator[](size_t i) const noexcept { return ptr[i]; }
+};
+
+// 结构数组（SoA）：每个字段单独存成一个连续数组，只扫描某一列时不会把其它字段读进缓存
+//   soa_vector<int, uint64_t, long> conns;   // fd, 收到的字节数, 最后活跃时间
+//   conns.emplace_back(fd, 0, now);
+//   for(uint64_t b : conns.column<1>()) total += b;
+//   for(auto [fd, bytes, last] : conns) ...   // 行代理：std::tuple<int&, uint64_t&, long&>
+//
+// 所有列放在同一块内存里，每列起点按 alignment（至少64字节，缓存行）对齐；
+// 增删都是逐列做同样的操作，各列长度始终相同
+// 字段类型的移动构造、移动赋值必须不抛异常：否则搬到一半失败时各列就对不齐了
+template<typename... Fields>
+class soa_vector
+{
+        static_assert(sizeof...(Fields) > 0, "soa_vector: at least one field");
+        static_assert((std::is_nothrow_move_constructible<Fields>::value and ...),
+                      "soa_vector: fields must be nothrow move constructible");
+        static_assert((std::is_nothrow_move_assignable<Fields>::value and ...),
+                      "soa_vector: fields must be nothrow move assignable");
+
+    public:
+        using value_type = std::tuple<Fields...>;
+        using reference = std::tuple<Fields&...>;
+        using const_reference = std::tuple<const Fields&...>;
+        using size_type = size_t;
+
+        template<size_t I>
+        using field_type = std::tuple_element_t<I, value_type>;
+
+        static constexpr size_t columns = sizeof...(Fields);
+        static constexpr size_t alignment = std::max({size_t(64), alignof(Fields)...});
+
+    private:
+        using indices = std::index_sequence_for<Fields...>;
+        using pointers = std::tuple<Fields*...>;
+
+        void* block = nullptr;
+        pointers cols{}; // 没有分配时全为空
+        size_t len = 0;
+        size_t cap = 0;
+
+        static constexpr bool trivial = (std::is_trivially_copyable<Fields>::value and ...);
+
+        // 对每一列调用 f(std::integral_constant<size_t, I>)
+        template<typename F, size_t... I>
+        static void each(F&& f, std::index_sequence<I...>)
+        {
+            (f(std::integral_constant<size_t, I>()), ...);
+        }
+
+        template<typename F>
+        static void each(F&& f)
+        {
+            each(f, indices());
+        }
+
+        static size_t round_up(size_t bytes) noexcept
+        {
+            return (bytes + alignment - 1) & ~(alignment - 1);
+        }
+
+        static size_t block_bytes(size_t n) noexcept
+        {
+            return (round_up(n * sizeof(Fields)) + ...);
+        }
+
+        // 把一块内存按容量n切成各列
+        static pointers carve(void* mem, size_t n) noexcept
+        {
+            pointers out;
+            char* p = static_cast<char*>(mem);
+            each([&](auto c)
+            {
+                constexpr size_t I = decltype(c)::value;
+                std::get<I>(out) = reinterpret_cast<field_type<I>*>(p);
+                p += round_up(n * sizeof(field_type<I>));
+            });
+            return out;
+        }
+
+        static void free_block(void* mem) noexcept
+        {
+            if(mem) ::operator delete(mem, std::align_val_t(alignment));
+        }
+
+        template<typename T>
+        static void destroy(T* first, T* last) noexcept
+        {
+            if constexpr(!std::is_trivially_destructible<T>::value)
+                for(; first != last; ++first) first->~T();
+        }
+
+        // 销毁第i行的前count列（构造一行时中途抛异常用）
+        static void destroy_prefix(const pointers& at, size_t i, size_t count) noexcept
+        {
+            each([&](auto c)
+            {
+                constexpr size_t I = decltype(c)::value;
+                if(I < count) destroy(std::get<I>(at) + i, std::get<I>(at) + i + 1);
+            });
+        }
+
+        // 在第i行逐列构造；某一列抛异常时把这一行已构造的列销毁，然后继续抛出
+        template<size_t... I, typename... Args>
+        static void construct_row(const pointers& at, size_t i, std::index_sequence<I...>, Args&&... args)
+        {
+            size_t done = 0;
+            try
+            {
+                ((::new(static_cast<void*>(std::get<I>(at) + i)) field_type<I>(std::forward<Args>(args)), done++), ...);
+            }
+            catch(...)
+            {
+                destroy_prefix(at, i, done);
+                throw;
+            }
+        }
+
+        template<typename T>
+        static void relocate(T* from, size_t n, T* to) noexcept
+        {
+            if constexpr(is_trivially_relocatable<T>::value)
+            {
+                if(n) std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+            }
+            else
+            {
+                for(size_t i = 0; i < n; i++)
+                {
+                    ::new(static_cast<void*>(to + i)) T(std::move(from[i]));
+                    from[i].~T();
+                }
+            }
+        }
+
+        // 把现有的len行搬到新块里，换上新块
+        void adopt(void* mem, const pointers& to, size_t new_cap) noexcept
+        {
+            each([&](auto c)
+            {
+                constexpr size_t I = decltype(c)::value;
+                relocate(std::get<I>(cols), len, std::get<I>(to));
+            });
+            free_block(block);
+            block = mem;
+            cols = to;
+            cap = new_cap;
+        }
+
+        void reallocate(size_t new_cap)
+        {
+            void* mem = ::operator new(block_bytes(new_cap), std::align_val_t(alignment));
+            adopt(mem, carve(mem, new_cap), new_cap);
+        }
+
+        // 每列都按缓存行对齐，容量太小时大部分是填充
+        size_t next_capacity(size_t need) const
+        {
+            if(need > max_size()) throw std::length_error("soa_vector: too many rows");
+            size_t grown = cap + cap / 2;
+            return std::max({need, grown, size_t(16)});
+        }
+
+        // 先在新块上构造新行（参数可能引用着旧块里的元素），再搬旧行
+        template<typename... Args>
+        __attribute__((noinline)) void grow_emplace_back(Args&&... args)
+        {
+            size_t new_cap = next_capacity(len + 1);
+            void* mem = ::operator new(block_bytes(new_cap), std::align_val_t(alignment));
+            pointers to = carve(mem, new_cap);
+            try
+            {
+                construct_row(to, len, indices(), std::forward<Args>(args)...);
+            }
+            catch(...)
+            {
+                free_block(mem);
+                throw;
+            }
+            adopt(mem, to, new_cap);
+            len++;
+        }
+
+        template<size_t... I>
+        reference row(size_t i, std::index_sequence<I...>) noexcept
+        {
+            return reference(std::get<I>(cols)[i]...);
+        }
+
+        template<size_t... I>
+        const_reference row(size_t i, std::index_sequence<I...>) const noexcept
+        {
+            return const_reference(std::get<I>(cols)[i]...);
+        }
+
+        template<typename T>
+        static void erase_column(T* col, size_t first, size_t last, size_t n) noexcept
+        {
+            if constexpr(is_trivially_relocatable<T>::value)
+            {
+                destroy(col + first, col + last);
+                std::memmove(static_cast<void*>(col + first), static_cast<const void*>(col + last), (n - last) * sizeof(T));
+            }
+            else
+            {
+                T* tail = std::move(col + last, col + n, col + first);
+                destroy(tail, col + n);
+            }
+        }
+
+    public:
+        // 行迭代器：解引用得到行代理（引用的tuple），可以配合结构化绑定使用
+        template<bool Const>
+        class row_iterator
+        {
+            private:
+                using owner = std::conditional_t<Const, const soa_vector, soa_vector>;
+                owner* vec;
+                size_t at;
+
+            public:
+                using iterator_category = std::input_iterator_tag; // 代理引用，不满足前向迭代器的要求
+                using value_type = typename soa_vector::value_type;
+                using reference = std::conditional_t<Const, typename soa_vector::const_reference,
+                                                     typename soa_vector::reference>;
+                using difference_type = ptrdiff_t;
+                using pointer = void;
+
+                row_iterator(owner* v, size_t i) noexcept : vec(v), at(i) {}
+
+                reference operator*() const noexcept { return (*vec)[at]; }
+
+                row_iterator& operator++() noexcept
+                {
+                    at++;
+                    return *this;
+                }
+
+                row_iterator operator++(int) noexcept
+                {
+                    row_iterator old = *this;
+                    at++;
+                    return old;
+                }
+
+                size_t index() const noexcept { return at; }
+
+                bool operator==(const row_iterator& other) const noexcept { return at == other.at; }
+                bool operator!=(const row_iterator& other) const noexcept { return at != other.at; }
+        };
+
+        using iterator = row_iterator<false>;
+        using const_iterator = row_iterator<true>;
+
+        soa_vector() noexcept = default;
+
+        soa_vector(const soa_vector& other) : soa_vector()
+        {
+            reserve(other.len);
+            if constexpr(trivial)
+            {
+                each([&](auto c)
+                {
+                    constexpr size_t I = decltype(c)::value;
+                    if(other.len)
+                        std::memcpy(static_cast<void*>(std::get<I>(cols)), static_cast<const void*>(std::get<I>(other.cols)),
+                                    other.len * sizeof(field_type<I>));
+                });
+                len = other.len;
+            }
+            else
+            {
+                for(size_t i = 0; i < other.len; i++)
+                    std::apply([this](const Fields&... fields) { emplace_back(fields...); }, other[i]);
+            }
+        }
+
+        soa_vector(soa_vector&& other) noexcept
+            : block(std::exchange(other.block, nullptr)), cols(std::exchange(other.cols, pointers())),
+              len(std::exchange(other.len, 0)), cap(std::exchange(other.cap, 0)) {}
+
+        soa_vector& operator=(const soa_vector& other)
+        {
+            if(this != &other)
+            {
+                soa_vector copy(other);
+                swap(copy);
+            }
+            return *this;
+        }
+
+        soa_vector& operator=(soa_vector&& other) noexcept
+        {
+            if(this != &other)
+            {
+                soa_vector moved(std::move(other));
+                swap(moved);
+            }
+            return *this;
+        }
+
+        ~soa_vector()
+        {
+            clear();
+            free_block(block);
+        }
+
+        reference operator[](size_t i) noexcept { return row(i, indices()); }
+        const_reference operator[](size_t i) const noexcept { return row(i, indices()); }
+
+        reference at(size_t i)
+        {
+            if(i >= len) throw std::out_of_range("soa_vector::at");
+            return (*this)[i];
+        }
+
+        const_reference at(size_t i) const
+        {
+            if(i >= len) throw std::out_of_range("soa_vector::at");
+            return (*this)[i];
+        }
+
+        reference front() noexcept { return (*this)[0]; }
+        const_reference front() const noexcept { return (*this)[0]; }
+        reference back() noexcept { return (*this)[len - 1]; }
+        const_reference back() const noexcept { return (*this)[len - 1]; }
+
+        // 第I列的起始地址；告诉编译器它按 alignment 对齐，循环向量化时不需要处理未对齐的头部
+        template<size_t I>
+        field_type<I>* data() noexcept
+        {
+            return static_cast<field_type<I>*>(__builtin_assume_aligned(std::get<I>(cols), alignment));
+        }
+
+        template<size_t I>
+        const field_type<I>* data() const noexcept
+        {
+            return static_cast<const field_type<I>*>(__builtin_assume_aligned(std::get<I>(cols), alignment));
+        }
+
+        template<size_t I>
+        column_span<field_type<I>> column() noexcept
+        {
+            return column_span<field_type<I>>(data<I>(), len);
+        }
+
+        template<size_t I>
+        column_span<const field_type<I>> column() const noexcept
+        {
+            return column_span<const field_type<I>>(data<I>(), len);
+        }
+
+        iterator begin() noexcept { return iterator(this, 0); }
+        iterator end() noexcept { return iterator(this, len); }
+        const_iterator begin() const noexcept { return const_iterator(this, 0); }
+        const_iterator end() const noexcept { return const_iterator(this, len); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        size_t size() const noexcept { return len; }
+        size_t capacity() const noexcept { return cap; }
+        bool empty() const noexcept { return len == 0; }
+
+        static constexpr size_t max_size() noexcept
+        {
+            return size_t(-1) / 2 / (sizeof(Fields) + ...);
+        }
+
+        void reserve(size_t n)
+        {
+            if(n <= cap) return;
+            if(n > max_size()) throw std::length_error("soa_vector: too many rows");
+            reallocate(n);
+        }
+
+        void shrink_to_fit()
+        {
+            if(len == cap) return;
+            if(len == 0)
+            {
+                free_block(block);
+                block = nullptr;
+                cols = pointers();
+                cap = 0;
+                return;
+            }
+            reallocate(len);
+        }
+
+        void clear() noexcept
+        {
+            each([&](auto c)
+            {
+                constexpr size_t I = decltype(c)::value;
+                destroy(std::get<I>(cols), std::get<I>(cols) + len);
+            });
+            len = 0;
+        }
+
+        // 每个字段一个参数，依次构造各列的新元素
+        template<typename... Args>
+        reference emplace_back(Args&&... args)
+        {
+            static_assert(sizeof...(Args) == columns, "soa_vector::emplace_back: one argument per field");
+            if(len == cap)
+                grow_emplace_back(std::forward<Args>(args)...);
+            else
+            {
+                construct_row(cols, len, indices(), std::forward<Args>(args)...);
+                len++;
+            }
+            return back();
+        }
+
+        void push_back(const value_type& value)
+        {
+            std::apply([this](const Fields&... fields) { emplace_back(fields...); }, value);
+        }
+
+        void push_back(value_type&& value)
+        {
+            std::apply([this](Fields&... fields) { emplace_back(std::move(fields)...); }, value);
+        }
+
+        void pop_back() noexcept
+        {
+            len--;
+            each([&](auto c)
+            {
+                constexpr size_t I = decltype(c)::value;
+                destroy(std::get<I>(cols) + len, std::get<I>(cols) + len + 1);
+            });
+        }
+
+        // 删除 [first, last) 行，后面的行逐列前移，保持顺序
+        void erase(size_t first, size_t last) noexcept
+        {
+            if(first == last) return;
+            each([&](auto c)
+            {
+                constexpr size_t I = decltype(c)::value;
+                erase_column(std::get<I>(cols), first, last, len);
+            });
+            len -= last - first;
+        }
+
+        void erase(size_t index) noexcept
+        {
+            erase(index, index + 1);
+        }
+
+        // 用最后一行覆盖第index行：O(1)，不保持顺序（连接表删除常用）
+        void swap_erase(size_t index) noexcept
+        {
+            each([&](auto c)
+            {
+                constexpr size_t I = decltype(c)::value;
+                auto* col = std::get<I>(cols);
+                if(index != len - 1) col[index] = std::move(col[len - 1]);
+                destroy(col + len - 1, col + len);
+            });
+            len--;
+        }
+
+        // 新增的行逐列值初始化
+        void resize(size_t n)
+        {
+            if(n < len)
+            {
+                erase(n, len);
+                return;
+            }
+            reserve(n);
+            while(len < n) emplace_back(Fields()...);
+        }
+
+        void swap(soa_vector& other) noexcept
+        {
+            std::swap(block, other.block);
+            std::swap(cols, other.cols);
+            std::swap(len, other.len);
+            std::swap(cap, other.cap);
+        }
+};
+
+template<typename... Fields>
+void swap(soa_vector<Fields...>& a, soa_vector<Fields...>& b) noexcept
+{
+    a.swap(b);
+}
+
+#endif // SOA_VECTOR_HPP
@@ -0,0 +1,151 @@
+#include "minivector.hpp"
+#include "arena.hpp"
+#include "flat_map.hpp"
+#include "flat_set.hpp"
+#include "soa_vector.hpp"
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// 打印构造/移动/析构，观察元素什么时候被搬动
+class Tracked
+{
+    private:
+        int val;
+    public:
+        explicit Tracked(int _val = 0) : val(_val) {}
+        Tracked(const Tracked& other) : val(other.val) { std::cout << "copy " << val << std::endl; }
+        Tracked(Tracked&& other) noexcept : val(other.val) { std::cout << "move " << val << std::endl; }
+        Tracked& operator=(const Tracked&) = default;
+        Tracked& operator=(Tracked&&) noexcept = default;
+        ~Tracked() = default;
+        int get() const { return val; }
+};
+
+// 只含一个指针的句柄：声明为可按字节搬家，扩容时整块memcpy
+struct Handle
+{
+    int* p;
+    explicit Handle(int* _p = nullptr) : p(_p) {}
+    Handle(const Handle& other) : p(other.p) {}
+};
+
+template<>
+struct is_trivially_relocatable<Handle> : std::true_type {};
+
+template<typename V>
+void print(const char* name, const V& v)
+{
+    std::cout << name << " size " << v.size() << " capacity " << v.capacity() << " inline " << v.is_inline() << " :";
+    for(const auto& x : v) std::cout << ' ' << x;
+    std::cout << std::endl;
+}
+
+int main()
+{
+    // 场景1：不超过N个元素时不分配堆内存
+    {
+        minivector<int, 4> v = {1, 2, 3};
+        print("v", v); // size 3 capacity 4 inline 1
+        v.push_back(4);
+        v.push_back(5); // 第5个元素：搬到堆上，容量按1.5倍增长（至少4）
+        print("v", v); // size 5 capacity 6 inline 0
+    }
+
+    // 场景2：中间插入、删除
+    {
+        minivector<int, 8> v = {1, 2, 4, 5};
+        v.insert(v.begin() + 2, 3);
+        v.erase(v.begin());
+        v.insert(v.end(), {6, 7});
+        print("v", v); // 2 3 4 5 6 7
+        v.erase(v.begin() + 1, v.begin() + 3);
+        print("v", v); // 2 5 6 7
+    }
+
+    // 场景3：扩容时移动不抛异常的类型被移动（不是拷贝）
+    {
+        minivector<Tracked, 1> v;
+        v.emplace_back(1);
+        v.emplace_back(2); // 扩容：2直接构造在新内存上，1被移动过去
+        std::cout << "Tracked: " << v[0].get() << ' ' << v[1].get() << std::endl;
+    }
+
+    // 场景4：push_back自身的元素，扩容时也安全
+    {
+        minivector<std::string, 2> v = {"alpha", "beta"};
+        v.push_back(v[0]);
+        print("strings", v); // alpha beta alpha
+    }
+
+    // 场景5：可按字节搬家的类型
+    {
+        int x = 42;
+        minivector<Handle, 2> v;
+        for(int i = 0; i < 5; i++) v.emplace_back(&x);
+        std::cout << "Handle size " << v.size() << " value " << *v.back().p << std::endl; // 5 42
+    }
+
+    // 场景6：移动：堆上的直接接管指针，内联的逐个搬过来
+    {
+        minivector<int, 4> small = {1, 2};
+        minivector<int, 4> big = {1, 2, 3, 4, 5, 6};
+        const int* heap = big.data();
+        minivector<int, 4> a(std::move(small));
+        minivector<int, 4> b(std::move(big));
+        std::cout << "moved: " << a.size() << ' ' << b.size() << " same heap " << (b.data() == heap)
+                  << " source empty " << small.empty() << big.empty() << std::endl; // 2 6 same heap 1 source empty 11
+        b.resize(3);
+        b.shrink_to_fit(); // 放得下，搬回内联缓冲区
+        print("b", b); // size 3 capacity 4 inline 1
+    }
+
+    // 场景7：每个请求一个arena：容器从arena分配，请求结束时先销毁容器，再整体reset
+    {
+        monotonic_arena arena(1024);
+        for(int request = 0; request < 3; request++)
+        {
+            {
+                minivector<int, 4, arena_allocator<int>> ids{arena_allocator<int>(arena)};
+                for(int i = 0; i < 100; i++) ids.push_back(i);
+                pmr_minivector<std::pmr::string, 2> names(&arena); // pmr::string元素也从同一个arena分配
+                names.emplace_back("a fairly long name that does not fit in SSO");
+                std::cout << "request " << request << ": " << ids.size() << " ids, arena used " << arena.bytes_used()
+                          << " bytes in " << arena.chunk_count() << " chunk(s)" << std::endl;
+            }
+            arena.reset();
+        }
+    }
+
+    // 场景8：结构数组：每个字段一列，扫描一列只读这一列；增删时各列一起移动
+    {
+        soa_vector<int, std::string, long> conns; // fd, 对端地址, 收到的字节数
+        for(int fd = 3; fd < 8; fd++) conns.emplace_back(fd, "10.0.0." + std::to_string(fd), fd * 100L);
+        conns.erase(0);      // 删除fd 3，后面的行前移
+        conns.swap_erase(1); // 删除fd 5，最后一行（fd 7）补到它的位置
+        long total = 0;
+        for(long bytes : conns.column<2>()) total += bytes;
+        std::cout << "soa rows " << conns.size() << " total bytes " << total << " column aligned "
+                  << (reinterpret_cast<uintptr_t>(conns.data<2>()) % 64 == 0) << " :"; // rows 3 total 1700 aligned 1
+        for(auto [fd, addr, bytes] : conns) std::cout << ' ' << fd << '/' << addr;
+        std::cout << std::endl; // 4/10.0.0.4 7/10.0.0.7 6/10.0.0.6
+    }
+
+    // 场景9：有序数组实现的集合/映射：不超过N个元素时不分配；批量插入先排序再归并
+    {
+        flat_set<int, std::greater<int>> fds = {5, 9, 7}; // 降序：*begin() 就是最大的fd
+        fds.insert({4, 9, 12});                            // 重复的9被丢弃
+        fds.erase(12);
+        std::cout << "fds max " << *fds.begin() << " :";
+        for(int fd : fds) std::cout << ' ' << fd;
+        std::cout << std::endl; // max 9 : 9 7 5 4
+
+        flat_map<std::string, int, std::less<>> counts; // 透明比较器：可以用string_view查找，不构造std::string
+        for(const char* word : {"get", "set", "get", "del", "get"}) counts[word]++;
+        std::string_view key = "get";
+        std::cout << "counts " << counts.size() << " get " << counts.find(key)->second << " has put "
+                  << counts.contains(std::string_view("put")) << std::endl; // counts 3 get 3 has put 0
+    }
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+// atomic_shared_ptr基准：一个写线程不停发布新配置，N个读线程反复取配置快照并读取其中的字段
+//   shared_mutex        读线程持shared_lock直接读字段（C++MultiThreadingProgram/sharedmutexs.cpp 的做法）
+//   shared_mutex+copy   读线程持shared_lock拷贝一份shared_ptr快照，解锁后再读
+//   atomic_shared_ptr   本库的分裂计数实现，load 取快照
+//   std::atomic_load    std::shared_ptr 的原子自由函数（libstdc++ 用一组全局互斥锁实现）
+// 报告读线程合计的百万次/秒与写线程每秒发布次数
+// 用法: ./atomic_shared_ptr_bench [每组持续毫秒，默认500] [写间隔微秒，默认0即连续发布]
+#include "atomic_shared_ptr.hpp"
+#include "smartpointer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Config
+{
+    long version;
+    long limits[7];
+    explicit Config(long v) : version(v), limits{v, v, v, v, v, v, v} {}
+};
+
+// 每个读线程的计数独占一条缓存行，避免统计本身引起伪共享
+struct alignas(64) ReaderStat
+{
+    long reads = 0;
+    long checksum = 0;
+};
+
+// Store 发布一个新版本，Read 取一次快照并返回某个字段
+template<typename Store, typename Read>
+static void run(const char* name, int readers, int millis, int interval_us, Store store, Read read)
+{
+    std::vector<ReaderStat> stats(readers);
+    std::atomic<bool> stop{false};
+    std::atomic<int> ready{0};
+    std::atomic<long> writes{0};
+
+    std::vector<std::thread> threads;
+    for(int i = 0; i < readers; i++)
+    {
+        threads.emplace_back([&, i]()
+        {
+            ReaderStat& stat = stats[i];
+            ready.fetch_add(1);
+            while(!stop.load(std::memory_order_relaxed))
+            {
+                stat.checksum += read();
+                stat.reads++;
+            }
+        });
+    }
+    while(ready.load() != readers) std::this_thread::yield();
+
+    // 写线程单独跑：shared_mutex 在读线程多时写者可能一直拿不到锁，由主线程按时间结束整组
+    auto start = Clock::now();
+    std::thread writer([&]()
+    {
+        for(long version = 1; !stop.load(std::memory_order_relaxed); version++)
+        {
+            store(version);
+            writes.store(version, std::memory_order_relaxed);
+            if(interval_us) std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(millis));
+    stop.store(true);
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    long published = writes.load(); // 写线程可能还卡在最后一次store里，这一次不计
+    for(auto& t : threads) t.join();
+    writer.join();
+
+    long reads = 0, checksum = 0;
+    for(const auto& s : stats)
+    {
+        reads += s.reads;
+        checksum += s.checksum;
+    }
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << reads / secs / 1e6 << std::setprecision(0) << std::setw(14) << published / secs
+              << "   (checksum " << checksum % 1000 << ")" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int millis = argc > 1 ? std::stoi(argv[1]) : 500;
+    int interval_us = argc > 2 ? std::stoi(argv[2]) : 0;
+    std::cout << "1 writer, " << (interval_us ? std::to_string(interval_us) + " us between updates" : "back-to-back updates")
+              << ", " << millis << " ms per run, " << std::thread::hardware_concurrency() << " cpus" << std::endl;
+
+    for(int readers : {1, 2, 4, 8, 16})
+    {
+        std::cout << "\n" << readers << " readers" << std::setw(25) << "reads Mops/s" << std::setw(14) << "writes/s"
+                  << std::endl;
+        {
+            std::shared_mutex mtx;
+            Config config(0);
+            run("shared_mutex", readers, millis, interval_us,
+                [&](long v) { std::unique_lock<std::shared_mutex> lock(mtx); config = Config(v); },
+                [&]() { std::shared_lock<std::shared_mutex> lock(mtx); return config.version + config.limits[6]; });
+        }
+        {
+            std::shared_mutex mtx;
+            shared_ptr<Config> config = make_shared<Config>(0);
+            run("shared_mutex+copy", readers, millis, interval_us,
+                [&](long v)
+                {
+                    shared_ptr<Config> next = make_shared<Config>(v);
+                    std::unique_lock<std::shared_mutex> lock(mtx);
+                    std::swap(config, next); // 旧配置在解锁后随next析构
+                },
+                [&]()
+                {
+                    shared_ptr<Config> snapshot;
+                    {
+                        std::shared_lock<std::shared_mutex> lock(mtx);
+                        snapshot = config;
+                    }
+                    return snapshot->version + snapshot->limits[6];
+                });
+        }
+        {
+            atomic_shared_ptr<Config> config(make_shared<Config>(0));
+            run("atomic_shared_ptr", readers, millis, interval_us,
+                [&](long v) { config.store(make_shared<Config>(v)); },
+                [&]()
+                {
+                    shared_ptr<Config> snapshot = config.load();
+                    return snapshot->version + snapshot->limits[6];
+                });
+        }
+        {
+            std::shared_ptr<Config> config = std::make_shared<Config>(0);
+            run("std::atomic_load", readers, millis, interval_us,
+                [&](long v) { std::atomic_store(&config, std::make_shared<Config>(v)); },
+                [&]()
+                {
+                    std::shared_ptr<Config> snapshot = std::atomic_load(&config);
+                    return snapshot->version + snapshot->limits[6];
+                });
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+// intrusive_ptr基准：一百万个句柄的容器，比较侵入式计数与本库shared_ptr
+//   size     句柄大小与每个对象的堆内存
+//   copy     单线程反复拷贝/销毁同一个句柄
+//   clone    整个容器拷贝一份（按随机顺序排列的句柄，每个元素的计数都要改，主要看缓存行）
+//   walk     按容器顺序读对象并读计数
+// 用法: ./intrusive_bench [句柄个数，默认1000000] [拷贝次数，默认20000000]
+#include "intrusive_ptr.hpp"
+#include "smartpointer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static size_t g_bytes = 0;
+
+// 只替换operator new用来统计字节数；默认的operator delete本来就用free释放
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    g_bytes += size;
+    if(void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+template<typename P>
+static void escape(const P& p)
+{
+    asm volatile("" : : "g"(&p) : "memory");
+}
+
+// 24字节的载荷，加上各自的计数
+struct Payload
+{
+    long value;
+    long extra[2];
+    explicit Payload(long v) : value(v), extra{} {}
+};
+
+struct Node : Payload, intrusive_ref_counter<Node>
+{
+    explicit Node(long v) : Payload(v) {}
+};
+
+struct LocalNode : Payload, intrusive_ref_counter<LocalNode, single_thread_policy>
+{
+    explicit LocalNode(long v) : Payload(v) {}
+};
+
+static long count_of(const shared_ptr<Payload>& p) { return static_cast<long>(p.get_count()); }
+template<typename T>
+static long count_of(const intrusive_ptr<T>& p) { return static_cast<long>(p->use_count()); }
+
+template<typename Ptr, typename Make>
+static void run(const char* name, size_t count, long copies, Make make)
+{
+    // 按随机顺序放进容器，模拟连接表等长期存活、访问顺序与分配顺序无关的句柄集合
+    std::vector<Ptr> handles;
+    handles.reserve(count);
+    size_t bytes0 = g_bytes;
+    for(size_t i = 0; i < count; i++) handles.push_back(make(static_cast<long>(i)));
+    double heap = static_cast<double>(g_bytes - bytes0) / count;
+    std::shuffle(handles.begin(), handles.end(), std::mt19937_64(42));
+
+    auto start = Clock::now();
+    for(long n = 0; n < copies; n++)
+    {
+        Ptr copy = handles[0];
+        escape(copy);
+    }
+    double copy_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / copies;
+
+    start = Clock::now();
+    {
+        std::vector<Ptr> clone = handles;
+        escape(clone);
+    }
+    double clone_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    long sum = 0;
+    start = Clock::now();
+    for(const Ptr& p : handles) sum += p->value + count_of(p);
+    double walk_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::cout << std::left << std::setw(26) << name << std::right << std::setw(8) << sizeof(Ptr) << std::fixed
+              << std::setprecision(1) << std::setw(10) << heap << std::setprecision(2) << std::setw(12) << copy_ns
+              << std::setprecision(1) << std::setw(12) << clone_ms << std::setw(12) << walk_ms
+              << "   (checksum " << sum % 1000 << ")" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    long copies = argc > 2 ? std::stol(argv[2]) : 20000000;
+    std::cout << count << " handles, " << sizeof(Payload) << "-byte payload\n\n"
+              << std::left << std::setw(26) << "" << std::right << std::setw(8) << "handle" << std::setw(10)
+              << "heap/obj" << std::setw(12) << "copy ns" << std::setw(12) << "clone ms" << std::setw(12)
+              << "walk ms" << std::endl;
+
+    run<intrusive_ptr<Node>>("intrusive_ptr", count, copies, [](long v) { return make_intrusive<Node>(v); });
+    run<intrusive_ptr<LocalNode>>("intrusive_ptr (local)", count, copies,
+                                  [](long v) { return make_intrusive<LocalNode>(v); });
+    run<shared_ptr<Payload>>("make_shared", count, copies, [](long v) { return make_shared<Payload>(v); });
+    run<shared_ptr<Payload>>("shared_ptr(new T)", count, copies,
+                             [](long v) { return shared_ptr<Payload>(new Payload(v)); });
+    return 0;
+}
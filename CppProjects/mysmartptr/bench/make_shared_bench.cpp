@@ -0,0 +1,148 @@
+// make_shared基准：创建一百万个共享对象，再按随机顺序遍历（读对象和引用计数）
+//   new+shared_ptr   shared_ptr<T>(new T)：对象和控制块两次分配
+//   make_shared      对象放在控制块内，一次分配
+//   std::...         同样两种方式的std::shared_ptr作为参照
+// 统计每个对象的堆分配次数与字节数、创建和遍历耗时，以及遍历期间的缓存未命中数（perf_event，不可用时显示n/a）
+// 用法: ./make_shared_bench [对象个数，默认1000000]
+#include "smartpointer.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static size_t g_allocations = 0;
+static size_t g_bytes = 0;
+
+// 只替换operator new用来计数；默认的operator delete本来就用free释放
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    g_allocations++;
+    g_bytes += size;
+    if(void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+// 遍历期间的缓存未命中计数；虚拟机或权限不足时打不开
+class CacheMissCounter
+{
+    private:
+        int fd = -1;
+    public:
+        CacheMissCounter()
+        {
+            perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+        ~CacheMissCounter()
+        {
+            if(fd != -1) close(fd);
+        }
+        void start()
+        {
+            if(fd == -1) return;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        // 返回-1表示不可用
+        long long stop()
+        {
+            if(fd == -1) return -1;
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            long long count = 0;
+            if(read(fd, &count, sizeof(count)) != sizeof(count)) return -1;
+            return count;
+        }
+};
+
+struct Node
+{
+    long value;
+    long padding[3]; // 32字节的小对象，典型的连接记录/消息大小
+    explicit Node(long v) : value(v), padding{} {}
+};
+
+template<typename Ptr, typename Make>
+static void run(const char* name, size_t count, Make make)
+{
+    std::vector<Ptr> handles;
+    handles.reserve(count);
+
+    size_t allocations0 = g_allocations, bytes0 = g_bytes;
+    auto start = Clock::now();
+    for(size_t i = 0; i < count; i++) handles.push_back(make(static_cast<long>(i)));
+    double create_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    double allocations = static_cast<double>(g_allocations - allocations0) / count;
+    double bytes = static_cast<double>(g_bytes - bytes0) / count;
+
+    // 打乱访问顺序，让硬件预取帮不上忙，每次访问的代价主要取决于对象和计数占了几个缓存行
+    std::vector<size_t> order(count);
+    for(size_t i = 0; i < count; i++) order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+
+    CacheMissCounter misses;
+    long sum = 0;
+    misses.start();
+    start = Clock::now();
+    for(size_t i : order)
+    {
+        const Ptr& p = handles[i];
+        sum += p->value + static_cast<long>(p.use_count());
+    }
+    double traverse_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    long long miss = misses.stop();
+
+    start = Clock::now();
+    handles.clear();
+    double destroy_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << allocations << std::setw(10) << bytes << std::setw(12) << create_ms
+              << std::setw(12) << traverse_ms << std::setw(12) << destroy_ms << std::setw(14);
+    if(miss < 0) std::cout << "n/a";
+    else std::cout << std::setprecision(2) << static_cast<double>(miss) / count;
+    std::cout << "   (checksum " << sum % 1000 << ")" << std::endl;
+}
+
+// 本库的shared_ptr用get_count，与std::shared_ptr::use_count统一一下接口
+template<typename T>
+struct counted : shared_ptr<T>
+{
+    counted(shared_ptr<T>&& p) : shared_ptr<T>(std::move(p)) {}
+    size_t use_count() const noexcept { return this->get_count(); }
+};
+
+int main(int argc, char* argv[])
+{
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::cout << count << " objects of " << sizeof(Node) << " bytes\n\n"
+              << std::left << std::setw(22) << "" << std::right << std::setw(10) << "allocs" << std::setw(10)
+              << "bytes" << std::setw(12) << "create ms" << std::setw(12) << "walk ms" << std::setw(12)
+              << "destroy ms" << std::setw(14) << "misses/obj" << std::endl;
+
+    run<counted<Node>>("new+shared_ptr", count, [](long v) { return counted<Node>(shared_ptr<Node>(new Node(v))); });
+    run<counted<Node>>("make_shared", count, [](long v) { return counted<Node>(make_shared<Node>(v)); });
+    run<std::shared_ptr<Node>>("new+std::shared_ptr", count, [](long v) { return std::shared_ptr<Node>(new Node(v)); });
+    run<std::shared_ptr<Node>>("std::make_shared", count, [](long v) { return std::make_shared<Node>(v); });
+    std::cout << "\nbytes: heap bytes requested per object (excluding malloc's own header)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,98 @@
+// 对象池基准：小而短命的对象（每条消息一个任务），比较全局new与线程局部的分级空闲链表池
+//   churn    创建后立即销毁，反复进行（池的最好情况：总是复用同一块）
+//   batch    先创建一批存活对象，再按随机顺序销毁（空闲链表被打乱后的复用）
+//   threads  多个线程各自做churn（malloc的线程缓存 vs 池的线程局部链表）
+// 用法: ./pool_bench [churn次数，默认5000000] [batch大小，默认100000] [线程数，默认4]
+#include "object_pool.hpp"
+#include "smartpointer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template<typename P>
+static void escape(const P& p)
+{
+    asm volatile("" : : "g"(&p) : "memory");
+}
+
+// 48字节的任务对象
+struct Task
+{
+    long id;
+    long args[5];
+    explicit Task(long v) : id(v), args{v, v, v, v, v} {}
+};
+
+template<typename Make>
+static double churn(long iterations, Make make)
+{
+    auto start = Clock::now();
+    for(long i = 0; i < iterations; i++)
+    {
+        auto p = make(i);
+        escape(p);
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+template<typename Make>
+static double batch(size_t count, Make make)
+{
+    using Ptr = decltype(make(0));
+    std::vector<Ptr> live;
+    live.reserve(count);
+    std::mt19937_64 rng(42);
+    const int rounds = 10;
+    auto start = Clock::now();
+    for(int r = 0; r < rounds; r++)
+    {
+        for(size_t i = 0; i < count; i++) live.push_back(make(static_cast<long>(i)));
+        std::shuffle(live.begin(), live.end(), rng);
+        live.clear();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (rounds * count);
+}
+
+template<typename Make>
+static double threads(int count, long iterations, Make make)
+{
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for(int t = 0; t < count; t++) workers.emplace_back([&]() { churn(iterations, make); });
+    for(auto& w : workers) w.join();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (count * iterations);
+}
+
+template<typename Make>
+static void run(const char* name, long iterations, size_t batch_size, int thread_count, Make make)
+{
+    using Ptr = decltype(make(0));
+    std::cout << std::left << std::setw(20) << name << std::right << std::setw(8) << sizeof(Ptr) << std::fixed
+              << std::setprecision(1) << std::setw(12) << churn(iterations, make) << std::setw(12)
+              << batch(batch_size, make) << std::setw(12) << threads(thread_count, iterations / thread_count, make)
+              << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    long iterations = argc > 1 ? std::stol(argv[1]) : 5000000;
+    size_t batch_size = argc > 2 ? std::stoul(argv[2]) : 100000;
+    int thread_count = argc > 3 ? std::stoi(argv[3]) : 4;
+    std::cout << sizeof(Task) << "-byte objects, " << thread_count << " threads, ns per create+destroy\n\n"
+              << std::left << std::setw(20) << "" << std::right << std::setw(8) << "handle" << std::setw(12)
+              << "churn" << std::setw(12) << "batch" << std::setw(12) << "threads" << std::endl;
+
+    run("make_unique", iterations, batch_size, thread_count, [](long v) { return make_unique<Task>(v); });
+    run("make_pool_unique", iterations, batch_size, thread_count, [](long v) { return make_pool_unique<Task>(v); });
+    run("make_shared", iterations, batch_size, thread_count, [](long v) { return make_shared<Task>(v); });
+    run("make_pool_shared", iterations, batch_size, thread_count, [](long v) { return make_pool_shared<Task>(v); });
+    return 0;
+}
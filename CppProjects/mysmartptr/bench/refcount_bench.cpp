@@ -0,0 +1,85 @@
+// 引用计数基准：多个线程反复拷贝并销毁shared_ptr，比较本库的原子计数、单线程计数与std::shared_ptr
+//   shared  所有线程拷贝同一个对象（同一个计数所在的缓存行在核间来回迁移）
+//   private 每个线程拷贝自己的对象（只有原子指令本身的开销）
+// 用法: ./refcount_bench [每个线程的拷贝次数，默认2000000]
+#include "smartpointer.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// 阻止编译器把一对拷贝/析构优化掉：计数必须真的写回内存
+template<typename P>
+static void escape(const P& p)
+{
+    asm volatile("" : : "g"(&p) : "memory");
+}
+
+// 每个线程执行 iterations 次 {拷贝; 析构}，返回总的百万次/秒
+template<typename Ptr, typename Make>
+static double run(int threads, long iterations, bool shared, Make make)
+{
+    Ptr common = make();
+    std::vector<Ptr> own;
+    for(int i = 0; i < threads; i++) own.push_back(make());
+
+    std::vector<std::thread> workers;
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    for(int i = 0; i < threads; i++)
+    {
+        workers.emplace_back([&, i]()
+        {
+            const Ptr& src = shared ? common : own[i];
+            ready.fetch_add(1);
+            while(!go.load()) std::this_thread::yield();
+            for(long n = 0; n < iterations; n++)
+            {
+                Ptr copy = src;
+                escape(copy);
+            }
+        });
+    }
+    while(ready.load() != threads) std::this_thread::yield();
+    auto start = Clock::now();
+    go.store(true);
+    for(auto& t : workers) t.join();
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    return threads * iterations / secs / 1e6;
+}
+
+int main(int argc, char* argv[])
+{
+    long iterations = argc > 1 ? std::stol(argv[1]) : 2000000;
+
+    std::cout << "copy+destroy, " << iterations << " per thread, " << std::thread::hardware_concurrency()
+              << " hardware threads, Mops/s (higher is better)\n\n"
+              << std::left << std::setw(10) << "threads" << std::setw(10) << "scenario" << std::right
+              << std::setw(14) << "atomic" << std::setw(14) << "local" << std::setw(18) << "std::shared_ptr" << std::endl;
+
+    for(int threads : {1, 2, 4, 8, 16, 32})
+    {
+        for(bool shared : {true, false})
+        {
+            double mine = run<shared_ptr<long>>(threads, iterations, shared, []() { return make_shared<long>(1); });
+            double theirs = run<std::shared_ptr<long>>(threads, iterations, shared, []() { return std::make_shared<long>(1); });
+            std::cout << std::left << std::setw(10) << threads << std::setw(10) << (shared ? "shared" : "private")
+                      << std::right << std::fixed << std::setprecision(1) << std::setw(14) << mine;
+            // 单线程计数不能跨线程共享同一对象，只测各线程私有对象的情况
+            if(shared) std::cout << std::setw(14) << "-";
+            else
+            {
+                double local = run<local_shared_ptr<long>>(threads, iterations, false, []() { return make_local_shared<long>(1); });
+                std::cout << std::setw(14) << local;
+            }
+            std::cout << std::setw(18) << theirs << std::endl;
+        }
+    }
+    return 0;
+}
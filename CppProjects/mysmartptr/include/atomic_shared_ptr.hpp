@@ -0,0 +1,213 @@
+#ifndef ATOMIC_SHARED_PTR_HPP
+#define ATOMIC_SHARED_PTR_HPP
+
+#include "smartpointer.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <thread> // std::this_thread::yield
+#include <utility>
+
+// 可以被多个线程同时 load/store 的 shared_ptr，典型用法是发布只读配置：
+// 写线程构造好新配置后 store，读线程 load 拿到一个快照，快照在读线程用完之前不会被释放
+//
+// 分裂引用计数：原子变量里把控制块地址和“已借出的引用数”打包进同一个64位字
+//   [ 控制块地址（48位） | 本批已借出数（16位） ]
+// store时预先在控制块的强计数上加好一批（kBatch）引用，由atomic_shared_ptr持有；
+// load 用一次CAS从这批里借出一个引用（不加锁，读线程之间只争用这一条缓存行），CAS保证借出数不超过预充数：
+// 借出的每个引用都已经记在控制块上，store换下旧值后块不会在读线程手里被释放。
+// 借出过半后，每个借到引用的读线程都尝试补充一批（手里有引用，块一定还活着；多个线程同时补充时只有一个生效）；
+// 借出数到达上限时新的load等待补充完成——只有约kBatch/2个load同时在补充前被挂起才会出现，
+// 所以load是无锁（lock-free）的但不是无等待（wait-free）的
+// store 用 exchange 换下旧值，旧控制块上未借出的预充引用一次性还掉
+//
+// load 返回的 shared_ptr 的计数记在 atomic_shared_ptr 内部的包装控制块上（每次store分配一个），
+// 它的 get_count() 还包含预充的那一批，没有参考意义；对象本身的寿命不受影响
+
+static_assert(sizeof(void*) == 8, "atomic_shared_ptr packs a 48-bit pointer and a 16-bit count into 64 bits");
+
+// 包装控制块：持有store进来的shared_ptr，load出去的引用都记在它上面。
+// 这样无论store进来的是make_shared的对象、自定义删除器还是派生类转换来的指针，读线程都能直接得到T*
+template<typename T>
+class control_block_alias final : public control_block<atomic_count_policy>
+{
+    private:
+        alignas(shared_ptr<T>) unsigned char storage[sizeof(shared_ptr<T>)];
+    public:
+        explicit control_block_alias(shared_ptr<T>&& value) noexcept
+        {
+            ::new (static_cast<void*>(storage)) shared_ptr<T>(std::move(value));
+        }
+
+        shared_ptr<T>& value() noexcept
+        {
+            return *std::launder(reinterpret_cast<shared_ptr<T>*>(storage));
+        }
+
+        void dispose() noexcept override
+        {
+            value().~shared_ptr<T>();
+        }
+
+        void destroy() noexcept override
+        {
+            delete this;
+        }
+};
+
+template<typename T>
+class atomic_shared_ptr
+{
+    private:
+        using block_type = control_block_alias<T>;
+
+        static constexpr int kCountBits = 16;
+        static constexpr uintptr_t kCountMask = (uintptr_t(1) << kCountBits) - 1;
+        // 每个控制块上预充的引用数；借出数最多到 kBatch-1，留一个给 exchange 交还旧值
+        static constexpr uintptr_t kBatch = 4096;
+        static constexpr uintptr_t kMaxUsed = kBatch - 1;
+
+        mutable std::atomic<uintptr_t> state{0};
+
+        static block_type* block_of(uintptr_t s) noexcept
+        {
+            return reinterpret_cast<block_type*>(s >> kCountBits);
+        }
+
+        static uintptr_t used_of(uintptr_t s) noexcept
+        {
+            return s & kCountMask;
+        }
+
+        // 把n个强引用还给控制块，最后一个负责析构
+        static void release_n(block_type* block, uintptr_t n) noexcept
+        {
+            if(n and block->shared_count.fetch_sub(n, std::memory_order_acq_rel) == n)
+            {
+                block->dispose();
+                block->release_weak();
+            }
+        }
+
+        // 接管一个借出的引用
+        static shared_ptr<T> adopt(block_type* block) noexcept
+        {
+            return shared_ptr<T>(block->value().get(), static_cast<control_block<atomic_count_policy>*>(block));
+        }
+
+        // 包装value并预充一批引用，返回打包后的状态
+        static uintptr_t make_state(shared_ptr<T> value)
+        {
+            if(!value) return 0;
+            // 已经是从别的atomic_shared_ptr里load出来的快照：取出里面的原值，避免包装层层嵌套
+            if(block_type* alias = dynamic_cast<block_type*>(value.control))
+            {
+                shared_ptr<T> inner = alias->value();
+                value = std::move(inner);
+            }
+            block_type* block = new block_type(std::move(value));
+            uintptr_t address = reinterpret_cast<uintptr_t>(block);
+            if(address >> (64 - kCountBits))
+            {
+                delete block;
+                throw std::bad_alloc(); // 地址超出48位，无法打包（目前的x86-64/AArch64用户空间不会出现）
+            }
+            block->shared_count.fetch_add(kBatch - 1, std::memory_order_relaxed); // 新块的计数本来是1
+            return address << kCountBits;
+        }
+
+        // 换下旧状态：旧块上本批未借出的预充引用还掉，保留keep个交给调用者
+        static void retire(uintptr_t old, uintptr_t keep) noexcept
+        {
+            if(block_type* block = block_of(old))
+                release_n(block, kBatch - used_of(old) - keep);
+        }
+
+        // 借出过半时补充一批：先在控制块上加，再把借出数减回去
+        // 调用者手里已有一个借出的引用，所以块一定还活着；别的线程已经补过（借出数回落到一半以下）
+        // 或者期间被store换掉时（写线程按当时的借出数结算），刚才多加的这批由自己还掉
+        // 内存序：CAS成功时用release。写线程的exchange（acq_rel）读到这次CAS写入的借出数后才按它结算，
+        // release/acquire 让前面的 fetch_add 先于写线程的 fetch_sub 进入计数的修改顺序；
+        // 都用relaxed时计数可能先被减到0，读线程手里的快照随之被释放
+        void refill(uintptr_t expected) const noexcept
+        {
+            block_type* block = block_of(expected);
+            constexpr uintptr_t half = kBatch / 2;
+            block->shared_count.fetch_add(half, std::memory_order_relaxed);
+            while(block_of(expected) == block and used_of(expected) >= half)
+            {
+                if(state.compare_exchange_weak(expected, expected - half, std::memory_order_release, std::memory_order_relaxed))
+                    return;
+            }
+            release_n(block, half);
+        }
+
+    public:
+        atomic_shared_ptr() noexcept = default;
+
+        explicit atomic_shared_ptr(shared_ptr<T> value) : state(make_state(std::move(value))) {}
+
+        atomic_shared_ptr(const atomic_shared_ptr&) = delete;
+        atomic_shared_ptr& operator=(const atomic_shared_ptr&) = delete;
+
+        ~atomic_shared_ptr() noexcept
+        {
+            retire(state.load(std::memory_order_acquire), 0);
+        }
+
+        // 取一个快照：快路径是一次CAS；借出数到达上限时等补充完成
+        shared_ptr<T> load() const noexcept
+        {
+            uintptr_t cur = state.load(std::memory_order_acquire);
+            while(true)
+            {
+                block_type* block = block_of(cur);
+                if(!block) return shared_ptr<T>();
+                if(used_of(cur) >= kMaxUsed)
+                {
+                    std::this_thread::yield();
+                    cur = state.load(std::memory_order_acquire);
+                    continue;
+                }
+                if(state.compare_exchange_weak(cur, cur + 1, std::memory_order_acquire, std::memory_order_acquire))
+                {
+                    if(used_of(cur) + 1 >= kBatch / 2) refill(cur + 1);
+                    return adopt(block);
+                }
+            }
+        }
+
+        // 发布新值；旧值在最后一个读线程放下快照后释放
+        void store(shared_ptr<T> value)
+        {
+            exchange(std::move(value));
+        }
+
+        shared_ptr<T> exchange(shared_ptr<T> value)
+        {
+            uintptr_t old = state.exchange(make_state(std::move(value)), std::memory_order_acq_rel);
+            block_type* block = block_of(old);
+            if(!block) return shared_ptr<T>();
+            retire(old, 1);
+            return adopt(block);
+        }
+
+        operator shared_ptr<T>() const noexcept
+        {
+            return load();
+        }
+
+        atomic_shared_ptr& operator=(shared_ptr<T> value)
+        {
+            store(std::move(value));
+            return *this;
+        }
+
+        bool is_lock_free() const noexcept
+        {
+            return state.is_lock_free();
+        }
+};
+
+#endif // ATOMIC_SHARED_PTR_HPP
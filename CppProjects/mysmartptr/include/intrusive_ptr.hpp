@@ -0,0 +1,173 @@
+#ifndef INTRUSIVE_PTR_HPP
+#define INTRUSIVE_PTR_HPP
+
+#include "smartpointer.hpp" // atomic_count_policy / single_thread_policy
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// 侵入式引用计数：计数放在对象自己身上，指针只有一个T*
+// 与shared_ptr相比没有控制块：句柄是8字节而不是16字节，拷贝时要改的计数和对象本身在同一缓存行，
+// 也可以随时从裸指针（如epoll_event.data.ptr）重新得到一个句柄，不需要enable_shared_from_this
+// 代价：T必须自带计数（继承intrusive_ref_counter，或自己提供下面两个函数），也没有weak_ptr
+//
+// intrusive_ptr<T> 通过实参依赖查找调用：
+//   void intrusive_ptr_add_ref(T*)  计数加一
+//   void intrusive_ptr_release(T*)  计数减一，归0时释放对象
+
+// CRTP基类：Derived 继承 intrusive_ref_counter<Derived> 即可被 intrusive_ptr<Derived> 管理
+// Policy 与 shared_ptr 相同：默认原子计数，single_thread_policy 用于只在一个线程里流转的对象
+template<typename Derived, typename Policy = atomic_count_policy>
+class intrusive_ref_counter
+{
+    private:
+        mutable typename Policy::count_type ref_count{0};
+
+    protected:
+        intrusive_ref_counter() noexcept = default;
+        // 拷贝对象不拷贝计数：新对象还没有任何句柄
+        intrusive_ref_counter(const intrusive_ref_counter&) noexcept {}
+        intrusive_ref_counter& operator=(const intrusive_ref_counter&) noexcept { return *this; }
+        // 不是虚析构：释放时先转换成Derived再delete
+        ~intrusive_ref_counter() = default;
+
+    public:
+        size_t use_count() const noexcept
+        {
+            return Policy::load(ref_count);
+        }
+
+        friend void intrusive_ptr_add_ref(const intrusive_ref_counter* p) noexcept
+        {
+            Policy::increment(p->ref_count);
+        }
+
+        friend void intrusive_ptr_release(const intrusive_ref_counter* p) noexcept
+        {
+            if(Policy::decrement(p->ref_count))
+                delete static_cast<const Derived*>(p);
+        }
+};
+
+template<typename T>
+class intrusive_ptr
+{
+    private:
+        T* ptr;
+
+        template<typename U>
+        friend class intrusive_ptr;
+
+    public:
+        intrusive_ptr() noexcept : ptr(nullptr) {}
+
+        // add_ref 为false时接管一个已经计入的引用（例如 detach() 交出去的裸指针）
+        intrusive_ptr(T* p, bool add_ref = true) : ptr(p)
+        {
+            if(ptr and add_ref)
+                intrusive_ptr_add_ref(ptr);
+        }
+
+        intrusive_ptr(const intrusive_ptr& other) : ptr(other.ptr)
+        {
+            if(ptr)
+                intrusive_ptr_add_ref(ptr);
+        }
+
+        intrusive_ptr(intrusive_ptr&& other) noexcept : ptr(other.ptr)
+        {
+            other.ptr = nullptr;
+        }
+
+        // 派生类到基类的转换
+        template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+        intrusive_ptr(const intrusive_ptr<U>& other) : ptr(other.ptr)
+        {
+            if(ptr)
+                intrusive_ptr_add_ref(ptr);
+        }
+
+        template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+        intrusive_ptr(intrusive_ptr<U>&& other) noexcept : ptr(other.ptr)
+        {
+            other.ptr = nullptr;
+        }
+
+        ~intrusive_ptr()
+        {
+            if(ptr)
+                intrusive_ptr_release(ptr);
+        }
+
+        // 拷贝-交换：先加other的计数再释放自己，自赋值和互相指向时都安全
+        intrusive_ptr& operator=(const intrusive_ptr& other)
+        {
+            intrusive_ptr(other).swap(*this);
+            return *this;
+        }
+
+        intrusive_ptr& operator=(intrusive_ptr&& other) noexcept
+        {
+            intrusive_ptr(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        void reset(T* p = nullptr)
+        {
+            intrusive_ptr(p).swap(*this);
+        }
+
+        // 交出引用但不减计数，之后由调用者负责（配合 intrusive_ptr(p, false) 重新接管）
+        T* detach() noexcept
+        {
+            T* p = ptr;
+            ptr = nullptr;
+            return p;
+        }
+
+        void swap(intrusive_ptr& other) noexcept
+        {
+            std::swap(ptr, other.ptr);
+        }
+
+        T* get() const noexcept
+        {
+            return ptr;
+        }
+
+        T& operator*() const noexcept
+        {
+            return *ptr;
+        }
+
+        T* operator->() const noexcept
+        {
+            return ptr;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return ptr != nullptr;
+        }
+};
+
+template<typename T, typename U>
+bool operator==(const intrusive_ptr<T>& a, const intrusive_ptr<U>& b) noexcept
+{
+    return a.get() == b.get();
+}
+
+template<typename T, typename U>
+bool operator!=(const intrusive_ptr<T>& a, const intrusive_ptr<U>& b) noexcept
+{
+    return a.get() != b.get();
+}
+
+template<typename T, typename... Args>
+intrusive_ptr<T> make_intrusive(Args&&... args)
+{
+    return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+#endif // INTRUSIVE_PTR_HPP
@@ -0,0 +1,270 @@
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include "smartpointer.hpp"
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// 小对象池：按16字节分级（16、32 … 256字节），每个线程一组空闲链表
+// 每条消息一个任务、每个连接一条记录这类小而短命的对象，分配/释放通常只是本线程链表的一次出栈/入栈，
+// 不加锁、不碰malloc的全局结构；超过256字节的请求直接交给 ::operator new
+//
+// 内存来源：每个线程从64KB的块里顺序切分，块本身从不归还（进程结束时由depot统一释放）
+// 跨线程释放：对象归还到释放者所在线程的链表；某级链表超过 kMaxCached 个时把一半交给全局depot，
+// 分配方链表空了先从depot取回一批（同样最多 kMaxCached/2 个，链表操作的耗时有上界），这样生产者/消费者模式下内存会回流，而不会在消费者线程越积越多
+// 线程退出时它的链表也交给depot，供之后的线程复用
+class size_class_pool
+{
+    public:
+        static constexpr size_t kAlignment = 16;
+        static constexpr size_t kMaxSize = 256;
+        static constexpr size_t kClasses = kMaxSize / kAlignment;
+        static constexpr size_t kChunkSize = 64 * 1024;
+        static constexpr size_t kMaxCached = 1024;
+
+        static void* allocate(size_t size)
+        {
+            if(size > kMaxSize) return ::operator new(size);
+            size_t index = index_of(size);
+            if(cache_destroyed) return global().pop(index);
+            return local().pop(index);
+        }
+
+        // size 必须与分配时相同
+        static void deallocate(void* p, size_t size) noexcept
+        {
+            if(size > kMaxSize)
+            {
+                ::operator delete(p);
+                return;
+            }
+            free_node* node = static_cast<free_node*>(p);
+            size_t index = index_of(size);
+            if(cache_destroyed)
+            {
+                node->next = nullptr;
+                global().push(index, node, node);
+                return;
+            }
+            local().push(index, node);
+        }
+
+    private:
+        struct free_node
+        {
+            free_node* next;
+        };
+
+        static size_t index_of(size_t size) noexcept
+        {
+            return size ? (size - 1) / kAlignment : 0;
+        }
+
+        // 全局仓库：线程间转移整条空闲链表，并记录所有块以便进程结束时释放
+        struct depot
+        {
+            std::mutex mtx;
+            free_node* lists[kClasses] = {};
+            std::vector<void*> chunks;
+
+            ~depot()
+            {
+                for(void* chunk : chunks) ::operator delete(chunk);
+            }
+
+            // 把 [head, tail] 这一整条挂到depot上
+            void push(size_t index, free_node* head, free_node* tail)
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                tail->next = lists[index];
+                lists[index] = head;
+            }
+
+            // 从头上取走最多max个，count返回实际个数；没有时返回nullptr
+            free_node* take(size_t index, size_t max, size_t& count)
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                free_node* head = lists[index];
+                if(!head)
+                {
+                    count = 0;
+                    return nullptr;
+                }
+                free_node* tail = head;
+                count = 1;
+                while(count < max and tail->next)
+                {
+                    tail = tail->next;
+                    count++;
+                }
+                lists[index] = tail->next;
+                tail->next = nullptr;
+                return head;
+            }
+
+            void* new_chunk()
+            {
+                void* chunk = ::operator new(kChunkSize);
+                std::lock_guard<std::mutex> lock(mtx);
+                chunks.push_back(chunk);
+                return chunk;
+            }
+
+            // 线程缓存已析构（线程退出过程中还有对象在分配/释放）时的慢路径
+            void* pop(size_t index)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    if(free_node* node = lists[index])
+                    {
+                        lists[index] = node->next;
+                        return node;
+                    }
+                }
+                // 单独分配一个最大级的对象（任何一级都放得下），同样记在chunks里
+                void* p = ::operator new(kMaxSize);
+                std::lock_guard<std::mutex> lock(mtx);
+                chunks.push_back(p);
+                return p;
+            }
+        };
+
+        struct thread_cache
+        {
+            free_node* lists[kClasses] = {};
+            size_t counts[kClasses] = {};
+            char* cursor = nullptr;
+            char* end = nullptr;
+
+            ~thread_cache()
+            {
+                for(size_t i = 0; i < kClasses; i++) flush(i, counts[i]);
+                cache_destroyed = true;
+            }
+
+            void* pop(size_t index)
+            {
+                if(free_node* node = lists[index])
+                {
+                    lists[index] = node->next;
+                    counts[index]--;
+                    return node;
+                }
+                return refill(index);
+            }
+
+            void push(size_t index, free_node* node)
+            {
+                node->next = lists[index];
+                lists[index] = node;
+                if(++counts[index] > kMaxCached) flush(index, kMaxCached / 2);
+            }
+
+            // 链表头上的n个交给depot
+            void flush(size_t index, size_t n)
+            {
+                if(n == 0) return;
+                free_node* head = lists[index];
+                free_node* tail = head;
+                for(size_t i = 1; i < n; i++) tail = tail->next;
+                lists[index] = tail->next;
+                counts[index] -= n;
+                global().push(index, head, tail);
+            }
+
+            void* refill(size_t index)
+            {
+                size_t count = 0;
+                if(free_node* head = global().take(index, kMaxCached / 2, count))
+                {
+                    lists[index] = head->next;
+                    counts[index] = count - 1;
+                    return head;
+                }
+                size_t size = (index + 1) * kAlignment;
+                if(cursor == nullptr or static_cast<size_t>(end - cursor) < size)
+                {
+                    // 旧块剩下的尾巴不到一个对象，直接丢弃（每次最多浪费 kMaxSize 字节）
+                    cursor = static_cast<char*>(global().new_chunk());
+                    end = cursor + kChunkSize;
+                }
+                void* p = cursor;
+                cursor += size;
+                return p;
+            }
+        };
+
+        // 第一次使用时构造，保证它比任何线程缓存都晚析构
+        static depot& global()
+        {
+            static depot instance;
+            return instance;
+        }
+
+        static thread_cache& local()
+        {
+            global();
+            thread_local thread_cache cache;
+            return cache;
+        }
+
+        // 平凡析构的线程局部标志：线程缓存析构后仍然可读
+        static inline thread_local bool cache_destroyed = false;
+};
+
+// 从 size_class_pool 分配的分配器：无状态，可用于 allocate_shared / allocate_unique / 标准容器
+template<typename T>
+struct pool_allocator
+{
+    using value_type = T;
+
+    static_assert(alignof(T) <= size_class_pool::kAlignment, "pool_allocator supports up to 16-byte alignment");
+
+    pool_allocator() noexcept = default;
+    template<typename U>
+    pool_allocator(const pool_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(size_class_pool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        size_class_pool::deallocate(p, n * sizeof(T));
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const pool_allocator<T>&, const pool_allocator<U>&) noexcept { return true; }
+template<typename T, typename U>
+bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&) noexcept { return false; }
+
+// 对象池里的unique_ptr：删除器是空类型，句柄大小与 unique_ptr<T> 相同
+// 归还时按T的大小找回分级，所以不能转换成基类指针后再释放
+template<typename T>
+using pool_delete = alloc_delete<T, pool_allocator<T>>;
+
+template<typename T>
+using pool_unique_ptr = unique_ptr<T, pool_delete<T>>;
+
+template<typename T, typename... Args>
+pool_unique_ptr<T> make_pool_unique(Args&&... args)
+{
+    return allocate_unique<T>(pool_allocator<T>(), std::forward<Args>(args)...);
+}
+
+// 控制块连同对象一起从池里分配
+template<typename T, typename... Args>
+shared_ptr<T> make_pool_shared(Args&&... args)
+{
+    return ::allocate_shared<T>(pool_allocator<T>(), std::forward<Args>(args)...);
+}
+
+static_assert(sizeof(pool_unique_ptr<long>) == sizeof(long*), "pool deleter must not take space");
+
+#endif // OBJECT_POOL_HPP
@@ -4,18 +4,70 @@
 #include <iostream>
 #include <utility> // std::move
 #include <cstddef> // size_t
+#include <atomic>
+#include <memory> // std::allocator_traits
+#include <new> // std::launder
+#include <type_traits>
 
+// 默认删除器
 template<typename T>
-class unique_ptr
+struct default_delete
+{
+    void operator()(T* p) const noexcept
+    {
+        delete p;
+    }
+};
+
+// 空基类优化：无状态的删除器/分配器（绝大多数情况）不占unique_ptr或控制块的空间（C++17还没有[[no_unique_address]]）
+// Index 区分同一类型出现两次的情况
+template<typename T, int Index, bool Empty = std::is_empty<T>::value and !std::is_final<T>::value>
+class ebo_storage : private T
+{
+    public:
+        explicit ebo_storage(const T& value) : T(value) {}
+        explicit ebo_storage(T&& value) : T(std::move(value)) {}
+        T& get() noexcept { return *this; }
+        const T& get() const noexcept { return *this; }
+};
+
+template<typename T, int Index>
+class ebo_storage<T, Index, false>
+{
+    private:
+        T value;
+    public:
+        explicit ebo_storage(const T& v) : value(v) {}
+        explicit ebo_storage(T&& v) : value(std::move(v)) {}
+        T& get() noexcept { return value; }
+        const T& get() const noexcept { return value; }
+};
+
+// Deleter 默认是 default_delete<T>（delete p）；来自对象池/分配器的对象用 alloc_delete 归还
+// 删除器放在空基类里：无状态的删除器不占空间，sizeof(unique_ptr) 仍然是一个指针
+template<typename T, typename Deleter = default_delete<T>>
+class unique_ptr : private ebo_storage<Deleter, 0>
 {
     private:
         T* ptr;
+
+        using deleter_storage = ebo_storage<Deleter, 0>;
+
+        // 删除器不一定能处理空指针，统一在这里判断
+        void destroy() noexcept
+        {
+            if(ptr)
+                get_deleter()(ptr);
+        }
     public:
         // 空构造
-        explicit unique_ptr(T* p = nullptr) : ptr(p) {}
+        explicit unique_ptr(T* p = nullptr) : deleter_storage(Deleter()), ptr(p) {}
+
+        // 指定删除器（有状态的删除器，例如记住对象来自哪个池）
+        unique_ptr(T* p, Deleter d) : deleter_storage(std::move(d)), ptr(p) {}
 
         // 移动构造函数
-        unique_ptr(unique_ptr&& other) noexcept
+        unique_ptr(unique_ptr&& other) noexcept : deleter_storage(std::move(other.get_deleter()))
         {
             this->ptr = other.ptr;
             other.ptr = nullptr; // 转移所有权
@@ -27,11 +79,11 @@ class unique_ptr
             if(this != &other)
             {
                 // 释放当前指针指向的内存
-                // if(ptr) 没必要加，因为delete nullptr也是合法行为
-                delete ptr;
-                // 转移所有权
+                destroy();
+                // 转移所有权（删除器跟着对象走）
                 ptr = other.ptr;
                 other.ptr = nullptr;
+                get_deleter() = std::move(other.get_deleter());
             }
             return *this;
         }
@@ -41,7 +93,7 @@ class unique_ptr
         ~unique_ptr() noexcept
         {
             // 释放当前指针指向的内存
-            delete ptr;
+            destroy();
             // 当前指针置为空
             ptr = nullptr;
         }
@@ -74,14 +126,32 @@ class unique_ptr
             return ptr;
         }
 
+        Deleter& get_deleter() noexcept
+        {
+            return deleter_storage::get();
+        }
+
+        const Deleter& get_deleter() const noexcept
+        {
+            return deleter_storage::get();
+        }
+
         // 手动释放资源
 
         void reset(T* otherptr = nullptr) noexcept
         {
-            delete ptr; 
+            destroy();
             ptr = otherptr;
         }
 
+        // 交出所有权但不释放，之后由调用者用同样的删除器负责
+        T* release() noexcept
+        {
+            T* p = ptr;
+            ptr = nullptr;
+            return p;
+        }
+
         // 布尔转换 ：判断是否持有资源
         // 布尔转换运算符是 C++ 中的一种用户定义类型转换 (user-defined conversion)
         // 它允许你自定义一个类的对象在需要被当作布尔值使用时（比如在 if、while 条件判断中），应该如何转换为 bool 类型。
@@ -97,54 +167,335 @@ unique_ptr<T> make_unique(Args&&... args)
     return unique_ptr<T>(new T(std::forward<Args>(args)...));
 }
 
-template<typename T> 
+// 把对象交还给分配它的分配器：先析构，再按T的大小归还内存
+// 分配器无状态时（std::allocator、pool_allocator）这个删除器是空类型
+template<typename T, typename Alloc>
+class alloc_delete : private ebo_storage<typename std::allocator_traits<Alloc>::template rebind_alloc<T>, 0>
+{
+    private:
+        using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+        using alloc_traits = std::allocator_traits<alloc_type>;
+        using alloc_storage = ebo_storage<alloc_type, 0>;
+    public:
+        alloc_delete() : alloc_storage(alloc_type()) {}
+        explicit alloc_delete(const Alloc& alloc) : alloc_storage(alloc_type(alloc)) {}
+
+        void operator()(T* p) noexcept
+        {
+            alloc_traits::destroy(alloc_storage::get(), p);
+            alloc_traits::deallocate(alloc_storage::get(), p, 1);
+        }
+};
+
+// 用alloc分配并构造一个T，与allocate_shared对应
+template<typename T, typename Alloc, typename... Args>
+unique_ptr<T, alloc_delete<T, Alloc>> allocate_unique(const Alloc& alloc, Args&&... args)
+{
+    using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+    using alloc_traits = std::allocator_traits<alloc_type>;
+    alloc_type a(alloc);
+    T* p = alloc_traits::allocate(a, 1);
+    try
+    {
+        alloc_traits::construct(a, p, std::forward<Args>(args)...);
+    }
+    catch(...)
+    {
+        alloc_traits::deallocate(a, p, 1);
+        throw;
+    }
+    return unique_ptr<T, alloc_delete<T, Alloc>>(p, alloc_delete<T, Alloc>(alloc));
+}
+
+// 引用计数策略：shared_ptr 的第二个模板参数
+// atomic_count_policy（默认）：计数可在线程间共享，reactor线程和工作线程可以各自持有、拷贝、释放同一个对象
+//   增加用relaxed：能拷贝说明自己已持有一个引用，对象不可能在此期间被释放，不需要同步其他内存
+//   减少用acq_rel：release保证本线程对对象的写入先于计数减少，最后一个释放者的acquire保证析构时能看到所有这些写入
+// single_thread_policy：普通整数，对象只在一个线程内流转时省去原子指令（及其带来的缓存行争用）
+struct atomic_count_policy
+{
+    using count_type = std::atomic<size_t>;
+
+    static void increment(count_type& count) noexcept
+    {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 返回true表示计数减到0，调用者负责释放
+    static bool decrement(count_type& count) noexcept
+    {
+        return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    // weak_ptr::lock：计数不为0时才加一。不能先读再加——读到非0之后、加一之前，最后一个持有者可能已经把对象析构了，
+    // 所以用CAS循环把“检查非0”和“加一”合成一步；成功时acq_rel与decrement配对，失败时不访问对象
+    static bool increment_if_nonzero(count_type& count) noexcept
+    {
+        size_t n = count.load(std::memory_order_relaxed);
+        while(n != 0)
+        {
+            if(count.compare_exchange_weak(n, n + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    static size_t load(const count_type& count) noexcept
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+};
+
+struct single_thread_policy
+{
+    using count_type = size_t;
+
+    static void increment(count_type& count) noexcept
+    {
+        count++;
+    }
+
+    static bool decrement(count_type& count) noexcept
+    {
+        return --count == 0;
+    }
+
+    static bool increment_if_nonzero(count_type& count) noexcept
+    {
+        if(count == 0) return false;
+        count++;
+        return true;
+    }
+
+    static size_t load(const count_type& count) noexcept
+    {
+        return count;
+    }
+};
+
+// 控制块：强/弱引用计数 + 如何销毁对象、如何释放自己
+// 删除器和分配器的类型只出现在派生类里，shared_ptr<T> 的类型不受影响（类型擦除）；
+// 对象与控制块一起分配时（make_shared）不需要删除器，也就不存储
+// 所有shared_ptr合起来只持有一个弱引用：强计数归0时析构对象并减掉这个弱引用，弱计数归0时才释放控制块。
+// 这样shared_ptr的拷贝/析构只碰强计数；代价是make_shared的对象内存要等最后一个weak_ptr释放后才归还
+template<typename Policy>
+class control_block
+{
+    public:
+        typename Policy::count_type shared_count{1};
+        typename Policy::count_type weak_count{1};
+
+        // 强计数归0时调用：析构对象
+        virtual void dispose() noexcept = 0;
+        // 弱计数归0时调用：释放控制块本身（及一起分配的对象）的内存
+        virtual void destroy() noexcept = 0;
+
+        void release_shared() noexcept
+        {
+            if(Policy::decrement(shared_count))
+            {
+                dispose();
+                release_weak();
+            }
+        }
+
+        void release_weak() noexcept
+        {
+            if(Policy::decrement(weak_count))
+                destroy();
+        }
+
+    protected:
+        // 只能通过destroy()释放
+        ~control_block() = default;
+};
+
+// 用分配器alloc（重新绑定到Block类型）释放block
+template<typename Block, typename Alloc>
+void deallocate_block(Block* block, const Alloc& alloc) noexcept
+{
+    using block_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Block>;
+    block_alloc a(alloc);
+    block->~Block();
+    std::allocator_traits<block_alloc>::deallocate(a, block, 1);
+}
+
+// 接管外部new出的指针：控制块单独分配，保存指针、删除器和分配器
+template<typename T, typename Deleter, typename Alloc, typename Policy>
+class control_block_pointer final : public control_block<Policy>,
+                                    private ebo_storage<Deleter, 0>,
+                                    private ebo_storage<Alloc, 1>
+{
+    private:
+        T* ptr;
+    public:
+        control_block_pointer(T* p, Deleter&& d, const Alloc& alloc)
+            : ebo_storage<Deleter, 0>(std::move(d)), ebo_storage<Alloc, 1>(alloc), ptr(p) {}
+
+        void dispose() noexcept override
+        {
+            ebo_storage<Deleter, 0>::get()(ptr);
+        }
+
+        void destroy() noexcept override
+        {
+            Alloc alloc(ebo_storage<Alloc, 1>::get());
+            deallocate_block(this, alloc);
+        }
+};
+
+// make_shared/allocate_shared：对象直接放在控制块内，一次分配，计数和对象通常落在同一缓存行
+template<typename T, typename Alloc, typename Policy>
+class control_block_inplace final : public control_block<Policy>, private ebo_storage<Alloc, 1>
+{
+    private:
+        alignas(T) unsigned char storage[sizeof(T)];
+    public:
+        template<typename... Args>
+        explicit control_block_inplace(const Alloc& alloc, Args&&... args) : ebo_storage<Alloc, 1>(alloc)
+        {
+            ::new (static_cast<void*>(storage)) T(std::forward<Args>(args)...);
+        }
+
+        T* object() noexcept
+        {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+
+        void dispose() noexcept override
+        {
+            object()->~T();
+        }
+
+        void destroy() noexcept override
+        {
+            Alloc alloc(ebo_storage<Alloc, 1>::get());
+            deallocate_block(this, alloc);
+        }
+};
+
+template<typename T, typename Policy>
+class shared_ptr;
+
+template<typename T, typename Policy>
+class weak_ptr;
+
+template<typename T, typename Policy>
+class enable_shared_from_this;
+
+template<typename T>
+class atomic_shared_ptr;
+
+template<typename T, typename Policy = atomic_count_policy, typename Alloc, typename... Args>
+shared_ptr<T, Policy> allocate_shared(const Alloc& alloc, Args&&... args);
+
+template<typename T, typename Policy = atomic_count_policy>
 class shared_ptr
 {
     private:
         T* ptr;
-        size_t* shared_count;
+        control_block<Policy>* control;
+
+        // 接管一个已经计入的强引用：allocate_shared（新建的控制块，计数为1）和weak_ptr::lock（CAS成功加过一）使用
+        shared_ptr(T* p, control_block<Policy>* block) noexcept : ptr(p), control(block) {}
+
+        template<typename U, typename P, typename A, typename... Args>
+        friend shared_ptr<U, P> allocate_shared(const A& alloc, Args&&... args);
+
+        template<typename U, typename P>
+        friend class shared_ptr;
+
+        template<typename U, typename P>
+        friend class weak_ptr;
+
+        // 直接读写控制块，以便在打包的原子字上借出/归还引用
+        template<typename U>
+        friend class atomic_shared_ptr;
+
+        // 新建控制块时，若T继承自enable_shared_from_this，让它记住自己的弱引用
+        template<typename U>
+        void enable_weak_this(const enable_shared_from_this<U, Policy>* base) noexcept
+        {
+            if(base and base->weak_this.expired())
+                base->weak_this.assign(const_cast<U*>(static_cast<const U*>(base)), control);
+        }
+
+        void enable_weak_this(...) noexcept {}
 
         void release() noexcept
         {
             // 一定要先判断指针是否为空，对空指针解引用会直接崩溃
-            if(shared_count)
-            {
-                (*shared_count)--;
-
-                if(*shared_count == 0)
-                {
-                    // new 出的资源需要删除
-                    delete ptr;
-                    delete shared_count;
-                    this->ptr = nullptr;
-                    this->shared_count = nullptr;
-                } 
-            }
+            if(control)
+                control->release_shared();
+            // 无论是否是最后一个持有者，自己都不再持有资源，避免之后析构时重复减计数
+            this->ptr = nullptr;
+            this->control = nullptr;
         };
     public:
-        explicit shared_ptr(T* p = nullptr) noexcept : ptr(p), shared_count(nullptr)
+        explicit shared_ptr(T* p = nullptr) : ptr(nullptr), control(nullptr)
         {
-            if(ptr)
+            if(p)
             {
-                shared_count = new size_t(1);
+                *this = shared_ptr(p, default_delete<T>());
             }
         }
 
+        // 自定义删除器：对象不是new出来的（如来自对象池、需要close的句柄）时使用
+        template<typename Deleter>
+        shared_ptr(T* p, Deleter d) : shared_ptr(p, std::move(d), std::allocator<T>()) {}
+
+        // 自定义删除器 + 控制块使用的分配器
+        template<typename Deleter, typename Alloc>
+        shared_ptr(T* p, Deleter d, const Alloc& alloc) : ptr(p), control(nullptr)
+        {
+            using block_type = control_block_pointer<T, Deleter, Alloc, Policy>;
+            using block_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<block_type>;
+            block_alloc a(alloc);
+            block_type* block = nullptr;
+            try
+            {
+                block = std::allocator_traits<block_alloc>::allocate(a, 1);
+            }
+            catch(...)
+            {
+                // 控制块分配失败时对象不会再有人释放，这里负责删掉
+                d(p);
+                throw;
+            }
+            control = ::new (static_cast<void*>(block)) block_type(p, std::move(d), alloc);
+            enable_weak_this(p);
+        }
+
+        // 派生类到基类的转换（如 shared_ptr<User> 转为 shared_ptr<Observer>）
+        template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+        shared_ptr(const shared_ptr<U, Policy>& other) noexcept : ptr(other.ptr), control(other.control)
+        {
+            if(control)
+                Policy::increment(control->shared_count);
+        }
+
+        template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+        shared_ptr(shared_ptr<U, Policy>&& other) noexcept : ptr(other.ptr), control(other.control)
+        {
+            other.ptr = nullptr;
+            other.control = nullptr;
+        }
+
         // 拷贝构造，shared_count++
-        shared_ptr(const shared_ptr<T>& other)
+        shared_ptr(const shared_ptr& other) noexcept
         {
             this->ptr = other.ptr;
-            this->shared_count = other.shared_count;
-            if(shared_count) // 持有有效资源时再++
-                (*shared_count)++;
+            this->control = other.control;
+            if(control) // 持有有效资源时再++
+                Policy::increment(control->shared_count);
         }
         // 移动构造，接管将亡值资源，原对象置空
-        shared_ptr(shared_ptr<T>&& other) noexcept
+        shared_ptr(shared_ptr&& other) noexcept
         {
             this->ptr = other.ptr;
-            this->shared_count = other.shared_count;
+            this->control = other.control;
             other.ptr = nullptr;
-            other.shared_count = nullptr;
+            other.control = nullptr;
         }
         // 析构函数
         ~shared_ptr() noexcept
@@ -152,23 +503,24 @@ class shared_ptr
             this->release();
         }
         // 拷贝赋值运算符，先释放自己的资源，再拷贝other的资源
-        shared_ptr<T>& operator=(const shared_ptr<T>& other)
+        shared_ptr& operator=(const shared_ptr& other) noexcept
         {
             // this 为当前类存储的地址 如果等于 other类存储的地址，说明此时产生自赋值
             if(this == &other) return *this; // 要避免自赋值，此时不进行任何操作
-        
+
+            // 先增加other的计数再释放自己：两者指向同一对象时，先释放可能把对象提前删掉
+            if(other.control)
+                Policy::increment(other.control->shared_count);
+
             this->release();
 
             this->ptr = other.ptr;
-            this->shared_count = other.shared_count;
-
-            if(shared_count) 
-                (*shared_count)++;
+            this->control = other.control;
 
             return *this;
         } 
         // 移动赋值运算符
-        shared_ptr<T>& operator=(shared_ptr<T>&& other) noexcept
+        shared_ptr& operator=(shared_ptr&& other) noexcept
         {
             // this 为当前类存储的地址 如果等于 other类存储的地址，说明此时产生自赋值
             if(this == &other) return *this; // 要避免自赋值，此时不进行任何操作
@@ -176,10 +528,10 @@ class shared_ptr
             this->release();
 
             this->ptr = other.ptr;
-            this->shared_count = other.shared_count;
+            this->control = other.control;
 
             other.ptr = nullptr;
-            other.shared_count = nullptr;
+            other.control = nullptr;
 
             return *this;
         } 
@@ -213,15 +565,213 @@ class shared_ptr
 
         size_t get_count() const noexcept
         {
-            return shared_count ? *shared_count : 0;
+            // 多线程下只是某一时刻的快照
+            return control ? Policy::load(control->shared_count) : 0;
         }
 
 };
 
+template<typename T, typename U, typename Policy>
+bool operator==(const shared_ptr<T, Policy>& a, const shared_ptr<U, Policy>& b) noexcept
+{
+    return a.get() == b.get();
+}
+
+template<typename T, typename U, typename Policy>
+bool operator!=(const shared_ptr<T, Policy>& a, const shared_ptr<U, Policy>& b) noexcept
+{
+    return a.get() != b.get();
+}
+
+// 弱引用：不延长对象寿命，只能通过lock()拿到shared_ptr再访问对象。
+// 用于打破循环引用（观察者持有主题）和“对象还在就处理”的场景（异步回调检查连接是否已关闭）
+template<typename T, typename Policy = atomic_count_policy>
+class weak_ptr
+{
+    private:
+        T* ptr;
+        control_block<Policy>* control;
+
+        template<typename U, typename P>
+        friend class shared_ptr;
+
+        template<typename U, typename P>
+        friend class weak_ptr;
+
+        // 由enable_weak_this调用
+        void assign(T* p, control_block<Policy>* block) noexcept
+        {
+            Policy::increment(block->weak_count);
+            this->release();
+            this->ptr = p;
+            this->control = block;
+        }
+
+        void release() noexcept
+        {
+            if(control)
+                control->release_weak();
+            this->ptr = nullptr;
+            this->control = nullptr;
+        }
+    public:
+        weak_ptr() noexcept : ptr(nullptr), control(nullptr) {}
+
+        template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+        weak_ptr(const shared_ptr<U, Policy>& other) noexcept : ptr(other.ptr), control(other.control)
+        {
+            if(control)
+                Policy::increment(control->weak_count);
+        }
+
+        weak_ptr(const weak_ptr& other) noexcept : ptr(other.ptr), control(other.control)
+        {
+            if(control)
+                Policy::increment(control->weak_count);
+        }
+
+        weak_ptr(weak_ptr&& other) noexcept : ptr(other.ptr), control(other.control)
+        {
+            other.ptr = nullptr;
+            other.control = nullptr;
+        }
+
+        ~weak_ptr() noexcept
+        {
+            this->release();
+        }
+
+        weak_ptr& operator=(const weak_ptr& other) noexcept
+        {
+            if(this == &other) return *this;
+            if(other.control)
+                Policy::increment(other.control->weak_count);
+            this->release();
+            this->ptr = other.ptr;
+            this->control = other.control;
+            return *this;
+        }
+
+        weak_ptr& operator=(weak_ptr&& other) noexcept
+        {
+            if(this == &other) return *this;
+            this->release();
+            this->ptr = other.ptr;
+            this->control = other.control;
+            other.ptr = nullptr;
+            other.control = nullptr;
+            return *this;
+        }
+
+        template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+        weak_ptr& operator=(const shared_ptr<U, Policy>& other) noexcept
+        {
+            *this = weak_ptr(other);
+            return *this;
+        }
+
+        // 对象还活着时返回持有它的shared_ptr，否则返回空；无锁，多个线程可以同时lock同一个对象
+        shared_ptr<T, Policy> lock() const noexcept
+        {
+            if(control and Policy::increment_if_nonzero(control->shared_count))
+                return shared_ptr<T, Policy>(ptr, control);
+            return shared_ptr<T, Policy>();
+        }
+
+        bool expired() const noexcept
+        {
+            return get_count() == 0;
+        }
+
+        void reset() noexcept
+        {
+            this->release();
+        }
+
+        size_t get_count() const noexcept
+        {
+            return control ? Policy::load(control->shared_count) : 0;
+        }
+};
+
+// 继承它的类可以在成员函数里拿到管理自己的shared_ptr：
+// 例如连接对象把 shared_from_this() 交给线程池任务，任务执行完之前连接不会被析构，不需要 delete this
+// 只有对象已经由shared_ptr管理（make_shared 或 shared_ptr(new T)）时才能调用
+template<typename T, typename Policy = atomic_count_policy>
+class enable_shared_from_this
+{
+    private:
+        mutable weak_ptr<T, Policy> weak_this;
+
+        template<typename U, typename P>
+        friend class shared_ptr;
+
+    protected:
+        enable_shared_from_this() noexcept = default;
+        // 拷贝对象不拷贝“谁在管理我”
+        enable_shared_from_this(const enable_shared_from_this&) noexcept {}
+        enable_shared_from_this& operator=(const enable_shared_from_this&) noexcept { return *this; }
+        ~enable_shared_from_this() = default;
+
+    public:
+        // 对象不由shared_ptr管理（或已在析构中）时抛出 std::bad_weak_ptr
+        shared_ptr<T, Policy> shared_from_this()
+        {
+            shared_ptr<T, Policy> self = weak_this.lock();
+            if(!self) throw std::bad_weak_ptr();
+            return self;
+        }
+
+        shared_ptr<const T, Policy> shared_from_this() const
+        {
+            shared_ptr<T, Policy> self = weak_this.lock();
+            if(!self) throw std::bad_weak_ptr();
+            return self;
+        }
+
+        weak_ptr<T, Policy> weak_from_this() const noexcept
+        {
+            return weak_this;
+        }
+};
+
+// 对象和控制块一次分配：alloc（按需重新绑定）负责这块内存的分配与释放
+template<typename T, typename Policy, typename Alloc, typename... Args>
+shared_ptr<T, Policy> allocate_shared(const Alloc& alloc, Args&&... args)
+{
+    using block_type = control_block_inplace<T, Alloc, Policy>;
+    using block_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<block_type>;
+    block_alloc a(alloc);
+    block_type* block = std::allocator_traits<block_alloc>::allocate(a, 1);
+    try
+    {
+        ::new (static_cast<void*>(block)) block_type(alloc, std::forward<Args>(args)...);
+    }
+    catch(...)
+    {
+        // T的构造函数抛出异常：只需归还内存
+        std::allocator_traits<block_alloc>::deallocate(a, block, 1);
+        throw;
+    }
+    shared_ptr<T, Policy> result(block->object(), static_cast<control_block<Policy>*>(block));
+    result.enable_weak_this(result.ptr);
+    return result;
+}
+
 template<typename T,typename... Args>
 shared_ptr<T> make_shared(Args&&... args)
 {
-    return shared_ptr<T>(new T(std::forward<Args>(args)...));
+    return ::allocate_shared<T>(std::allocator<T>(), std::forward<Args>(args)...);
+}
+
+// 只在单线程内使用的shared_ptr：非原子计数
+template<typename T>
+using local_shared_ptr = shared_ptr<T, single_thread_policy>;
+
+template<typename T,typename... Args>
+local_shared_ptr<T> make_local_shared(Args&&... args)
+{
+    return ::allocate_shared<T, single_thread_policy>(std::allocator<T>(), std::forward<Args>(args)...);
 }
 
 
@@ -1,5 +1,13 @@
 #include "smartpointer.hpp"
+#include "intrusive_ptr.hpp"
+#include "atomic_shared_ptr.hpp"
+#include "object_pool.hpp"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 class MyObj
 {
@@ -25,6 +33,72 @@ class MyObj
     }
 };
 
+// 异步任务通过 shared_from_this() 让自己在任务结束前保持存活
+class Session : public enable_shared_from_this<Session>
+{
+    private:
+        int id;
+    public:
+        explicit Session(int _id) : id(_id) {}
+        ~Session() { std::cout << "Session " << id << " destroyed" << std::endl; }
+
+        std::thread start_async()
+        {
+            shared_ptr<Session> self = shared_from_this();
+            return std::thread([self]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                std::cout << "Session " << self->id << " async task done" << std::endl;
+            });
+        }
+};
+
+// 计数放在对象自身的缓冲区
+class Buffer : public intrusive_ref_counter<Buffer>
+{
+    public:
+        ~Buffer() { std::cout << "Buffer released" << std::endl; }
+};
+
+// 统计存活个数，压力测试结束后应回到0
+struct Counted
+{
+    static std::atomic<long> live;
+    long val;
+    explicit Counted(long _val) : val(_val) { live++; }
+    ~Counted() { live--; }
+};
+
+std::atomic<long> Counted::live{0};
+
+// 统计分配次数的分配器
+static int alloc_count = 0;
+
+template<typename T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() = default;
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        alloc_count++;
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t) noexcept
+    {
+        ::operator delete(p);
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const counting_allocator<T>&, const counting_allocator<U>&) { return true; }
+template<typename T, typename U>
+bool operator!=(const counting_allocator<T>&, const counting_allocator<U>&) { return false; }
+
 int main() 
 {
     unique_ptr<MyObj> p = make_unique<MyObj>(20);
@@ -62,6 +136,137 @@ int main()
     shared_ptr<int> p6;
     std::cout << "p6 计数：" << p6.get_count() << std::endl; // 计数0
 
-    // 场景7：资源释放（p2/p3/p5析构时，计数归0，MyObj析构）
+    // 场景7：多线程拷贝/销毁（原子计数），结束后计数回到原值
+    {
+        std::vector<std::thread> threads;
+        for(int i = 0; i < 4; i++)
+        {
+            threads.emplace_back([&p5]()
+            {
+                for(int n = 0; n < 100000; n++)
+                {
+                    shared_ptr<MyObj> copy = p5;
+                }
+            });
+        }
+        for(auto& t : threads) t.join();
+        std::cout << "多线程拷贝后 p5 计数：" << p5.get_count() << std::endl; // 计数3
+    }
+
+    // 场景8：reset只释放自己的引用
+    p3.reset();
+    std::cout << "p3 reset后 p5 计数：" << p5.get_count() << std::endl; // 计数2
+
+    // 场景9：单线程计数策略
+    local_shared_ptr<int> l1 = make_local_shared<int>(7);
+    local_shared_ptr<int> l2 = l1;
+    std::cout << "l1 计数：" << l1.get_count() << "，值：" << *l2 << std::endl; // 计数2，值7
+
+    // 场景10：自定义删除器（对象不是new出来的）
+    {
+        static MyObj pooled(30);
+        shared_ptr<MyObj> d1(&pooled, [](MyObj* obj) { std::cout << "自定义删除器，不释放对象：" ; obj->show(); });
+        shared_ptr<MyObj> d2 = d1;
+        std::cout << "d1 计数：" << d1.get_count() << std::endl; // 计数2
+    }
+
+    // 场景11：allocate_shared：对象与控制块一次分配，使用自定义分配器
+    {
+        counting_allocator<MyObj> alloc;
+        shared_ptr<MyObj> a1 = allocate_shared<MyObj>(alloc, 40);
+        std::cout << "allocate_shared 分配次数：" << alloc_count << "，值：";
+        a1->show(); // 分配次数1，值40
+    }
+
+    // 场景12：weak_ptr 不增加计数，对象释放后 lock() 返回空
+    {
+        weak_ptr<MyObj> w;
+        {
+            shared_ptr<MyObj> s1 = make_shared<MyObj>(50);
+            w = s1;
+            std::cout << "s1 计数：" << s1.get_count() << "，expired：" << w.expired() << std::endl; // 计数1，expired 0
+            if(shared_ptr<MyObj> locked = w.lock()) locked->show(); // 50
+        }
+        std::cout << "s1 释放后 expired：" << w.expired() << "，lock为空：" << !w.lock() << std::endl; // 1，1
+    }
+
+    // 场景13：enable_shared_from_this：异步任务持有连接，连接在任务结束后才析构
+    {
+        std::thread worker;
+        {
+            shared_ptr<Session> session = make_shared<Session>(7);
+            worker = session->start_async();
+            std::cout << "Session 计数：" << session.get_count() << std::endl; // 计数2（任务里还有一个）
+        } // 这里只释放了外部的引用
+        worker.join();
+    }
+
+    // 场景14：intrusive_ptr：句柄只有一个指针，可以从裸指针重新得到句柄
+    {
+        intrusive_ptr<Buffer> b1 = make_intrusive<Buffer>();
+        Buffer* raw = b1.get();
+        intrusive_ptr<Buffer> b2(raw); // 计数在对象上，直接接着加
+        std::cout << "intrusive_ptr 大小：" << sizeof(b1) << "，计数：" << b1->use_count() << std::endl; // 大小8，计数2
+    }
+
+    // 场景15：atomic_shared_ptr：写线程发布新配置，读线程拿到的快照在用完前不会被释放
+    {
+        atomic_shared_ptr<MyObj> config(make_shared<MyObj>(60));
+        shared_ptr<MyObj> snapshot = config.load();
+        std::thread writer([&config]() { config.store(make_shared<MyObj>(61)); });
+        writer.join();
+        std::cout << "旧快照：";
+        snapshot->show(); // 60，旧配置在snapshot析构时才释放
+        std::cout << "新配置：";
+        config.load()->show(); // 61
+    }
+
+    // 场景16：atomic_shared_ptr压力测试：读线程数远多于CPU核数，借出引用的线程常在补充预充之前被切走；
+    // 读到的快照必须一直有效，结束后所有对象都被释放
+    {
+        {
+            atomic_shared_ptr<Counted> current(make_shared<Counted>(0));
+            std::atomic<bool> stop{false};
+            std::atomic<long> loads{0}, bad{0};
+            unsigned readers = std::max(16u, 4 * std::thread::hardware_concurrency());
+            std::vector<std::thread> threads;
+            for(unsigned i = 0; i < readers; i++)
+                threads.emplace_back([&]()
+                {
+                    while(!stop.load(std::memory_order_relaxed))
+                    {
+                        shared_ptr<Counted> snapshot = current.load();
+                        if(!snapshot or snapshot->val < 0) bad++;
+                        loads.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            threads.emplace_back([&]()
+            {
+                for(long i = 1; !stop.load(std::memory_order_relaxed); i++)
+                {
+                    current.store(make_shared<Counted>(i));
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            stop = true;
+            for(std::thread& t : threads) t.join();
+            std::cout << readers << " 个读线程，load " << loads << " 次，无效快照 " << bad << std::endl; // 无效快照 0
+        }
+        std::cout << "存活对象：" << Counted::live << std::endl; // 0
+    }
+
+    // 场景17：对象池：删除器是空类型，句柄仍是一个指针；释放的内存回到本线程的空闲链表
+    {
+        pool_unique_ptr<MyObj> u1 = make_pool_unique<MyObj>(70);
+        MyObj* first = u1.get();
+        u1.reset();
+        pool_unique_ptr<MyObj> u2 = make_pool_unique<MyObj>(71);
+        shared_ptr<MyObj> s1 = make_pool_shared<MyObj>(72);
+        std::cout << "pool_unique_ptr 大小：" << sizeof(u2) << "，复用了同一块：" << (u2.get() == first) << std::endl; // 大小8，1
+        s1->show(); // 72
+    }
+
+    // 场景18：资源释放（p2/p5析构时，计数归0，MyObj析构）
     return 0;
 }
\ No newline at end of file
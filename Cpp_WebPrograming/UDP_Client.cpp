@@ -6,13 +6,32 @@
 #include <stdexcept>
 #include <cstring>
 #include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "rudp.h"
 
 class UDPClient
 {
 private:
+    // 可靠模式的状态：后台loop线程负责重传与确认，收到的响应经队列交给调用线程
+    struct Reliable
+    {
+        EpollEventLoop loop;
+        std::unique_ptr<RudpEndpoint> endpoint;
+        std::thread loop_thread;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::deque<std::string> responses;
+    };
+
     const std::string server_ip;
     const uint16_t server_port;
     int client_fd;
+    std::unique_ptr<Reliable> reliable;
 
     void error(const std::string& msg, bool close_client = true)
     {
@@ -39,6 +58,12 @@ public:
     // 析构函数：关闭套接字
     ~UDPClient() noexcept
     {
+        if (reliable)
+        {
+            reliable->loop.stop();
+            reliable->loop_thread.join();
+            reliable->endpoint.reset();
+        }
         if (client_fd != -1)
         {
             close(client_fd);
@@ -57,6 +82,33 @@ public:
                   << server_ip << ":" << server_port << std::endl;
     }
 
+    // 切换到可靠UDP模式（见 rudp.h），须在init之后调用；服务端也要以reliable模式运行
+    // loss_rate 为测试用的发包丢弃概率
+    void enable_reliable(double loss_rate = 0)
+    {
+        if (client_fd == -1)
+        {
+            error("Client socket not initialized!", false);
+        }
+        reliable = std::make_unique<Reliable>();
+        RudpOptions opts;
+        opts.loss_rate = loss_rate;
+        reliable->endpoint = std::make_unique<RudpEndpoint>(&reliable->loop, client_fd, opts);
+        Reliable* r = reliable.get();
+        r->endpoint->SetMessageCallback([r](const sockaddr_in&, std::string_view msg)
+        {
+            std::lock_guard<std::mutex> lock(r->mtx);
+            r->responses.emplace_back(msg);
+            r->cv.notify_one();
+        });
+        r->endpoint->SetPeerDownCallback([](const sockaddr_in&, size_t unsent)
+        {
+            std::cerr << "[Warning] Server unreachable, session dropped with " << unsent << " unacknowledged messages." << std::endl;
+        });
+        r->loop_thread = std::thread([r]() { r->loop.loop(); });
+        std::cout << "[Info] Reliable mode enabled, injected loss: " << loss_rate * 100 << "%" << std::endl;
+    }
+
     // 发送消息到服务器，并接收响应
     void send_and_receive(const std::string& msg)
     {
@@ -76,6 +128,26 @@ public:
             error("Invalid server IP address!");
         }
 
+        // 可靠模式：丢包由后台重传恢复，这里只需要等待响应，超时说明服务端不可达
+        if (reliable)
+        {
+            if (!reliable->endpoint->Send(server_addr, msg))
+            {
+                std::cerr << "[Warning] Message exceeds " << kRudpMaxPayload << " bytes, not sent." << std::endl;
+                return;
+            }
+            std::cout << "[Info] Sent message to server: " << msg << std::endl;
+            std::unique_lock<std::mutex> lock(reliable->mtx);
+            if (!reliable->cv.wait_for(lock, std::chrono::seconds(5), [this]() { return !reliable->responses.empty(); }))
+            {
+                std::cerr << "[Warning] No response from server within 5s." << std::endl;
+                return;
+            }
+            std::cout << "[Info] Received response from server: " << reliable->responses.front() << std::endl;
+            reliable->responses.pop_front();
+            return;
+        }
+
         // 发送消息到服务器
         ssize_t send_len = sendto(
             client_fd,
@@ -113,12 +185,18 @@ public:
     }
 };
 
-int main()
+// 用法: ./udpclient [server_ip] [port] [reliable] [注入丢包率(%)]
+int main(int argc, char* argv[])
 {
+    std::string ip = argc > 1 ? argv[1] : "192.168.182.128";
+    uint16_t port = argc > 2 ? static_cast<uint16_t>(std::stoi(argv[2])) : 9999;
+    bool reliable = argc > 3 and std::string(argv[3]) == "reliable";
+    double loss_rate = argc > 4 ? std::stod(argv[4]) / 100 : 0;
     try
     {
-        UDPClient client("192.168.182.128", 9999);
+        UDPClient client(ip, port);
         client.init();
+        if (reliable) client.enable_reliable(loss_rate);
 
         std::string input_msg;
         std::cout << "Enter message to send (type 'quit' to exit): ";
@@ -6,12 +6,24 @@
 #include <stdexcept>
 #include <atomic>
 #include <cstring>
+
+#include "rudp.h"
+#include "udp_offload.h"
+
 class UDPServer
 {
 private:
     const uint16_t server_port;
     int server_fd;
     std::atomic<bool> is_running;
+    std::atomic<EpollEventLoop*> reliable_loop{nullptr};
+    // 分段卸载模式（enable_offload）：GSO批量发送、GRO/recvmmsg批量接收
+    std::unique_ptr<UdpBulkSender> bulk_sender;
+    std::unique_ptr<UdpBatchReceiver> batch_receiver;
+    // 批量响应：任何源地址（可伪造）都能请求，总长设上限防止被当作反射放大器；数据从固定缓冲区循环发出，不按请求分配
+    static constexpr size_t kMaxBulkBytes = 4 << 20;
+    static constexpr size_t kBulkBufferBytes = 256 << 10;
+    std::string bulk_payload;
 
     void error(const std::string& msg,bool CloseServer = true)
     {
@@ -89,6 +101,61 @@ public:
         }
     }
 
+    // 须在init之后调用；内核不支持GSO/GRO时自动回退到sendmmsg/recvmmsg
+    void enable_offload()
+    {
+        bulk_sender = std::make_unique<UdpBulkSender>(server_fd);
+        batch_receiver = std::make_unique<UdpBatchReceiver>(server_fd);
+        bulk_payload.assign(kBulkBufferBytes, 'B');
+        std::cout << "[Info] Offload mode: send " << (bulk_sender->GsoEnabled() ? "UDP_SEGMENT" : "sendmmsg")
+                  << ", receive " << (batch_receiver->GroEnabled() ? "UDP_GRO" : "recvmmsg") << std::endl;
+    }
+
+    // 批量响应（仅offload模式）：把bytes字节的数据按seg_size切成数据报发给客户端，每批从bulk_payload发出
+    void send_bulk(size_t bytes, size_t seg_size, const sockaddr_in& client_addr)
+    {
+        size_t chunk = bulk_payload.size() / seg_size * seg_size;
+        ssize_t datagrams = 0;
+        for(size_t off = 0; off < bytes;)
+        {
+            size_t n = std::min(chunk, bytes - off);
+            ssize_t sent = bulk_sender->Send(client_addr, bulk_payload.data(), n, seg_size);
+            if(sent < 0)
+            {
+                std::cerr << "[Warning] Bulk send failed: " << strerror(errno) << std::endl;
+                return;
+            }
+            datagrams += sent;
+            off += n;
+        }
+        std::cout << "[Info] Sent " << bytes << " bytes as " << datagrams << " datagrams of " << seg_size << " bytes" << std::endl;
+    }
+
+    // 普通消息原样回复；offload模式下 "bulk <字节数> [段长]" 请求批量响应（最多kMaxBulkBytes），其他模式按普通消息回复
+    void handle_message(const std::string& recv_msg, const sockaddr_in& client_addr)
+    {
+        std::string client_ip = inet_ntoa(client_addr.sin_addr);
+        uint16_t client_port = ntohs(client_addr.sin_port);
+
+        // 打印客户端消息
+        std::cout << "[Client " << client_ip << ":" << client_port << "] Message: " << recv_msg << std::endl;
+
+        if(bulk_sender and recv_msg.compare(0, 5, "bulk ") == 0)
+        {
+            size_t bytes = 0, seg_size = 1024;
+            if(sscanf(recv_msg.c_str() + 5, "%zu %zu", &bytes, &seg_size) >= 1 and seg_size > 0
+               and seg_size <= kUdpMaxPayload and bytes <= kMaxBulkBytes)
+            {
+                send_bulk(bytes, seg_size, client_addr);
+                return;
+            }
+        }
+
+        // 构造响应消息并发送
+        std::string response = "Server received your message: " + recv_msg;
+        send_msg(response, client_addr);
+    }
+
     void start_communicate()
     {
 
@@ -98,7 +165,20 @@ public:
 
         std::cout << "[Info] UDP Server started! Waiting for client messages..." << std::endl;
 
-        while (is_running.load())
+        while (is_running.load() and batch_receiver)
+        {
+            // 一次系统调用收取多个数据报（GRO合并的数据报在这里被切开），逐个处理
+            int n = batch_receiver->Receive([this](const sockaddr_in& from, const char* data, size_t len)
+            {
+                if(len > 0) handle_message(std::string(data, len), from);
+            }, MSG_WAITFORONE);
+            if(n == -1 and is_running.load())
+            {
+                error("Failed to receive message!", false);
+            }
+        }
+
+        while (is_running.load() and !batch_receiver)
         {
             // 接收客户端消息（UDP无连接，每次recvfrom获取客户端地址）
             ssize_t recv_len = recvfrom(
@@ -131,18 +211,8 @@ public:
                 continue;
             }
 
-            // 解析客户端信息
             buffer[recv_len] = '\0'; // 字符串结束符
-            std::string client_ip = inet_ntoa(client_addr.sin_addr);
-            uint16_t client_port = ntohs(client_addr.sin_port);
-            std::string recv_msg = buffer;
-
-            // 打印客户端消息
-            std::cout << "[Client " << client_ip << ":" << client_port << "] Message: " << recv_msg << std::endl;
-
-            // 构造响应消息并发送
-            std::string response = "Server received your message: " + recv_msg;
-            send_msg(response, client_addr);
+            handle_message(buffer, client_addr);
 
             // 清空缓冲区
             memset(buffer, 0, sizeof(buffer));
@@ -152,23 +222,55 @@ public:
 
     };
 
+    // 可靠UDP模式（见 rudp.h）：每个客户端地址一个会话，消息带序号与选择确认，丢失的包按超时或快速重传恢复
+    // loss_rate 为测试用的发包丢弃概率
+    void start_reliable(double loss_rate = 0)
+    {
+        EpollEventLoop loop;
+        RudpOptions opts;
+        opts.loss_rate = loss_rate;
+        RudpEndpoint endpoint(&loop, server_fd, opts);
+        endpoint.SetMessageCallback([&endpoint](const sockaddr_in& client_addr, std::string_view msg)
+        {
+            std::cout << "[Client " << inet_ntoa(client_addr.sin_addr) << ":" << ntohs(client_addr.sin_port)
+                      << "] Message: " << msg << std::endl;
+            if(!endpoint.Send(client_addr, "Server received your message: " + std::string(msg)))
+            {
+                std::cerr << "[Warning] Response exceeds " << kRudpMaxPayload << " bytes, dropped." << std::endl;
+            }
+        });
+        reliable_loop.store(&loop);
+        std::cout << "[Info] Reliable UDP Server started! Injected loss: " << loss_rate * 100 << "%" << std::endl;
+        loop.loop();
+        reliable_loop.store(nullptr);
+        std::cout << "[Info] Reliable UDP Server stopped.\n" << endpoint.StatsText();
+    }
+
     void stop()
     {
         is_running.store(false);
+        if(EpollEventLoop* loop = reliable_loop.load()) loop->stop();
         if(server_fd != -1) shutdown(server_fd, SHUT_RD);
     }
 
 };
 
-int main()
+// 用法: ./udpserver [port] [reliable|offload] [注入丢包率(%)，仅reliable]
+int main(int argc, char* argv[])
 {
+    uint16_t port = argc > 1 ? static_cast<uint16_t>(std::stoi(argv[1])) : 9999;
+    std::string mode = argc > 2 ? argv[2] : "";
+    bool reliable = mode == "reliable";
+    double loss_rate = argc > 3 ? std::stod(argv[3]) / 100 : 0;
     try
     {
-        // 创建UDP服务器（监听9999端口）
-        UDPServer server(9999);
+        // 创建UDP服务器（默认监听9999端口）
+        UDPServer server(port);
         // 初始化并启动服务器
         server.init();
-        server.start_communicate();
+        if(mode == "offload") server.enable_offload();
+        if(reliable) server.start_reliable(loss_rate);
+        else server.start_communicate();
     }
     catch (const std::runtime_error& e)
     {
@@ -0,0 +1,491 @@
+// 异步多路复用客户端：服务间调用用的SDK，复用服务端的 EpollEventLoop 与 Connection
+// 一个后台loop线程驱动所有连接：每个后端地址一个连接池，每条连接上用v2帧（frame.h）同时承载多个在途请求，
+// 请求按id匹配响应；支持单次尝试超时、失败重试（指数退避），提供future与回调两种接口
+//
+//   AsyncClient client;
+//   auto f = client.Call("127.0.0.1:9999", "ping");                          // future接口
+//   client.Call("127.0.0.1:9999", "ping", [](ClientResponse r) { ... });     // 回调接口
+//   std::cout << f.get().payload;
+//
+// 重试会重发请求：超时的请求可能已被服务端执行过，非幂等请求应设置 CallOptions::retries = 0
+// 回调默认在loop线程中执行，不能阻塞，也不能在其中析构客户端；可以在回调里继续发起调用
+
+#ifndef ASYNC_CLIENT_H
+#define ASYNC_CLIENT_H
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <future>
+#include <sstream>
+
+#include "reactor.h"
+#include "frame.h"
+
+enum class CallStatus {
+    kOk,
+    kRemoteError,    // 服务端回复了错误帧，不重试
+    kTimeout,
+    kConnectFailed,
+    kConnectionLost, // 请求已发出，等待响应期间连接断开
+    kClientClosed,
+};
+
+inline const char* CallStatusName(CallStatus status)
+{
+    switch(status) {
+        case CallStatus::kOk: return "ok";
+        case CallStatus::kRemoteError: return "remote error";
+        case CallStatus::kTimeout: return "timeout";
+        case CallStatus::kConnectFailed: return "connect failed";
+        case CallStatus::kConnectionLost: return "connection lost";
+        case CallStatus::kClientClosed: return "client closed";
+    }
+    return "unknown";
+}
+
+struct ClientResponse {
+    CallStatus status = CallStatus::kOk;
+    std::string payload; // 成功时为响应内容，失败时为错误信息
+    int attempts = 0;    // 实际尝试次数（含重试）
+    bool ok() const { return status == CallStatus::kOk; }
+};
+
+struct ClientOptions {
+    int connections_per_endpoint = 2;             // 按需建立，每个地址最多这么多条连接
+    std::chrono::milliseconds connect_timeout{1000};
+    std::chrono::milliseconds timeout{1000};      // 单次尝试的超时（从投递到收到响应）
+    int retries = 2;                              // 超时、连接失败或断开后的重试次数
+    std::chrono::milliseconds backoff{10};        // 第一次重试前等待，之后每次翻倍
+    int callback_threads = 0;                     // 0：回调在loop线程中执行
+};
+
+// 单次调用覆盖 ClientOptions 中的对应项
+struct CallOptions {
+    std::chrono::milliseconds timeout{0}; // 0：使用ClientOptions::timeout
+    int retries = -1;                     // -1：使用ClientOptions::retries
+};
+
+class AsyncClient {
+public:
+    using Callback = std::function<void(ClientResponse)>;
+
+private:
+    struct Slot;
+    struct Endpoint;
+
+    enum class CallState { kQueued, kSent, kBackoff, kDone };
+
+    // 一次调用，跨越所有重试；除构造外只在loop线程访问
+    struct PendingCall {
+        uint64_t id = 0;
+        std::string payload;
+        Callback cb;
+        std::chrono::milliseconds timeout{0};
+        int retries_left = 0;
+        int attempts = 0;
+        CallState state = CallState::kQueued;
+        Endpoint* ep = nullptr;
+        Slot* slot = nullptr;              // 已发出时所在的连接
+        EpollEventLoop::TimerId timer = 0; // 本次尝试的超时，或退避等待
+    };
+    using CallPtr = std::shared_ptr<PendingCall>;
+
+    enum class SlotState { kIdle, kConnecting, kConnected };
+
+    // 连接池中的一个位置，断开后可以重新连接；Slot本身在客户端析构前不会释放
+    struct Slot {
+        Endpoint* ep = nullptr;
+        SlotState state = SlotState::kIdle;
+        int connecting_fd = -1;
+        std::unique_ptr<Channel> connect_channel;  // 只在非阻塞connect期间监听可写
+        EpollEventLoop::TimerId connect_timer = 0;
+        ConnectionPtr conn;
+        std::unordered_map<uint64_t, CallPtr> inflight;
+        std::string out;                           // 本轮loop中待发送的帧，合并为一次Send
+    };
+
+    struct Endpoint {
+        std::string name;
+        sockaddr_in addr{};
+        std::vector<std::unique_ptr<Slot>> slots;
+        // 还没有可用连接的请求；second为入队时的attempts，超时或重试后旧的队列项随之作废
+        std::deque<std::pair<CallPtr, int>> waiting;
+    };
+
+    ClientOptions __opts;
+    EpollEventLoop __loop;
+    std::thread __loop_thread;
+    std::atomic<bool> __closed{false};
+    std::atomic<uint64_t> __next_id{1};
+
+    // 以下只在loop线程访问
+    std::unordered_map<std::string, std::unique_ptr<Endpoint>> __endpoints;
+    std::unordered_map<uint64_t, CallPtr> __live; // 所有未完成的调用，Close时统一失败
+
+    std::atomic<uint64_t> __calls{0};
+    std::atomic<uint64_t> __pending{0};
+    std::atomic<uint64_t> __succeeded{0};
+    std::atomic<uint64_t> __failed{0};
+    std::atomic<uint64_t> __retries{0};
+    std::atomic<uint64_t> __timeouts{0};
+    std::atomic<uint64_t> __connects{0};
+    std::atomic<uint64_t> __connect_failures{0};
+    std::atomic<uint64_t> __disconnects{0};
+
+    // 最后声明、最先析构：等池中的回调全部执行完，回调里访问客户端仍然安全
+    // callback_threads为0时不创建线程，只是满足Connection的构造参数
+    ThreadPool __pool;
+
+    static void Add(std::atomic<uint64_t>& counter, uint64_t n = 1) { counter.fetch_add(n, std::memory_order_relaxed); }
+
+    Endpoint* GetEndpoint(const std::string& name) {
+        auto it = __endpoints.find(name);
+        if(it != __endpoints.end()) return it->second.get();
+        auto colon = name.rfind(':');
+        if(colon == std::string::npos) return nullptr;
+        auto ep = std::make_unique<Endpoint>();
+        ep->name = name;
+        ep->addr.sin_family = AF_INET;
+        int port = atoi(name.c_str() + colon + 1);
+        if(port <= 0 or port > 65535 or inet_pton(AF_INET, name.substr(0, colon).c_str(), &ep->addr.sin_addr) != 1)
+            return nullptr;
+        ep->addr.sin_port = htons(static_cast<uint16_t>(port));
+        for(int i = 0; i < std::max(1, __opts.connections_per_endpoint); i++) {
+            auto slot = std::make_unique<Slot>();
+            slot->ep = ep.get();
+            ep->slots.push_back(std::move(slot));
+        }
+        return __endpoints.emplace(name, std::move(ep)).first->second.get();
+    }
+
+    void Start(const CallPtr& call, const std::string& endpoint) {
+        __live.emplace(call->id, call);
+        if(__closed.load()) {
+            Finish(call, CallStatus::kClientClosed, "client closed");
+            return;
+        }
+        call->ep = GetEndpoint(endpoint);
+        if(!call->ep) {
+            Finish(call, CallStatus::kConnectFailed, "invalid endpoint " + endpoint);
+            return;
+        }
+        Dispatch(call);
+    }
+
+    // 开始一次尝试：有已建立的连接就发到在途请求最少的一条，否则排队等连接建立
+    void Dispatch(const CallPtr& call) {
+        if(__closed.load()) {
+            Finish(call, CallStatus::kClientClosed, "client closed");
+            return;
+        }
+        call->attempts++;
+        call->timer = __loop.RunAfter(call->timeout, [this, call]() {
+            call->timer = 0;
+            Add(__timeouts);
+            Retry(call, CallStatus::kTimeout, "timeout");
+        });
+        Endpoint* ep = call->ep;
+        Slot* best = nullptr;
+        for(auto& slot : ep->slots) {
+            if(slot->state == SlotState::kConnected and (!best or slot->inflight.size() < best->inflight.size()))
+                best = slot.get();
+        }
+        if(best) {
+            SendOn(best, call);
+        } else {
+            call->state = CallState::kQueued;
+            ep->waiting.emplace_back(call, call->attempts);
+        }
+        MaybeConnect(ep);
+    }
+
+    // 已建立的连接都有在途请求时再多建一条，直到连接数上限；同一时刻每个地址只有一条在建立中
+    void MaybeConnect(Endpoint* ep) {
+        Slot* idle = nullptr;
+        for(auto& slot : ep->slots) {
+            if(slot->state == SlotState::kConnecting) return;
+            if(slot->state == SlotState::kConnected and slot->inflight.empty()) return;
+            if(slot->state == SlotState::kIdle and !idle) idle = slot.get();
+        }
+        if(idle) Connect(idle);
+    }
+
+    void SendOn(Slot* slot, const CallPtr& call) {
+        call->state = CallState::kSent;
+        call->slot = slot;
+        slot->inflight.emplace(call->id, call);
+        bool first = slot->out.empty();
+        AppendFrame(slot->out, call->id, 0, call->payload);
+        // 同一轮loop里投递到这条连接的请求合并成一次发送
+        if(first) __loop.QueueInLoop([this, slot]() { Flush(slot); });
+    }
+
+    void Flush(Slot* slot) {
+        if(slot->state != SlotState::kConnected or slot->out.empty()) return;
+        std::string data;
+        data.swap(slot->out);
+        slot->conn->Send(std::move(data));
+    }
+
+    // 本次尝试失败：还有重试次数就退避后重新投递，否则以该状态结束
+    void Retry(const CallPtr& call, CallStatus status, std::string reason) {
+        if(call->state == CallState::kDone) return;
+        if(call->timer) {
+            __loop.CancelTimer(call->timer);
+            call->timer = 0;
+        }
+        Detach(call);
+        if(call->retries_left <= 0 or __closed.load()) {
+            Finish(call, status, std::move(reason));
+            return;
+        }
+        call->retries_left--;
+        call->state = CallState::kBackoff;
+        Add(__retries);
+        auto delay = __opts.backoff * (1 << std::min(call->attempts - 1, 10));
+        call->timer = __loop.RunAfter(delay, [this, call]() {
+            call->timer = 0;
+            Dispatch(call);
+        });
+    }
+
+    void Detach(const CallPtr& call) {
+        if(call->slot) {
+            call->slot->inflight.erase(call->id);
+            call->slot = nullptr;
+        }
+    }
+
+    void Finish(const CallPtr& call, CallStatus status, std::string payload) {
+        if(call->state == CallState::kDone) return;
+        call->state = CallState::kDone;
+        if(call->timer) {
+            __loop.CancelTimer(call->timer);
+            call->timer = 0;
+        }
+        Detach(call);
+        __live.erase(call->id);
+        __pending.fetch_sub(1, std::memory_order_relaxed);
+        Add(status == CallStatus::kOk ? __succeeded : __failed);
+        ClientResponse resp{status, std::move(payload), call->attempts};
+        Callback cb = std::move(call->cb);
+        if(__opts.callback_threads > 0) {
+            __pool.submit([cb = std::move(cb), resp = std::move(resp)]() mutable { cb(std::move(resp)); });
+        } else {
+            cb(std::move(resp));
+        }
+    }
+
+    void Connect(Slot* slot) {
+        Add(__connects);
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if(fd == -1) {
+            OnConnectFailed(slot, std::string("socket failed: ") + strerror(errno));
+            return;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        slot->state = SlotState::kConnecting;
+        if(connect(fd, reinterpret_cast<const sockaddr*>(&slot->ep->addr), sizeof(sockaddr_in)) == 0) {
+            OnConnected(slot, fd);
+            return;
+        }
+        if(errno != EINPROGRESS) {
+            int err = errno;
+            close(fd);
+            OnConnectFailed(slot, strerror(err));
+            return;
+        }
+        // 连接结果通过可写事件通知，出错时也可能以EPOLLERR/EPOLLHUP到达
+        slot->connecting_fd = fd;
+        slot->connect_channel = std::make_unique<Channel>(fd);
+        slot->connect_channel->SetEvents(EPOLLOUT);
+        slot->connect_channel->SetWriteCallBack([this, slot]() { HandleConnect(slot); });
+        slot->connect_channel->SetReadCallBack([this, slot]() { HandleConnect(slot); });
+        slot->connect_channel->SetCloseCallBack([this, slot]() { HandleConnect(slot); });
+        __loop.AddChannel(slot->connect_channel.get());
+        slot->connect_timer = __loop.RunAfter(__opts.connect_timeout, [this, slot]() {
+            slot->connect_timer = 0;
+            close(ReleaseConnecting(slot));
+            OnConnectFailed(slot, "connect timeout");
+        });
+    }
+
+    // 注销connect用的Channel，返回socket；Channel可能正在执行自己的回调，延后到任务队列阶段再释放
+    int ReleaseConnecting(Slot* slot) {
+        int fd = slot->connecting_fd;
+        slot->connecting_fd = -1;
+        __loop.DelChannel(slot->connect_channel.get());
+        __loop.QueueInLoop([channel = std::shared_ptr<Channel>(std::move(slot->connect_channel))]() {});
+        if(slot->connect_timer) {
+            __loop.CancelTimer(slot->connect_timer);
+            slot->connect_timer = 0;
+        }
+        return fd;
+    }
+
+    void HandleConnect(Slot* slot) {
+        if(slot->state != SlotState::kConnecting or slot->connecting_fd == -1) return;
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if(getsockopt(slot->connecting_fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1) err = errno;
+        int fd = ReleaseConnecting(slot);
+        if(err != 0) {
+            close(fd);
+            OnConnectFailed(slot, strerror(err));
+            return;
+        }
+        OnConnected(slot, fd);
+    }
+
+    void OnConnected(Slot* slot, int fd) {
+        auto conn = std::make_shared<Connection>(&__loop, __pool, fd);
+        conn->SetMessageCallback([this, slot](const ConnectionPtr& c, Buffer* buf) { OnMessage(slot, c, buf); });
+        conn->SetConnectionCallback([this, slot](const ConnectionPtr& c) {
+            if(!c->Connected()) OnConnectionLost(slot, c);
+        });
+        slot->conn = conn;
+        slot->state = SlotState::kConnected;
+        conn->ConnectEstablished();
+        // 等待中的请求全部交给这条新连接
+        Endpoint* ep = slot->ep;
+        auto waiting = std::move(ep->waiting);
+        ep->waiting.clear();
+        for(auto& [call, attempt] : waiting) {
+            if(call->state == CallState::kQueued and call->attempts == attempt) SendOn(slot, call);
+        }
+    }
+
+    // 只有当该地址已没有正在建立或已建立的连接时，排队的请求才算这次尝试失败
+    void OnConnectFailed(Slot* slot, const std::string& reason) {
+        slot->state = SlotState::kIdle;
+        Add(__connect_failures);
+        Endpoint* ep = slot->ep;
+        for(auto& s : ep->slots) {
+            if(s->state != SlotState::kIdle) return;
+        }
+        auto waiting = std::move(ep->waiting);
+        ep->waiting.clear();
+        for(auto& [call, attempt] : waiting) {
+            if(call->state == CallState::kQueued and call->attempts == attempt)
+                Retry(call, CallStatus::kConnectFailed, "connect " + ep->name + " failed: " + reason);
+        }
+    }
+
+    void OnConnectionLost(Slot* slot, const ConnectionPtr& conn) {
+        if(slot->conn != conn) return;
+        Add(__disconnects);
+        slot->conn.reset();
+        slot->state = SlotState::kIdle;
+        slot->out.clear();
+        // 先整体摘下，Retry/Finish里的回调可能再次向本地址投递请求
+        auto inflight = std::move(slot->inflight);
+        slot->inflight.clear();
+        for(auto& [id, call] : inflight) {
+            call->slot = nullptr;
+            Retry(call, CallStatus::kConnectionLost, "connection to " + slot->ep->name + " lost");
+        }
+    }
+
+    void OnMessage(Slot* slot, const ConnectionPtr& conn, Buffer* buf) {
+        struct Done {
+            CallPtr call;
+            bool error;
+            std::string payload;
+        };
+        std::vector<Done> done;
+        Frame frame;
+        ssize_t n;
+        while((n = ParseFrame(buf->Peek(), buf->ReadableBytes(), frame)) > 0) {
+            // 找不到id的是已超时的请求迟到的响应，直接丢弃
+            auto it = slot->inflight.find(frame.id);
+            if(it != slot->inflight.end()) {
+                it->second->slot = nullptr;
+                done.push_back({std::move(it->second), (frame.flags & kFrameError) != 0, std::string(frame.payload)});
+                slot->inflight.erase(it);
+            }
+            buf->Retrieve(n);
+        }
+        for(auto& d : done)
+            Finish(d.call, d.error ? CallStatus::kRemoteError : CallStatus::kOk, std::move(d.payload));
+        if(n < 0) {
+            std::cerr << "[Warning] Bad frame from " << slot->ep->name << ", closing." << std::endl;
+            conn->ForceClose();
+        }
+    }
+
+public:
+    explicit AsyncClient(ClientOptions opts = {}) :
+        __opts(opts), __pool(std::max(0, opts.callback_threads)) {
+            __loop_thread = std::thread([this]() { __loop.loop(); });
+        }
+
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    // 不能在loop线程（默认的回调）中析构
+    ~AsyncClient() noexcept {
+        Close();
+        __loop.stop();
+        if(__loop_thread.joinable()) __loop_thread.join();
+    }
+
+    // 可在任意线程调用；endpoint为 "IPv4:port"
+    void Call(const std::string& endpoint, std::string payload, Callback cb, CallOptions opts = {}) {
+        auto call = std::make_shared<PendingCall>();
+        call->id = __next_id.fetch_add(1, std::memory_order_relaxed);
+        call->payload = std::move(payload);
+        call->cb = std::move(cb);
+        call->timeout = opts.timeout.count() > 0 ? opts.timeout : __opts.timeout;
+        call->retries_left = opts.retries >= 0 ? opts.retries : __opts.retries;
+        Add(__calls);
+        __pending.fetch_add(1, std::memory_order_relaxed);
+        __loop.RunInLoop([this, call, endpoint]() { Start(call, endpoint); });
+    }
+
+    std::future<ClientResponse> Call(const std::string& endpoint, std::string payload, CallOptions opts = {}) {
+        auto promise = std::make_shared<std::promise<ClientResponse>>();
+        auto future = promise->get_future();
+        Call(endpoint, std::move(payload), [promise](ClientResponse resp) { promise->set_value(std::move(resp)); }, opts);
+        return future;
+    }
+
+    // 所有未完成的调用以kClientClosed结束并断开全部连接，之后的调用立即失败；可重复调用
+    void Close() {
+        if(__closed.exchange(true)) return;
+        std::promise<void> closed;
+        __loop.RunInLoop([this, &closed]() {
+            std::vector<CallPtr> calls;
+            for(auto& [id, call] : __live) calls.push_back(call);
+            for(auto& call : calls) Finish(call, CallStatus::kClientClosed, "client closed");
+            for(auto& [name, ep] : __endpoints) {
+                for(auto& slot : ep->slots) {
+                    if(slot->state == SlotState::kConnecting) {
+                        close(ReleaseConnecting(slot.get()));
+                        slot->state = SlotState::kIdle;
+                    } else if(slot->conn) {
+                        slot->conn->ForceClose();
+                    }
+                }
+            }
+            closed.set_value();
+        });
+        closed.get_future().wait();
+    }
+
+    // 已发起但尚未完成（含排队、退避中）的调用数
+    size_t Pending() const { return __pending.load(std::memory_order_relaxed); }
+
+    std::string StatsText() const {
+        std::ostringstream os;
+        os << "calls " << __calls.load() << ", ok " << __succeeded.load() << ", failed " << __failed.load()
+           << ", pending " << __pending.load() << "\n"
+           << "retries " << __retries.load() << ", timeouts " << __timeouts.load() << "\n"
+           << "connects " << __connects.load() << ", connect failures " << __connect_failures.load()
+           << ", disconnects " << __disconnects.load() << "\n";
+        return os.str();
+    }
+};
+
+#endif // ASYNC_CLIENT_H
@@ -0,0 +1,131 @@
+// AsyncClient 示例与压测：先演示超时与重试，再在全部后端上保持concurrency个在途调用，
+// 每完成一个立即补发一个，统计吞吐、延迟分位数与各类失败。后端为 pipeline_server
+// 用法: ./async_client_bench [后端列表，逗号分隔，默认127.0.0.1:9999] [并发数，默认64] [秒数，默认3]
+//                           [每个后端的连接数，默认2] [超时毫秒，默认1000]
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "async_client.h"
+
+using Clock = std::chrono::steady_clock;
+
+// 回调在客户端的loop线程中执行，统计数据不需要加锁；只有结束时的通知需要
+class LoadRun {
+private:
+    AsyncClient& __client;
+    std::vector<std::string> __endpoints;
+    std::string __payload;
+    Clock::time_point __deadline;
+    size_t __next = 0;
+    int __outstanding = 0;
+    uint64_t __completed = 0;
+    std::vector<double> __latency_us;
+    std::map<CallStatus, uint64_t> __errors;
+    std::mutex __mtx;
+    std::condition_variable __cv;
+    bool __done = false;
+
+    void Issue() {
+        auto start = Clock::now();
+        const std::string& ep = __endpoints[__next++ % __endpoints.size()];
+        __client.Call(ep, __payload, [this, start](ClientResponse resp) { OnResponse(resp, start); });
+    }
+
+    void OnResponse(const ClientResponse& resp, Clock::time_point start) {
+        auto now = Clock::now();
+        if(resp.ok()) {
+            __completed++;
+            __latency_us.push_back(std::chrono::duration<double, std::micro>(now - start).count());
+        } else {
+            __errors[resp.status]++;
+        }
+        if(now < __deadline) {
+            Issue();
+            return;
+        }
+        if(--__outstanding == 0) {
+            std::lock_guard<std::mutex> lock(__mtx);
+            __done = true;
+            __cv.notify_one();
+        }
+    }
+
+public:
+    LoadRun(AsyncClient& client, std::vector<std::string> endpoints, std::string payload) :
+        __client(client), __endpoints(std::move(endpoints)), __payload(std::move(payload)) {}
+
+    void Run(int concurrency, std::chrono::seconds duration) {
+        auto start = Clock::now();
+        __deadline = start + duration;
+        __outstanding = concurrency;
+        __latency_us.reserve(1 << 20);
+        for(int i = 0; i < concurrency; i++) Issue();
+        std::unique_lock<std::mutex> lock(__mtx);
+        __cv.wait(lock, [this]() { return __done; });
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::sort(__latency_us.begin(), __latency_us.end());
+        auto pct = [this](double p) {
+            return __latency_us.empty() ? 0.0 : __latency_us[static_cast<size_t>(p / 100 * (__latency_us.size() - 1))];
+        };
+        std::cout << std::fixed << std::setprecision(0) << "req/s " << __completed / seconds << ", p50 " << pct(50)
+                  << "us, p99 " << pct(99) << "us, p99.9 " << pct(99.9) << "us" << std::endl;
+        for(auto& [status, count] : __errors) std::cout << "  " << CallStatusName(status) << ": " << count << std::endl;
+    }
+};
+
+static std::vector<std::string> SplitEndpoints(const std::string& list)
+{
+    std::vector<std::string> out;
+    size_t pos = 0;
+    while(pos <= list.size()) {
+        size_t comma = list.find(',', pos);
+        if(comma == std::string::npos) comma = list.size();
+        if(comma > pos) out.push_back(list.substr(pos, comma - pos));
+        pos = comma + 1;
+    }
+    return out;
+}
+
+int main(int argc, char* argv[])
+{
+    signal(SIGPIPE, SIG_IGN);
+    std::vector<std::string> endpoints = SplitEndpoints(argc > 1 ? argv[1] : "127.0.0.1:9999");
+    int concurrency = argc > 2 ? std::stoi(argv[2]) : 64;
+    int seconds = argc > 3 ? std::stoi(argv[3]) : 3;
+    ClientOptions opts;
+    opts.connections_per_endpoint = argc > 4 ? std::stoi(argv[4]) : 2;
+    opts.timeout = std::chrono::milliseconds(argc > 5 ? std::stoi(argv[5]) : 1000);
+    if(endpoints.empty()) {
+        std::cerr << "no endpoint" << std::endl;
+        return 1;
+    }
+
+    AsyncClient client(opts);
+
+    // 演示：正常调用；超过超时的慢请求（不重试）；连不上的地址（重试后失败）
+    auto ok = client.Call(endpoints[0], "hello").get();
+    std::cout << "call: " << CallStatusName(ok.status) << " \"" << ok.payload << "\"" << std::endl;
+    CallOptions slow_opts;
+    slow_opts.timeout = std::chrono::milliseconds(100);
+    slow_opts.retries = 0;
+    auto slow = client.Call(endpoints[0], "sleep:300", slow_opts).get();
+    std::cout << "sleep:300 with 100ms timeout: " << CallStatusName(slow.status) << std::endl;
+    auto refused = client.Call("127.0.0.1:1", "hello").get();
+    std::cout << "127.0.0.1:1: " << CallStatusName(refused.status) << " after " << refused.attempts << " attempts ("
+              << refused.payload << ")" << std::endl;
+
+    std::cout << "\n" << concurrency << " concurrent calls over " << endpoints.size() << " endpoint(s), "
+              << opts.connections_per_endpoint << " connection(s) each, " << seconds << "s" << std::endl;
+    LoadRun run(client, endpoints, std::string(64, 'x'));
+    run.Run(concurrency, std::chrono::seconds(seconds));
+    std::cout << client.StatsText();
+    return 0;
+}
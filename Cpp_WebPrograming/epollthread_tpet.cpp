@@ -16,6 +16,9 @@
 #include <poll.h>
 #include <vector>
 #include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <cstring>
+#include <chrono>
 
 class TCPServer
 {
@@ -24,8 +27,10 @@ private:
     std::atomic<bool> is_running;
     const uint16_t server_port;
     int epfd; // epoll实例fd
+    int sig_fd = -1; // SIGINT/SIGTERM 经signalfd在事件循环中处理（信号处理函数中不能调用iostream/加锁）
     std::mutex mtx;
     ThreadPool pool;
+    std::chrono::milliseconds drain_deadline{5000}; // stop()等待线程池任务处理完的最长时间，超时后丢弃排队中的任务
 
     void error(const std::string& msg, bool CloseServer = true)
     {
@@ -37,6 +42,7 @@ private:
             server_fd = -1;
         }
         if(epfd != -1) close(epfd);
+        if(sig_fd != -1) close(sig_fd);
         is_running = false;
         throw std::runtime_error(msg);
     }
@@ -65,6 +71,7 @@ public:
         std::unique_lock<std::mutex> lock(mtx);
         if(server_fd != -1) close(server_fd);
         if(epfd != -1) close(epfd);
+        if(sig_fd != -1) close(sig_fd);
         std::cout << "[Info] TCPServer destoryed!" << std::endl;
     }
 
@@ -111,6 +118,18 @@ public:
         {
             error("Failed to add server_fd to epoll!");
         }
+        // 信号已在main中（创建线程池之前）屏蔽，这里改为从fd读取
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGINT);
+        sigaddset(&mask, SIGTERM);
+        sig_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+        ev.events = EPOLLIN;
+        ev.data.fd = sig_fd;
+        if(sig_fd == -1 or epoll_ctl(epfd, EPOLL_CTL_ADD, sig_fd, &ev) == -1)
+        {
+            error("Failed to create signalfd!");
+        }
         std::cout << "[Info] Server is currently listening on port: " << server_port << " (epoll mode)" << std::endl; 
     }
 
@@ -207,6 +226,13 @@ public:
                     {
                         new_client();
                     }
+                    else if(fd == sig_fd)
+                    {
+                        signalfd_siginfo info{};
+                        if(read(sig_fd, &info, sizeof(info)) != sizeof(info)) continue;
+                        std::cout << "\n[Info] Received " << strsignal(info.ssi_signo) << ", shutting down server..." << std::endl;
+                        stop();
+                    }
                     else
                     {
                         client_communicate(fd);
@@ -226,31 +252,30 @@ public:
             epoll_event dummy{};
             epoll_ctl(epfd, EPOLL_CTL_MOD, server_fd, &dummy);
         }
-        // 等待线程池任务处理完成 （graceful shutdown）
+        // 等待线程池任务处理完成 （graceful shutdown），最多等待drain_deadline
         std::unique_lock<std::mutex> end_lock(pool.end_mtx);
-        pool.end_cv.wait(end_lock, [this](){return pool.task_count == 0;});
+        if(!pool.end_cv.wait_for(end_lock, drain_deadline, [this](){return pool.task_count == 0;}))
+        {
+            end_lock.unlock();
+            size_t dropped = pool.discard_pending();
+            std::cerr << "[Warning] Drain deadline reached, " << dropped << " queued tasks dropped, "
+                      << pool.task_count << " still running." << std::endl;
+        }
     }
 };
 
-TCPServer* ptr = nullptr;
-
-void signals(int sig)
-{
-    if(ptr and sig == SIGINT)
-    {
-        std::cout << "\n[Info] Received SIGINT, shutting down server..." << std::endl;
-        ptr->stop();
-    }
-}
-
 int main()
 {   
     signal(SIGPIPE, SIG_IGN);
-    signal(SIGINT, signals);
+    // 屏蔽SIGINT/SIGTERM须在线程池创建之前，之后创建的线程都会继承，信号只能经signalfd读取
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
     try
     {
         TCPServer server(9999);
-        ptr = &server;
         server.init();
         server.epoll_loop();
     }
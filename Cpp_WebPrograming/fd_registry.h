@@ -0,0 +1,117 @@
+// 连接注册表：poll/select 服务器的客户端fd集合
+// - 稠密的pollfd数组 + 按fd直接寻址的下标索引，增删都是O(1)（删除时把末尾元素换到空位）
+// - Add/Remove 可在任意线程调用，只是把变更追加到按 fd % kStripes 分片的队列里（分片各自加锁，互不争用）；
+//   事件循环线程在两次poll之间调用 Apply 统一生效。同一fd的变更总在同一分片，先后顺序不会乱
+// - pollfd数组只由循环线程读写，poll可以直接使用，遍历事件期间发生的增删也不会打乱正在遍历的数组
+
+#ifndef FD_REGISTRY_H
+#define FD_REGISTRY_H
+
+#include <poll.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+class FdRegistry {
+private:
+    struct Op {
+        int fd;
+        short events; // 0 表示删除
+    };
+    struct Stripe {
+        std::mutex mtx;
+        std::vector<Op> ops;
+    };
+
+    static constexpr size_t kStripes = 16;
+
+    std::vector<pollfd> __fds;   // 以下两项只由循环线程访问
+    std::vector<int> __index;    // fd -> __fds中的下标，-1 表示未注册
+    int __max_fd = -1;
+
+    std::array<Stripe, kStripes> __stripes;
+    std::atomic<bool> __dirty{false};
+    std::atomic<size_t> __count{0};
+
+    void Push(int fd, short events) {
+        Stripe& stripe = __stripes[static_cast<size_t>(fd) % kStripes];
+        {
+            std::lock_guard<std::mutex> lock(stripe.mtx);
+            stripe.ops.push_back(Op{fd, events});
+        }
+        __dirty.store(true, std::memory_order_release);
+    }
+
+    bool Insert(int fd, short events) {
+        if(static_cast<size_t>(fd) >= __index.size()) __index.resize(std::max<size_t>(fd + 1, __index.size() * 2), -1);
+        if(__index[fd] != -1) {
+            __fds[__index[fd]].events = events;
+            return false;
+        }
+        __index[fd] = static_cast<int>(__fds.size());
+        __fds.push_back(pollfd{fd, events, 0});
+        if(fd > __max_fd) __max_fd = fd;
+        return true;
+    }
+
+    bool Erase(int fd) {
+        if(fd < 0 or static_cast<size_t>(fd) >= __index.size() or __index[fd] == -1) return false;
+        int idx = __index[fd];
+        __fds[idx] = __fds.back();
+        __index[__fds[idx].fd] = idx;
+        __fds.pop_back();
+        __index[fd] = -1;
+        // 最大fd被删时向下找下一个仍注册的fd，均摊O(1)
+        while(__max_fd >= 0 and __index[__max_fd] == -1) __max_fd--;
+        return true;
+    }
+
+public:
+    // 任意线程：登记变更，下一次Apply时生效
+    void Add(int fd, short events = POLLIN) {
+        if(fd < 0) return;
+        __count.fetch_add(1, std::memory_order_relaxed);
+        Push(fd, events);
+    }
+    void Remove(int fd) {
+        if(fd < 0) return;
+        __count.fetch_sub(1, std::memory_order_relaxed);
+        Push(fd, 0);
+    }
+
+    // 循环线程：应用所有已登记的变更；on_change(fd, added) 供select服务器同步自己的fd_set
+    template<typename F>
+    void Apply(F&& on_change) {
+        if(!__dirty.exchange(false, std::memory_order_acquire)) return;
+        std::vector<Op> ops;
+        for(Stripe& stripe : __stripes) {
+            {
+                std::lock_guard<std::mutex> lock(stripe.mtx);
+                ops.swap(stripe.ops);
+            }
+            for(const Op& op : ops) {
+                bool changed = op.events ? Insert(op.fd, op.events) : Erase(op.fd);
+                if(changed) on_change(op.fd, op.events != 0);
+            }
+            ops.clear();
+        }
+    }
+    void Apply() {
+        Apply([](int, bool) {});
+    }
+
+    // 以下只在循环线程中、Apply之后使用
+    std::vector<pollfd>& PollFds() { return __fds; }
+    int MaxFd() const { return __max_fd; }
+    bool Contains(int fd) const {
+        return fd >= 0 and static_cast<size_t>(fd) < __index.size() and __index[fd] != -1;
+    }
+
+    // 按已登记的变更计数（包括尚未Apply的）
+    size_t Size() const { return __count.load(std::memory_order_relaxed); }
+};
+
+#endif // FD_REGISTRY_H
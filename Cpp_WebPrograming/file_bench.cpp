@@ -0,0 +1,189 @@
+// 文件发送方式对比：read+send(1KB缓冲，现有服务器的写法) / read+send(64KB) / sendfile / splice
+// 本机回环TCP：发送线程按所选方式把同一个文件完整发送若干次，接收线程丢弃数据，统计吞吐与发送端CPU
+// 用法: ./file_bench [最大文件MB，默认1024] [临时目录，默认/tmp]
+#include <arpa/inet.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <ctime>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+using Clock = std::chrono::steady_clock;
+
+static double ThreadCpuSeconds()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool SendAll(int sock, const char* data, size_t len)
+{
+    while(len > 0) {
+        ssize_t n = send(sock, data, len, MSG_NOSIGNAL);
+        if(n <= 0) return false;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// 读进用户态缓冲再发送：每字节两次拷贝 + 两次系统调用/块
+static bool ReadSend(int sock, int file, size_t size, size_t buf_size)
+{
+    std::vector<char> buffer(buf_size);
+    off_t off = 0;
+    while(static_cast<size_t>(off) < size) {
+        ssize_t n = pread(file, buffer.data(), buffer.size(), off);
+        if(n <= 0 or !SendAll(sock, buffer.data(), n)) return false;
+        off += n;
+    }
+    return true;
+}
+
+static bool SendFile(int sock, int file, size_t size)
+{
+    off_t off = 0;
+    while(static_cast<size_t>(off) < size) {
+        ssize_t n = sendfile(sock, file, &off, size - off);
+        if(n <= 0) return false;
+    }
+    return true;
+}
+
+static bool Splice(int sock, int file, size_t size, int pipefd[2])
+{
+    loff_t off = 0;
+    while(static_cast<size_t>(off) < size) {
+        ssize_t in = splice(file, &off, pipefd[1], nullptr, size - off, SPLICE_F_MOVE);
+        if(in <= 0) return false;
+        while(in > 0) {
+            ssize_t out = splice(pipefd[0], nullptr, sock, nullptr, in, SPLICE_F_MOVE);
+            if(out <= 0) return false;
+            in -= out;
+        }
+    }
+    return true;
+}
+
+// 建立一对回环TCP连接
+static bool MakeTcpPair(int& client, int& server)
+{
+    int lis = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if(bind(lis, reinterpret_cast<sockaddr*>(&addr), len) == -1 or listen(lis, 1) == -1) return false;
+    getsockname(lis, reinterpret_cast<sockaddr*>(&addr), &len);
+    client = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(connect(client, reinterpret_cast<sockaddr*>(&addr), len) == -1) return false;
+    server = accept4(lis, nullptr, nullptr, SOCK_CLOEXEC);
+    close(lis);
+    return server != -1;
+}
+
+struct Result {
+    double mbps;
+    double cpu_per_gb; // 发送端每GB消耗的CPU秒
+};
+
+static Result RunOne(int file, size_t size, int iterations, const std::function<bool(int, int, size_t)>& method)
+{
+    int client, server;
+    if(!MakeTcpPair(client, server)) {
+        perror("tcp pair");
+        return {0, 0};
+    }
+    size_t total = size * iterations;
+    std::thread receiver([client, total]() {
+        std::vector<char> sink(256 * 1024);
+        size_t got = 0;
+        while(got < total) {
+            ssize_t n = recv(client, sink.data(), sink.size(), 0);
+            if(n <= 0) break;
+            got += n;
+        }
+    });
+    auto start = Clock::now();
+    double cpu_start = ThreadCpuSeconds();
+    for(int i = 0; i < iterations; i++) {
+        if(!method(server, file, size)) {
+            perror("send");
+            break;
+        }
+    }
+    double cpu = ThreadCpuSeconds() - cpu_start;
+    receiver.join();
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    close(client);
+    close(server);
+    double gb = total / (1024.0 * 1024.0 * 1024.0);
+    return {total / secs / (1024.0 * 1024.0), cpu / gb};
+}
+
+int main(int argc, char* argv[])
+{
+    size_t max_mb = argc > 1 ? std::stoul(argv[1]) : 1024;
+    std::string dir = argc > 2 ? argv[2] : "/tmp";
+
+    int pipefd[2];
+    if(pipe2(pipefd, O_CLOEXEC) == -1) {
+        perror("pipe");
+        return 1;
+    }
+    fcntl(pipefd[1], F_SETPIPE_SZ, 1024 * 1024);
+
+    std::vector<std::pair<std::string, std::function<bool(int, int, size_t)>>> methods = {
+        {"read+send 1KB", [](int s, int f, size_t n) { return ReadSend(s, f, n, 1024); }},
+        {"read+send 64KB", [](int s, int f, size_t n) { return ReadSend(s, f, n, 64 * 1024); }},
+        {"sendfile", [](int s, int f, size_t n) { return SendFile(s, f, n); }},
+        {"splice", [&pipefd](int s, int f, size_t n) { return Splice(s, f, n, pipefd); }},
+    };
+
+    std::cout << std::left << std::setw(10) << "size" << std::setw(16) << "method"
+              << std::right << std::setw(12) << "MB/s" << std::setw(16) << "cpu s/GB" << std::endl;
+    // 1KB ~ 1GB，每档x16
+    for(size_t size = 1024; size <= (1ul << 30) and size <= (max_mb << 20); size *= 16) {
+        // 临时文件：写满后预读一遍，测的是页缓存命中时的发送路径
+        std::string path = dir + "/file_bench_" + std::to_string(size) + ".bin";
+        int file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if(file == -1) {
+            perror("open");
+            return 1;
+        }
+        std::vector<char> block(1024 * 1024, 'x');
+        for(size_t written = 0; written < size;) {
+            ssize_t n = write(file, block.data(), std::min(block.size(), size - written));
+            if(n <= 0) break;
+            written += n;
+        }
+        posix_fadvise(file, 0, size, POSIX_FADV_WILLNEED);
+
+        // 每种方式至少发送约256MB，且不超过10万次
+        int iterations = static_cast<int>(std::clamp<size_t>((256ul << 20) / size, 1, 100000));
+        std::string label = size >= (1 << 30) ? std::to_string(size >> 30) + "GB"
+                          : size >= (1 << 20) ? std::to_string(size >> 20) + "MB"
+                          : std::to_string(size >> 10) + "KB";
+        for(auto& [name, method] : methods) {
+            Result r = RunOne(file, size, iterations, method);
+            std::cout << std::left << std::setw(10) << label << std::setw(16) << name << std::right
+                      << std::fixed << std::setprecision(1) << std::setw(12) << r.mbps
+                      << std::setprecision(3) << std::setw(16) << r.cpu_per_gb << std::endl;
+        }
+        close(file);
+        unlink(path.c_str());
+    }
+    close(pipefd[0]);
+    close(pipefd[1]);
+    return 0;
+}
@@ -0,0 +1,110 @@
+// 静态文件fd缓存：按路径缓存已打开的fd及stat信息，避免每个请求 open/fstat/close
+// 条目数量有上限（LRU淘汰）；每个条目最多每隔 revalidate 时间重新stat一次，文件被修改或替换后重新打开
+// 被淘汰的fd若仍在某连接的输出队列中，由FileDescPtr引用计数保证发送完毕后才关闭
+
+#ifndef FILECACHE_H
+#define FILECACHE_H
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "reactor.h"
+
+struct CachedFile {
+    FileDescPtr file;
+    off_t size = 0;
+    ino_t ino = 0;
+    timespec mtime{};
+};
+using CachedFilePtr = std::shared_ptr<const CachedFile>;
+
+class FileCache {
+    using Clock = std::chrono::steady_clock;
+private:
+    struct Entry {
+        CachedFilePtr file;
+        Clock::time_point checked;
+        std::list<std::string>::iterator lru;
+    };
+
+    std::mutex __mtx;
+    std::list<std::string> __lru; // 头部为最近使用
+    std::unordered_map<std::string, Entry> __entries;
+    size_t __capacity;
+    std::chrono::milliseconds __revalidate;
+
+    static bool SameFile(const CachedFile& cached, const struct stat& st) {
+        return cached.ino == st.st_ino and cached.size == st.st_size
+            and cached.mtime.tv_sec == st.st_mtim.tv_sec and cached.mtime.tv_nsec == st.st_mtim.tv_nsec;
+    }
+
+    static CachedFilePtr OpenFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fd == -1) return nullptr;
+        struct stat st{};
+        if(fstat(fd, &st) == -1 or !S_ISREG(st.st_mode)) {
+            close(fd);
+            return nullptr;
+        }
+        // 静态文件总是顺序读：让内核加大预读窗口
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        auto cached = std::make_shared<CachedFile>();
+        cached->file = std::make_shared<FileDesc>(fd);
+        cached->size = st.st_size;
+        cached->ino = st.st_ino;
+        cached->mtime = st.st_mtim;
+        return cached;
+    }
+
+public:
+    explicit FileCache(size_t capacity = 1024, std::chrono::milliseconds revalidate = std::chrono::milliseconds(1000)) :
+        __capacity(capacity), __revalidate(revalidate) {}
+
+    // 返回nullptr表示文件不存在或不是普通文件
+    CachedFilePtr Open(const std::string& path) {
+        auto now = Clock::now();
+        {
+            std::unique_lock<std::mutex> lock(__mtx);
+            auto it = __entries.find(path);
+            if(it != __entries.end()) {
+                __lru.splice(__lru.begin(), __lru, it->second.lru);
+                if(now - it->second.checked < __revalidate) return it->second.file;
+                struct stat st{};
+                if(stat(path.c_str(), &st) == 0 and SameFile(*it->second.file, st)) {
+                    it->second.checked = now;
+                    return it->second.file;
+                }
+                __lru.erase(it->second.lru);
+                __entries.erase(it);
+            }
+        }
+        // open 可能阻塞在磁盘上，不持锁
+        CachedFilePtr file = OpenFile(path);
+        if(!file) return nullptr;
+        std::unique_lock<std::mutex> lock(__mtx);
+        auto it = __entries.find(path);
+        if(it != __entries.end()) return it->second.file; // 其他线程已抢先打开
+        __lru.push_front(path);
+        __entries.emplace(path, Entry{file, now, __lru.begin()});
+        if(__entries.size() > __capacity) {
+            __entries.erase(__lru.back());
+            __lru.pop_back();
+        }
+        return file;
+    }
+
+    size_t size() {
+        std::unique_lock<std::mutex> lock(__mtx);
+        return __entries.size();
+    }
+};
+
+#endif // FILECACHE_H
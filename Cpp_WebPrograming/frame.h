@@ -0,0 +1,63 @@
+// v2分帧协议：在 send_packet/recv_packet（4字节长度前缀，一问一答）的基础上增加请求id与标志位，
+// 同一连接上可以有多个请求在途，服务端按完成顺序回复，客户端按id匹配响应
+//
+// 帧头16字节（网络字节序）：
+//   magic(1)=0xF2 | flags(1) | reserved(2) | length(4) | request_id(8) | payload(length字节)
+// v1帧以长度的最高字节开头，长度不超过16MB时该字节为0，因此服务端可按连接上的第一个字节区分v1/v2
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <arpa/inet.h>
+#include <endian.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+constexpr uint8_t kFrameMagic = 0xF2;
+constexpr size_t kFrameHeaderSize = 16;
+constexpr uint32_t kFrameMaxPayload = 16 * 1024 * 1024;
+
+// 标志位
+constexpr uint8_t kFrameResponse = 0x01; // 响应帧
+constexpr uint8_t kFrameError = 0x02;    // 响应：请求失败，payload为错误信息
+constexpr uint8_t kFrameOneway = 0x04;   // 请求：不需要响应
+
+struct Frame {
+    uint8_t flags = 0;
+    uint64_t id = 0;
+    std::string_view payload; // 指向解析时的缓冲区
+};
+
+inline void AppendFrame(std::string& out, uint64_t id, uint8_t flags, std::string_view payload)
+{
+    char header[kFrameHeaderSize] = {static_cast<char>(kFrameMagic), static_cast<char>(flags), 0, 0};
+    uint32_t len = htonl(static_cast<uint32_t>(payload.size()));
+    uint64_t rid = htobe64(id);
+    memcpy(header + 4, &len, 4);
+    memcpy(header + 8, &rid, 8);
+    out.append(header, kFrameHeaderSize);
+    out.append(payload);
+}
+
+// 返回 >0：解析出一帧，值为该帧总字节数；0：数据不足；-1：不是合法的v2帧
+inline ssize_t ParseFrame(const char* data, size_t len, Frame& out)
+{
+    if(len < kFrameHeaderSize) return len > 0 and static_cast<uint8_t>(data[0]) != kFrameMagic ? -1 : 0;
+    if(static_cast<uint8_t>(data[0]) != kFrameMagic) return -1;
+    uint32_t payload_len;
+    uint64_t id;
+    memcpy(&payload_len, data + 4, 4);
+    memcpy(&id, data + 8, 8);
+    payload_len = ntohl(payload_len);
+    if(payload_len > kFrameMaxPayload) return -1;
+    if(len < kFrameHeaderSize + payload_len) return 0;
+    out.flags = static_cast<uint8_t>(data[1]);
+    out.id = be64toh(id);
+    out.payload = std::string_view(data + kFrameHeaderSize, payload_len);
+    return static_cast<ssize_t>(kFrameHeaderSize + payload_len);
+}
+
+#endif // FRAME_H
@@ -0,0 +1,213 @@
+// 进程生命周期：SIGINT/SIGTERM 优雅退出，SIGUSR2 热重启
+// 热重启流程：旧进程 fork+exec 自身（可执行文件已被替换时启动的就是新版本），监听fd经socketpair以 SCM_RIGHTS 交给新进程；
+// 新进程事件循环就绪后回写 'R'，旧进程随即停止accept并在deadline内排空连接后退出。
+// 新旧进程持有同一个监听socket（同一个accept队列），交接期间两边都能accept，没有监听空窗，已排队的连接也不会丢
+
+#ifndef HOTRESTART_H
+#define HOTRESTART_H
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "reactor.h"
+
+extern char** environ;
+
+class HotRestart {
+private:
+    static constexpr const char* kEnvName = "CPPBACKEND_HANDOFF_FD";
+    inline static int s_handoff_fd = -1; // 新进程：与旧进程相连的socket，就绪后回写并关闭
+
+    TCPServer& __server;
+    std::vector<std::string> __argv;
+    std::chrono::milliseconds __deadline;
+    SignalWatcher __signals;
+    pid_t __child = -1;
+    int __ctrl_fd = -1; // 旧进程：与新进程相连的socket
+    std::unique_ptr<Channel> __ctrl_channel;
+
+    static bool SendFd(int sock, int fd) {
+        char byte = 'F';
+        iovec iov{&byte, 1};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+        return sendmsg(sock, &msg, MSG_NOSIGNAL) == 1;
+    }
+
+    static int RecvFd(int sock) {
+        char byte;
+        iovec iov{&byte, 1};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if(recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) != 1) return -1;
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        if(!cmsg or cmsg->cmsg_level != SOL_SOCKET or cmsg->cmsg_type != SCM_RIGHTS) return -1;
+        int fd;
+        memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+        return fd;
+    }
+
+    static void NotifyReady() {
+        if(s_handoff_fd == -1) return;
+        char ready = 'R';
+        if(write(s_handoff_fd, &ready, 1) != 1)
+            std::cerr << "[Warning] Failed to notify old process!" << std::endl;
+        close(s_handoff_fd);
+        s_handoff_fd = -1;
+    }
+
+    void CloseControl() {
+        if(__ctrl_fd == -1) return;
+        __server.MainReactor()->DelChannel(__ctrl_channel.get());
+        close(__ctrl_fd);
+        __ctrl_fd = -1;
+        // 本轮事件分发可能仍引用该Channel，延后释放
+        __server.MainReactor()->QueueInLoop([ch = std::shared_ptr<Channel>(std::move(__ctrl_channel))]() {});
+    }
+
+    // 新进程启动失败：回收子进程，旧进程继续服务
+    void ReapChild(int retries) {
+        int status;
+        pid_t ret = waitpid(__child, &status, WNOHANG);
+        if(ret == 0 and retries > 0) {
+            __server.MainReactor()->RunAfter(std::chrono::milliseconds(100), [this, retries]() { ReapChild(retries - 1); });
+            return;
+        }
+        __child = -1;
+    }
+
+    void HandleChildMessage() {
+        char msg = 0;
+        ssize_t n = read(__ctrl_fd, &msg, 1);
+        if(n == -1 and (errno == EAGAIN or errno == EINTR)) return;
+        CloseControl();
+        if(n == 1 and msg == 'R') {
+            std::cout << "[Info] New process " << __child << " is ready, old process " << getpid() << " draining..." << std::endl;
+            __server.GracefulStop(__deadline);
+            return;
+        }
+        std::cerr << "[Warning] New process " << __child << " exited before ready, keep serving." << std::endl;
+        ReapChild(50);
+    }
+
+    void Restart() {
+        if(__child != -1) {
+            std::cout << "[Info] Hot restart already in progress." << std::endl;
+            return;
+        }
+        int sv[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) == -1) {
+            perror("Failed to create handoff socket!");
+            return;
+        }
+        // fork之后到exec之前只能调用异步信号安全函数，参数与环境变量提前准备好
+        std::vector<std::string> env_storage;
+        for(char** e = environ; *e; e++) {
+            if(strncmp(*e, kEnvName, strlen(kEnvName)) != 0) env_storage.emplace_back(*e);
+        }
+        env_storage.push_back(std::string(kEnvName) + "=" + std::to_string(sv[1]));
+        std::vector<char*> envp, argv;
+        for(auto& e : env_storage) envp.push_back(e.data());
+        envp.push_back(nullptr);
+        for(auto& a : __argv) argv.push_back(a.data());
+        argv.push_back(nullptr);
+
+        pid_t pid = fork();
+        if(pid == 0) {
+            fcntl(sv[1], F_SETFD, 0); // 交接socket需要跨越exec
+            sigset_t empty;
+            sigemptyset(&empty);
+            sigprocmask(SIG_SETMASK, &empty, nullptr); // 屏蔽字会被exec继承，恢复默认
+            execvpe(argv[0], argv.data(), envp.data());
+            _exit(127);
+        }
+        close(sv[1]);
+        if(pid == -1) {
+            perror("Failed to fork!");
+            close(sv[0]);
+            return;
+        }
+        __child = pid;
+        __ctrl_fd = sv[0];
+        std::cout << "[Info] Hot restart: spawned new process " << pid << std::endl;
+        if(!SendFd(__ctrl_fd, __server.ListenFd())) {
+            std::cerr << "[Warning] Failed to pass listening socket!" << std::endl;
+        }
+        __ctrl_channel = std::make_unique<Channel>(__ctrl_fd);
+        __ctrl_channel->SetReadCallBack([this]() { HandleChildMessage(); });
+        __server.MainReactor()->AddChannel(__ctrl_channel.get());
+    }
+
+    void HandleSignal(int sig) {
+        if(sig == SIGUSR2) {
+            Restart();
+            return;
+        }
+        std::cout << "\n[Info] Received " << strsignal(sig) << ", shutting down server..." << std::endl;
+        __server.GracefulStop(__deadline);
+    }
+
+public:
+    // 在创建任何线程（构造服务器）之前调用
+    static void BlockSignals() { SignalWatcher::BlockSignals({SIGINT, SIGTERM, SIGUSR2}); }
+
+    // 新进程：若由旧进程拉起，从交接socket接收监听fd；首次启动返回-1（自行bind）
+    static int InheritListenFd() {
+        const char* env = getenv(kEnvName);
+        if(!env) return -1;
+        int sock = atoi(env);
+        unsetenv(kEnvName);
+        fcntl(sock, F_SETFD, FD_CLOEXEC);
+        int fd = RecvFd(sock);
+        if(fd == -1) {
+            std::cerr << "[Warning] Failed to inherit listening socket, binding a new one." << std::endl;
+            close(sock);
+            return -1;
+        }
+        s_handoff_fd = sock;
+        std::cout << "[Info] Inherited listening socket " << fd << " from old process." << std::endl;
+        return fd;
+    }
+
+    HotRestart(TCPServer& server, char* argv[], std::chrono::milliseconds drain_deadline) :
+        __server(server), __deadline(drain_deadline),
+        __signals(server.MainReactor(), {SIGINT, SIGTERM, SIGUSR2}, [this](int sig) { HandleSignal(sig); })
+    {
+        for(char** a = argv; *a; a++) __argv.emplace_back(*a);
+        // 主循环开始运行后再通知旧进程
+        if(s_handoff_fd != -1) __server.MainReactor()->QueueInLoop([]() { NotifyReady(); });
+    }
+
+    ~HotRestart() noexcept {
+        if(__ctrl_fd != -1) {
+            __server.MainReactor()->DelChannel(__ctrl_channel.get());
+            close(__ctrl_fd);
+        }
+    }
+
+    HotRestart(const HotRestart&) = delete;
+    HotRestart& operator=(const HotRestart&) = delete;
+};
+
+#endif // HOTRESTART_H
@@ -0,0 +1,587 @@
+// HTTP/1.1 模块：基于 reactor.h 的 Connection
+// 增量零拷贝解析（状态机直接扫描输入缓冲）、keep-alive、pipelining、chunked响应、路由、sendfile静态文件
+
+#ifndef HTTP_H
+#define HTTP_H
+
+#include <map>
+#include <cstdio>
+#include <cctype>
+#include <charconv>
+
+#include "reactor.h"
+#include "filecache.h"
+
+// 大小写不敏感比较（HTTP头字段名不区分大小写）
+inline bool IEquals(std::string_view a, std::string_view b)
+{
+    if(a.size() != b.size()) return false;
+    for(size_t i = 0; i < a.size(); i++) {
+        if(std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+            return false;
+    }
+    return true;
+}
+
+// 请求：所有字段都是指向连接输入缓冲区的视图，只在处理函数执行期间有效
+struct HttpRequest {
+    std::string_view method;
+    std::string_view target;  // 原始请求目标，如 /index.html?a=1
+    std::string_view path;
+    std::string_view query;
+    std::string_view version; // HTTP/1.0 或 HTTP/1.1
+    std::vector<std::pair<std::string_view, std::string_view>> headers;
+    std::string_view body;
+    bool keep_alive = true;
+
+    std::string_view Header(std::string_view name) const {
+        for(auto& [key, value] : headers) {
+            if(IEquals(key, name)) return value;
+        }
+        return {};
+    }
+};
+
+// 增量解析器：每次收到新数据从上次停下的位置继续扫描，不回头重扫，不拷贝
+// 位置全部记录为相对可读区起点的偏移，Buffer扩容/前移后依然有效
+class HttpParser {
+public:
+    enum class Result { kComplete, kIncomplete, kError };
+
+    static constexpr size_t kMaxHeaderBytes = 8 * 1024;
+    static constexpr size_t kMaxBodyBytes = 8 * 1024 * 1024;
+
+private:
+    enum State { kRequestLine, kHeaders, kBody };
+    using Span = std::pair<size_t, size_t>; // [offset, offset+len)
+
+    State __state = kRequestLine;
+    size_t __pos = 0;            // 下一次扫描的起点
+    size_t __line_begin = 0;     // 当前行起点
+    Span __method{}, __target{}, __version{};
+    std::vector<std::pair<Span, Span>> __headers;
+    size_t __body_start = 0;
+    size_t __content_length = 0;
+    int __error_status = 0;
+    HttpRequest __request;
+
+    static std::string_view View(const char* base, Span span) { return {base + span.first, span.second}; }
+
+    static Span Trim(const char* base, size_t begin, size_t end) {
+        while(begin < end and (base[begin] == ' ' or base[begin] == '\t')) begin++;
+        while(end > begin and (base[end - 1] == ' ' or base[end - 1] == '\t')) end--;
+        return {begin, end - begin};
+    }
+
+    Result Fail(int status) {
+        __error_status = status;
+        return Result::kError;
+    }
+
+    bool ParseRequestLine(const char* base, size_t begin, size_t end) {
+        const char* sp1 = static_cast<const char*>(memchr(base + begin, ' ', end - begin));
+        if(!sp1) return false;
+        size_t p1 = sp1 - base;
+        const char* sp2 = static_cast<const char*>(memchr(base + p1 + 1, ' ', end - p1 - 1));
+        if(!sp2) return false;
+        size_t p2 = sp2 - base;
+        __method = {begin, p1 - begin};
+        __target = {p1 + 1, p2 - p1 - 1};
+        __version = {p2 + 1, end - p2 - 1};
+        std::string_view version = View(base, __version);
+        return __method.second > 0 and __target.second > 0 and version.substr(0, 5) == "HTTP/";
+    }
+
+    bool ParseHeaderLine(const char* base, size_t begin, size_t end) {
+        const char* colon = static_cast<const char*>(memchr(base + begin, ':', end - begin));
+        if(!colon or colon == base + begin) return false;
+        size_t c = colon - base;
+        __headers.push_back({Span{begin, c - begin}, Trim(base, c + 1, end)});
+        return true;
+    }
+
+    // 头部结束：确定请求体长度
+    Result HeadersDone(const char* base) {
+        bool has_length = false;
+        for(auto& [key, value] : __headers) {
+            std::string_view name = View(base, key);
+            std::string_view val = View(base, value);
+            if(IEquals(name, "Transfer-Encoding")) {
+                return Fail(501); // 最小实现：不支持分块上传
+            }
+            if(IEquals(name, "Content-Length")) {
+                size_t length = 0;
+                auto [ptr, ec] = std::from_chars(val.data(), val.data() + val.size(), length);
+                if(ec != std::errc() or ptr != val.data() + val.size()) return Fail(400);
+                // 多个取值不同的Content-Length：与前面的代理对请求边界的理解可能不同（请求走私），拒绝
+                if(has_length and length != __content_length) return Fail(400);
+                if(length > kMaxBodyBytes) return Fail(413);
+                __content_length = length;
+                has_length = true;
+            }
+        }
+        __body_start = __pos;
+        __state = kBody;
+        return Result::kIncomplete;
+    }
+
+    void BuildRequest(const char* base) {
+        __request.method = View(base, __method);
+        __request.target = View(base, __target);
+        __request.version = View(base, __version);
+        size_t q = __request.target.find('?');
+        __request.path = __request.target.substr(0, q);
+        __request.query = q == std::string_view::npos ? std::string_view{} : __request.target.substr(q + 1);
+        __request.headers.clear();
+        for(auto& [key, value] : __headers)
+            __request.headers.emplace_back(View(base, key), View(base, value));
+        __request.body = std::string_view(base + __body_start, __content_length);
+        // HTTP/1.1 默认长连接，HTTP/1.0 需显式 keep-alive
+        std::string_view conn = __request.Header("Connection");
+        if(__request.version == "HTTP/1.0") __request.keep_alive = IEquals(conn, "keep-alive");
+        else __request.keep_alive = !IEquals(conn, "close");
+    }
+
+public:
+    // data/len 为输入缓冲的可读区；返回kComplete时Request()有效，Consumed()为该请求占用的字节数
+    Result Parse(const char* data, size_t len) {
+        while(true) {
+            if(__state == kBody) {
+                if(len - __body_start < __content_length) return Result::kIncomplete;
+                __pos = __body_start + __content_length;
+                BuildRequest(data);
+                return Result::kComplete;
+            }
+            const char* nl = static_cast<const char*>(memchr(data + __pos, '\n', len - __pos));
+            if(!nl) {
+                if(len > kMaxHeaderBytes) return Fail(431);
+                __pos = len;
+                return Result::kIncomplete;
+            }
+            size_t line_begin = __line_begin;
+            size_t line_end = nl - data;
+            __pos = line_end + 1;
+            __line_begin = __pos;
+            if(line_end > line_begin and data[line_end - 1] == '\r') line_end--;
+            if(__pos > kMaxHeaderBytes) return Fail(431);
+
+            if(__state == kRequestLine) {
+                if(line_end == line_begin) continue; // 容忍请求之间多余的空行
+                if(!ParseRequestLine(data, line_begin, line_end)) return Fail(400);
+                __state = kHeaders;
+            } else if(line_end == line_begin) {
+                Result r = HeadersDone(data);
+                if(r == Result::kError) return r;
+            } else if(!ParseHeaderLine(data, line_begin, line_end)) {
+                return Fail(400);
+            }
+        }
+    }
+
+    const HttpRequest& Request() const { return __request; }
+    size_t Consumed() const { return __pos; }
+    int ErrorStatus() const { return __error_status; }
+
+    // 一个请求处理完并从缓冲中取走后调用，准备解析下一个（pipelining）
+    void Reset() {
+        __state = kRequestLine;
+        __pos = 0;
+        __line_begin = 0;
+        __headers.clear();
+        __body_start = 0;
+        __content_length = 0;
+        __error_status = 0;
+    }
+};
+
+inline const char* HttpReason(int status)
+{
+    switch(status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 416: return "Range Not Satisfiable";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 505: return "HTTP Version Not Supported";
+        default: return "Unknown";
+    }
+}
+
+class HttpChunkWriter;
+using HttpChunkWriterPtr = std::shared_ptr<HttpChunkWriter>;
+
+// 响应：普通body、文件（sendfile）或分块流三选一
+class HttpResponse {
+    friend class HttpServer;
+private:
+    int __status = 200;
+    std::vector<std::pair<std::string, std::string>> __headers;
+    std::string __body;
+    FileDescPtr __file;
+    off_t __file_off = 0;
+    size_t __file_len = 0;
+    bool __chunked = false;
+    bool __close = false;
+    HttpChunkWriterPtr __writer;
+
+public:
+    void SetStatus(int status) { __status = status; }
+    int Status() const { return __status; }
+    void SetHeader(std::string name, std::string value) { __headers.emplace_back(std::move(name), std::move(value)); }
+    void SetContentType(std::string type) { SetHeader("Content-Type", std::move(type)); }
+    void SetBody(std::string body) { __body = std::move(body); }
+    void SetCloseConnection(bool close) { __close = close; }
+
+    // 文件区间由连接以sendfile发送，不经过用户态
+    void SetFile(FileDescPtr file, off_t offset, size_t len) {
+        __file = std::move(file);
+        __file_off = offset;
+        __file_len = len;
+    }
+
+    // 开启分块传输：处理函数返回后先发出响应头，之后可在任意线程通过writer逐块写出
+    // 流结束(End)前同一连接上后续pipelined请求暂不处理，保证响应顺序
+    HttpChunkWriterPtr StartChunked();
+};
+
+// 连接上的HTTP状态，存放于 Connection::Context()
+struct HttpSession {
+    HttpParser parser;
+    bool streaming = false;   // 分块响应进行中，暂停解析
+    bool close_after = false; // 当前流结束后关闭连接
+    bool draining = false;    // 服务器优雅退出中：下一个响应带 Connection: close
+};
+using HttpSessionPtr = std::shared_ptr<HttpSession>;
+
+class HttpChunkWriter : public std::enable_shared_from_this<HttpChunkWriter> {
+    friend class HttpServer;
+    friend class HttpResponse;
+private:
+    std::mutex __mtx;
+    bool __attached = false;  // 响应头是否已发出
+    std::weak_ptr<Connection> __conn;
+    HttpSessionPtr __session;
+    std::function<void(const ConnectionPtr&)> __on_end; // 由HttpServer设置：恢复处理缓冲中的请求
+    bool __ended = false;
+    std::string __pending; // 响应头发出前写入的块
+
+    // 发出响应头后由HttpServer调用：补发之前缓存的块，若流已结束则一并收尾
+    void Attach(const ConnectionPtr& conn) {
+        std::unique_lock<std::mutex> lock(__mtx);
+        __attached = true;
+        __conn = conn;
+        if(!__pending.empty()) conn->Send(std::move(__pending));
+        if(__ended) Finish(conn);
+    }
+
+    void Finish(const ConnectionPtr& conn) {
+        conn->Send("0\r\n\r\n");
+        // 总是入队执行，避免在ProcessRequests内部重入
+        conn->GetLoop()->QueueInLoop([self = shared_from_this(), conn]() {
+            self->__session->streaming = false;
+            if(self->__on_end) self->__on_end(conn);
+        });
+    }
+
+public:
+    // 写出一块，可在任意线程调用；空串会被忽略（空块表示流结束）
+    void Write(std::string_view chunk) {
+        if(chunk.empty()) return;
+        char size_line[32];
+        int n = snprintf(size_line, sizeof(size_line), "%zx\r\n", chunk.size());
+        std::string frame;
+        frame.reserve(n + chunk.size() + 2);
+        frame.append(size_line, n).append(chunk).append("\r\n");
+        std::unique_lock<std::mutex> lock(__mtx);
+        if(__ended) return;
+        if(!__attached) __pending.append(frame);
+        else if(ConnectionPtr conn = __conn.lock()) conn->Send(std::move(frame));
+    }
+
+    void End() {
+        std::unique_lock<std::mutex> lock(__mtx);
+        if(__ended) return;
+        __ended = true;
+        if(!__attached) return;
+        if(ConnectionPtr conn = __conn.lock()) Finish(conn);
+    }
+};
+
+inline HttpChunkWriterPtr HttpResponse::StartChunked()
+{
+    __chunked = true;
+    __writer = std::make_shared<HttpChunkWriter>();
+    return __writer;
+}
+
+using HttpHandler = std::function<void(const HttpRequest&, HttpResponse&)>;
+
+// 路由：精确路径 + 方法匹配，另支持前缀映射到静态目录
+// 解析单区间 Range: bytes=a-b / bytes=a- / bytes=-n
+// 返回 1 表示有效区间（写入start/length），0 表示无Range或不支持的形式（按整文件返回），-1 表示不可满足(416)
+inline int ParseRange(std::string_view header, off_t size, off_t& start, off_t& length)
+{
+    if(header.substr(0, 6) != "bytes=") return 0;
+    std::string_view spec = header.substr(6);
+    if(spec.find(',') != std::string_view::npos) return 0; // 多区间：按RFC允许直接返回整个文件
+    size_t dash = spec.find('-');
+    if(dash == std::string_view::npos) return 0;
+    std::string_view first = spec.substr(0, dash), last = spec.substr(dash + 1);
+    auto to_num = [](std::string_view str, off_t& out) {
+        auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), out);
+        return ec == std::errc() and ptr == str.data() + str.size();
+    };
+    off_t a = 0, b = 0;
+    if(first.empty()) {
+        // 后缀区间：最后n个字节
+        if(!to_num(last, b) or b <= 0) return last.empty() ? 0 : -1;
+        if(size == 0) return -1;
+        start = size - std::min(b, size);
+        length = size - start;
+        return 1;
+    }
+    if(!to_num(first, a)) return 0;
+    if(a >= size) return -1;
+    if(last.empty()) b = size - 1;
+    else if(!to_num(last, b) or b < a) return 0;
+    b = std::min(b, size - 1);
+    start = a;
+    length = b - a + 1;
+    return 1;
+}
+
+class Router {
+private:
+    // std::less<> 支持直接用string_view查找，免去每个请求构造std::string
+    std::map<std::string, std::map<std::string, HttpHandler, std::less<>>, std::less<>> __routes;
+    std::vector<std::pair<std::string, std::string>> __static_dirs; // URL前缀 -> 本地目录
+    mutable FileCache __file_cache;
+
+    static std::string_view MimeType(std::string_view path) {
+        size_t dot = path.rfind('.');
+        std::string_view ext = dot == std::string_view::npos ? std::string_view{} : path.substr(dot + 1);
+        if(ext == "html" or ext == "htm") return "text/html; charset=utf-8";
+        if(ext == "css") return "text/css";
+        if(ext == "js") return "application/javascript";
+        if(ext == "json") return "application/json";
+        if(ext == "txt" or ext == "md") return "text/plain; charset=utf-8";
+        if(ext == "png") return "image/png";
+        if(ext == "jpg" or ext == "jpeg") return "image/jpeg";
+        if(ext == "svg") return "image/svg+xml";
+        return "application/octet-stream";
+    }
+
+    // 拒绝包含 .. 段的路径，防止越出静态目录
+    static bool SafePath(std::string_view rel) {
+        size_t start = 0;
+        while(start <= rel.size()) {
+            size_t slash = rel.find('/', start);
+            std::string_view seg = rel.substr(start, slash == std::string_view::npos ? std::string_view::npos : slash - start);
+            if(seg == "..") return false;
+            if(slash == std::string_view::npos) break;
+            start = slash + 1;
+        }
+        return true;
+    }
+
+    bool ServeStatic(const HttpRequest& req, HttpResponse& resp) const {
+        for(auto& [prefix, root] : __static_dirs) {
+            if(req.path.substr(0, prefix.size()) != prefix) continue;
+            if(req.method != "GET" and req.method != "HEAD") {
+                resp.SetStatus(405);
+                resp.SetHeader("Allow", "GET, HEAD");
+                return true;
+            }
+            std::string_view rel = req.path.substr(prefix.size());
+            if(!SafePath(rel)) {
+                resp.SetStatus(403);
+                return true;
+            }
+            std::string file_path = root + "/" + std::string(rel);
+            if(file_path.back() == '/') file_path += "index.html";
+            CachedFilePtr cached = __file_cache.Open(file_path);
+            if(!cached) {
+                resp.SetStatus(404);
+                return true;
+            }
+            resp.SetContentType(std::string(MimeType(file_path)));
+            resp.SetHeader("Accept-Ranges", "bytes");
+            off_t start = 0, length = cached->size;
+            int range = ParseRange(req.Header("Range"), cached->size, start, length);
+            if(range < 0) {
+                resp.SetStatus(416);
+                resp.SetHeader("Content-Range", "bytes */" + std::to_string(cached->size));
+                return true;
+            }
+            if(range > 0) {
+                resp.SetStatus(206);
+                resp.SetHeader("Content-Range", "bytes " + std::to_string(start) + "-" +
+                               std::to_string(start + length - 1) + "/" + std::to_string(cached->size));
+            }
+            resp.SetFile(cached->file, start, length);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    void Handle(std::string method, std::string path, HttpHandler handler) {
+        __routes[std::move(path)][std::move(method)] = std::move(handler);
+    }
+    void Get(std::string path, HttpHandler handler) { Handle("GET", std::move(path), std::move(handler)); }
+    void Post(std::string path, HttpHandler handler) { Handle("POST", std::move(path), std::move(handler)); }
+    void Static(std::string prefix, std::string root) { __static_dirs.emplace_back(std::move(prefix), std::move(root)); }
+
+    void Dispatch(const HttpRequest& req, HttpResponse& resp) const {
+        auto it = __routes.find(req.path);
+        if(it != __routes.end()) {
+            auto handler = it->second.find(req.method);
+            // HEAD 复用 GET 的处理函数，序列化时丢弃body
+            if(handler == it->second.end() and req.method == "HEAD") handler = it->second.find("GET");
+            if(handler != it->second.end()) {
+                handler->second(req, resp);
+                return;
+            }
+            std::string allow;
+            for(auto& [method, h] : it->second) allow += (allow.empty() ? "" : ", ") + method;
+            resp.SetStatus(405);
+            resp.SetHeader("Allow", allow);
+            return;
+        }
+        if(ServeStatic(req, resp)) return;
+        resp.SetStatus(404);
+    }
+};
+
+class HttpServer {
+private:
+    static constexpr std::chrono::milliseconds kDrainIdleGrace{200};
+
+    TCPServer __server;
+    Router __router;
+    FileTransfer __file_transfer = FileTransfer::kSendfile;
+
+    void OnConnection(const ConnectionPtr& conn) {
+        if(!conn->Connected()) return;
+        conn->SetContext(std::make_shared<HttpSession>());
+        conn->SetFileTransfer(__file_transfer);
+    }
+
+    void OnMessage(const ConnectionPtr& conn, Buffer* buf) {
+        auto session = std::any_cast<HttpSessionPtr>(conn->Context());
+        ProcessRequests(conn, session, buf);
+    }
+
+    // 依次处理缓冲中所有完整请求（pipelining），响应按请求顺序写入输出队列
+    void ProcessRequests(const ConnectionPtr& conn, const HttpSessionPtr& session, Buffer* buf) {
+        while(!session->streaming and conn->Connected() and buf->ReadableBytes() > 0) {
+            HttpParser& parser = session->parser;
+            HttpParser::Result result = parser.Parse(buf->Peek(), buf->ReadableBytes());
+            if(result == HttpParser::Result::kIncomplete) return;
+            if(result == HttpParser::Result::kError) {
+                HttpResponse resp;
+                resp.SetStatus(parser.ErrorStatus());
+                resp.SetCloseConnection(true);
+                SendResponse(conn, session, "GET", "HTTP/1.1", resp);
+                buf->RetrieveAll();
+                conn->Shutdown();
+                return;
+            }
+            const HttpRequest& req = parser.Request();
+            HttpResponse resp;
+            if(req.version != "HTTP/1.1" and req.version != "HTTP/1.0") {
+                resp.SetStatus(505);
+                resp.SetCloseConnection(true);
+            } else {
+                __router.Dispatch(req, resp);
+                if(!req.keep_alive or session->draining) resp.SetCloseConnection(true);
+            }
+            SendResponse(conn, session, req.method, req.version, resp);
+            buf->Retrieve(parser.Consumed());
+            parser.Reset();
+            if(resp.__close) {
+                if(session->streaming) session->close_after = true;
+                else conn->Shutdown();
+                return;
+            }
+        }
+    }
+
+    // 优雅退出：处理中的连接在下一个响应后关闭（Connection: close）；
+    // 空闲连接等待一个短暂宽限期再关闭，避免与客户端正在发出的keep-alive请求竞争
+    void OnDrain(const ConnectionPtr& conn) {
+        auto session = std::any_cast<HttpSessionPtr>(conn->Context());
+        session->draining = true;
+        std::weak_ptr<Connection> weak = conn;
+        conn->GetLoop()->RunAfter(kDrainIdleGrace, [weak, session]() {
+            ConnectionPtr c = weak.lock();
+            if(c and c->Connected() and !session->streaming and c->InputBuffer()->ReadableBytes() == 0) c->Shutdown();
+        });
+    }
+
+    void SendResponse(const ConnectionPtr& conn, const HttpSessionPtr& session, std::string_view method,
+                      std::string_view version, HttpResponse& resp) {
+        std::string head;
+        head.reserve(256);
+        head.append("HTTP/1.1 ").append(std::to_string(resp.__status)).append(" ").append(HttpReason(resp.__status)).append("\r\n");
+        head.append("Server: CppBackend\r\n");
+        for(auto& [name, value] : resp.__headers) head.append(name).append(": ").append(value).append("\r\n");
+        if(resp.__close) head.append("Connection: close\r\n");
+        else if(version == "HTTP/1.0") head.append("Connection: keep-alive\r\n"); // 1.0客户端默认短连接，要显式确认
+
+        bool head_only = method == "HEAD";
+        if(resp.__chunked) {
+            head.append("Transfer-Encoding: chunked\r\n\r\n");
+            conn->Send(std::move(head));
+            if(head_only) {
+                conn->Send("0\r\n\r\n");
+                return;
+            }
+            HttpChunkWriterPtr writer = resp.__writer;
+            writer->__session = session;
+            writer->__on_end = [this, session](const ConnectionPtr& c) {
+                if(session->close_after) c->Shutdown();
+                else ProcessRequests(c, session, c->InputBuffer());
+            };
+            session->streaming = true;
+            writer->Attach(conn);
+            return;
+        }
+
+        size_t length = resp.__file ? resp.__file_len : resp.__body.size();
+        head.append("Content-Length: ").append(std::to_string(length)).append("\r\n\r\n");
+        if(!head_only and !resp.__file) head.append(resp.__body);
+        conn->Send(std::move(head));
+        if(!head_only and resp.__file) conn->SendFile(std::move(resp.__file), resp.__file_off, resp.__file_len);
+    }
+
+public:
+    HttpServer(uint16_t port, int sub_reactor_num = 4, int work_threads = 4, int listenfd = -1) :
+        __server(port, sub_reactor_num, work_threads, listenfd)
+    {
+        __server.SetConnectionCallback([this](const ConnectionPtr& conn) { OnConnection(conn); });
+        __server.SetMessageCallback([this](const ConnectionPtr& conn, Buffer* buf) { OnMessage(conn, buf); });
+        __server.SetDrainCallback([this](const ConnectionPtr& conn) { OnDrain(conn); });
+    }
+
+    Router& router() { return __router; }
+    // 静态文件的零拷贝方式，需在start()之前设置
+    void SetFileTransfer(FileTransfer mode) { __file_transfer = mode; }
+    ThreadPool& WorkPool() { return __server.WorkPool(); }
+    TCPServer& tcp() { return __server; }
+
+    void start() { __server.start(); }
+    void stop() { __server.stop(); }
+};
+
+#endif // HTTP_H
@@ -0,0 +1,36 @@
+#!/bin/bash
+# http_bench.sh
+# 编译 http_server 与 loadgen，本机启动服务器后用 loadgen 压测（wrk风格输出）
+cd "$(dirname "$0")"
+
+PORT=8080
+DURATION=${DURATION:-5}
+THREADS=${THREADS:-2}
+
+mkdir -p output
+g++ -std=c++17 -O2 -pthread http_server.cpp -o output/http_server || exit 1
+g++ -std=c++17 -O2 -pthread loadgen.cpp -o output/loadgen || exit 1
+
+# 静态文件测试数据
+STATIC_DIR=$(mktemp -d)
+head -c 1024 /dev/urandom > "$STATIC_DIR/1k.bin"
+head -c $((1024 * 1024)) /dev/urandom > "$STATIC_DIR/1m.bin"
+
+./output/http_server $PORT "$STATIC_DIR" > /dev/null &
+SERVER_PID=$!
+sleep 0.5
+
+run() {
+    echo -e "\n=== $* ==="
+    ./output/loadgen -p $PORT -t $THREADS -d $DURATION "$@"
+}
+
+run -c 64 -u /
+run -c 64 -D 16 -u /                 # pipelining
+run -c 256 -u /
+run -c 64 -u /static/1k.bin          # sendfile 小文件
+run -c 16 -u /static/1m.bin          # sendfile 大文件
+
+kill $SERVER_PID
+wait $SERVER_PID 2>/dev/null
+rm -rf "$STATIC_DIR"
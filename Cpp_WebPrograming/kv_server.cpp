@@ -0,0 +1,60 @@
+// 分片KV缓存服务器：每个从Reactor独占一个分片，二进制协议见 kvstore.h
+// 用法: ./kv_server [port] [shards] [内存上限MB，默认64] [数据目录] [always|interval|none] [同步间隔ms，默认10]
+// 给出数据目录时开启持久化（WAL，见 kvwal.h），修改落盘后才回复
+// SIGINT/SIGTERM：优雅退出；SIGUSR2：热重启（开启持久化时不支持：新进程回放日志时旧进程仍在写入）
+#include <iostream>
+#include <optional>
+#include <string>
+#include <chrono>
+
+#include "kvstore.h"
+#include "hotrestart.h"
+
+int main(int argc, char* argv[])
+{
+    signal(SIGPIPE, SIG_IGN);
+    HotRestart::BlockSignals(); // 必须在创建任何线程之前
+
+    uint16_t port = argc > 1 ? static_cast<uint16_t>(std::stoi(argv[1])) : 6380;
+    int shards = argc > 2 ? std::stoi(argv[2]) : 4;
+    size_t memory_mb = argc > 3 ? std::stoul(argv[3]) : KvServer::kDefaultMemoryLimit >> 20;
+    std::optional<WalOptions> wal;
+    if(argc > 4) {
+        wal.emplace();
+        wal->dir = argv[4];
+        std::string sync = argc > 5 ? argv[5] : "always";
+        if(sync == "none") wal->sync = WalSync::kNone;
+        else if(sync == "interval") wal->sync = WalSync::kInterval;
+        else if(sync != "always") {
+            std::cerr << "Unknown sync policy: " << sync << std::endl;
+            return 1;
+        }
+        if(argc > 6) wal->interval = std::chrono::milliseconds(std::stoi(argv[6]));
+    }
+
+    try {
+        KvServer server(port, shards, wal ? -1 : HotRestart::InheritListenFd());
+        server.tcp().SetMaxConnections(10000);
+        server.SetMemoryLimit(memory_mb << 20);
+        std::optional<HotRestart> lifecycle;
+        std::optional<SignalWatcher> term;
+        if(wal) {
+            auto start = std::chrono::steady_clock::now();
+            size_t records = server.EnableWal(*wal);
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "[Info] Replayed " << records << " records from " << wal->dir << " in " << ms << "ms" << std::endl;
+            TCPServer& tcp = server.tcp();
+            term.emplace(tcp.MainReactor(), std::initializer_list<int>{SIGINT, SIGTERM}, [&tcp](int) {
+                tcp.GracefulStop(std::chrono::seconds(5));
+            });
+        } else {
+            lifecycle.emplace(server.tcp(), argv, std::chrono::seconds(5));
+        }
+        std::cout << "[Info] KV server started on port " << port << " with " << shards << " shards, " << memory_mb << "MB, pid " << getpid() << std::endl;
+        server.start();
+        std::cout << "[Info] Final stats:\n" << server.StatsText();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,894 @@
+// 分片内存KV缓存：每个从Reactor独占一个分片（shared-nothing，分片内无锁）
+// 连接上的请求按key哈希到目标分片：落在本连接所属分片的直接执行，
+// 其他分片的请求按目标分片攒批，经目标loop的任务队列转发执行，结果再投递回连接所属loop，按请求顺序回复
+//
+// 内存：每个分片有独立的内存预算，条目按大小分级（slab class，相邻级别相差1.25倍）从1MB的页中切分，
+// 预算用尽时先在同级别内按分段LRU淘汰，同级别无条目可淘汰时从占页最多的级别整页回收。
+// 过期：条目可带TTL，由分片所属loop的定时器驱动时间轮回收，访问时也会检查（精度为一个tick）。
+// 持久化（可选，EnableWal）：修改在分片loop中生效并生成日志记录，一次任务的记录整体提交给WAL的I/O线程，
+// 组提交落盘后才回复客户端（见 kvwal.h）；淘汰与过期不写日志，回放时按预算与过期时间重新处理。
+//
+// 协议（与 send_packet/recv_packet 相同的4字节网络序长度前缀分帧）：
+//   请求体：op(1字节) | key长度(2字节，网络序) | key | value（SET时为帧内剩余部分）
+//           SETEX 在key之后多一个TTL（4字节网络序，毫秒），其后为value；STATS的key为空
+//   响应体：status(1字节) | value（GET命中时；STATS时为"名称 数值"的文本行）
+//   op：1=GET 2=SET 3=DEL 4=SETEX 5=STATS；status：0=OK 1=NOT_FOUND 2=ERROR（含条目过大、内存不足）
+
+#ifndef KVSTORE_H
+#define KVSTORE_H
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "reactor.h"
+#include "kvwal.h"
+
+enum class KvOp : uint8_t { kGet = 1, kSet = 2, kDel = 3, kSetEx = 4, kStats = 5 };
+enum class KvStatus : uint8_t { kOk = 0, kNotFound = 1, kError = 2 };
+
+inline uint64_t KvHash(std::string_view key)
+{
+    // 再混合一次，使分片选择(高位)与表内定位(低位)所用的位相互独立
+    uint64_t h = std::hash<std::string_view>{}(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+// 条目头部与key、value连续存放在同一个slab块中；LRU与时间轮的链表指针都内嵌在头部
+struct KvItem {
+    static constexpr uint8_t kLinked = 1;    // 已在表中（整页回收时据此找出存活条目）
+    static constexpr uint8_t kProtected = 2; // 位于LRU保护段
+
+    KvItem* lru_prev = nullptr;
+    KvItem* lru_next = nullptr;
+    KvItem* tw_prev = nullptr;
+    KvItem* tw_next = nullptr;
+    uint64_t hash = 0;
+    int64_t expire_at = 0; // 过期时间（分片时钟，毫秒），0表示不过期
+    uint32_t value_len = 0;
+    uint32_t tw_slot = 0;
+    uint16_t key_len = 0;
+    uint8_t cls = 0;
+    uint8_t flags = 0;
+
+    char* Data() { return reinterpret_cast<char*>(this + 1); }
+    const char* Data() const { return reinterpret_cast<const char*>(this + 1); }
+    std::string_view Key() const { return std::string_view(Data(), key_len); }
+    std::string_view Value() const { return std::string_view(Data() + key_len, value_len); }
+    size_t TotalSize() const { return sizeof(KvItem) + key_len + value_len; }
+};
+
+// slab分配器：内存按1MB页申请，每页归属一个级别并切成等长块；页数受预算限制
+class KvSlabAllocator {
+public:
+    static constexpr size_t kPageSize = 1 << 20;
+    static constexpr size_t kMinChunk = 96;
+    static constexpr double kGrowth = 1.25;
+
+private:
+    struct SlabClass {
+        size_t chunk_size;
+        size_t pages = 0;
+        std::vector<char*> free;
+    };
+    struct Page {
+        std::unique_ptr<char[]> mem;
+        uint8_t cls;
+    };
+
+    std::vector<SlabClass> __classes;
+    std::vector<Page> __pages;
+    size_t __max_pages = 1;
+
+    // 把一页切成块放入空闲链表；块头清零，标记为未使用
+    void Carve(Page& page, uint8_t cls) {
+        SlabClass& c = __classes[cls];
+        page.cls = cls;
+        c.pages++;
+        size_t count = kPageSize / c.chunk_size;
+        for(size_t i = count; i-- > 0;) {
+            char* chunk = page.mem.get() + i * c.chunk_size;
+            new (chunk) KvItem();
+            c.free.push_back(chunk);
+        }
+    }
+
+public:
+    explicit KvSlabAllocator(size_t limit) {
+        for(size_t size = kMinChunk; size < kPageSize; size = (static_cast<size_t>(size * kGrowth) + 7) & ~size_t(7))
+            __classes.push_back(SlabClass{size, 0, {}});
+        __classes.push_back(SlabClass{kPageSize, 0, {}});
+        SetLimit(limit);
+    }
+
+    // 至少保留一页；缩小预算不会释放已申请的页
+    void SetLimit(size_t limit) { __max_pages = std::max<size_t>(limit / kPageSize, 1); }
+    size_t Limit() const { return __max_pages * kPageSize; }
+    size_t AllocatedBytes() const { return __pages.size() * kPageSize; }
+    size_t ClassCount() const { return __classes.size(); }
+    size_t ChunkSize(uint8_t cls) const { return __classes[cls].chunk_size; }
+
+    // 能容纳bytes字节的最小级别，超过一页返回-1
+    int ClassOf(size_t bytes) const {
+        auto it = std::lower_bound(__classes.begin(), __classes.end(), bytes,
+                                   [](const SlabClass& c, size_t n) { return c.chunk_size < n; });
+        return it == __classes.end() ? -1 : static_cast<int>(it - __classes.begin());
+    }
+
+    // 空闲块或预算内的新页；都没有时返回nullptr，由调用者淘汰后重试
+    char* Alloc(uint8_t cls) {
+        SlabClass& c = __classes[cls];
+        if(c.free.empty()) {
+            if(__pages.size() >= __max_pages) return nullptr;
+            __pages.push_back(Page{std::unique_ptr<char[]>(new char[kPageSize]), cls});
+            Carve(__pages.back(), cls);
+        }
+        char* chunk = c.free.back();
+        c.free.pop_back();
+        return chunk;
+    }
+
+    void Free(uint8_t cls, char* chunk) { __classes[cls].free.push_back(chunk); }
+
+    // 占页最多的级别
+    uint8_t LargestClass() const {
+        size_t best = 0;
+        for(size_t i = 1; i < __classes.size(); i++) {
+            if(__classes[i].pages > __classes[best].pages) best = i;
+        }
+        return static_cast<uint8_t>(best);
+    }
+
+    // 把from级别的最后一页转给to级别：页内存活条目先交给evict回收（evict需调用Free），再整页重新切分
+    template <typename Evict>
+    bool MovePage(uint8_t from, uint8_t to, Evict evict) {
+        auto it = std::find_if(__pages.rbegin(), __pages.rend(), [from](const Page& p) { return p.cls == from; });
+        if(it == __pages.rend() or from == to) return false;
+        char* begin = it->mem.get();
+        char* end = begin + kPageSize;
+        size_t chunk_size = __classes[from].chunk_size;
+        for(char* chunk = begin; chunk + chunk_size <= end; chunk += chunk_size) {
+            KvItem* item = reinterpret_cast<KvItem*>(chunk);
+            if(item->flags & KvItem::kLinked) evict(item);
+        }
+        auto& free = __classes[from].free;
+        free.erase(std::remove_if(free.begin(), free.end(), [begin, end](char* p) { return p >= begin and p < end; }), free.end());
+        __classes[from].pages--;
+        Carve(*it, to);
+        return true;
+    }
+};
+
+// 开放寻址哈希表（SwissTable布局）：每个槽位一个控制字节，空/删除为负数，占用时存哈希低7位；
+// 查找时一次比较16个控制字节（SSE2），只有控制字节匹配的槽位才比较key。
+// 槽位只存条目指针，条目本身在slab中，扩容时用条目里保存的哈希，无需重新计算
+class KvTable {
+private:
+    static constexpr int8_t kEmpty = -128;
+    static constexpr int8_t kDeleted = -2;
+    static constexpr size_t kGroupWidth = 16;
+
+    // 16个控制字节一组，返回匹配位置的位掩码
+    struct Group {
+#if defined(__SSE2__)
+        __m128i ctrl;
+        explicit Group(const int8_t* p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+        uint32_t Match(int8_t h2) const { return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)); }
+        uint32_t MatchEmpty() const { return Match(kEmpty); }
+        uint32_t MatchFree() const { return _mm_movemask_epi8(ctrl); } // 空或删除：最高位为1
+#else
+        const int8_t* ctrl;
+        explicit Group(const int8_t* p) : ctrl(p) {}
+        uint32_t Match(int8_t h2) const {
+            uint32_t mask = 0;
+            for(size_t i = 0; i < kGroupWidth; i++) mask |= static_cast<uint32_t>(ctrl[i] == h2) << i;
+            return mask;
+        }
+        uint32_t MatchEmpty() const { return Match(kEmpty); }
+        uint32_t MatchFree() const {
+            uint32_t mask = 0;
+            for(size_t i = 0; i < kGroupWidth; i++) mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+            return mask;
+        }
+#endif
+    };
+
+    // 控制字节数组尾部额外复制前16个字节，跨越末尾的组也能一次读出
+    std::vector<int8_t> __ctrl;
+    std::vector<KvItem*> __slots;
+    size_t __mask = 0;
+    size_t __size = 0;
+    size_t __tombstones = 0;
+
+    static size_t H1(uint64_t hash) { return hash >> 7; }
+    static int8_t H2(uint64_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+
+    void SetCtrl(size_t idx, int8_t value) {
+        __ctrl[idx] = value;
+        __ctrl[((idx - kGroupWidth) & __mask) + kGroupWidth] = value;
+    }
+
+    // 按组做三角数探测（步长16、32、48...），容量为2的幂时可遍历全部组；
+    // 负载不超过7/8保证总有空槽位，探测必然终止
+    template <typename Pred>
+    size_t Probe(uint64_t hash, Pred match) const {
+        if(__slots.empty()) return SIZE_MAX;
+        int8_t h2 = H2(hash);
+        size_t pos = H1(hash) & __mask;
+        for(size_t step = kGroupWidth;; step += kGroupWidth) {
+            Group g(&__ctrl[pos]);
+            for(uint32_t bits = g.Match(h2); bits; bits &= bits - 1) {
+                size_t idx = (pos + __builtin_ctz(bits)) & __mask;
+                if(match(__slots[idx])) return idx;
+            }
+            if(g.MatchEmpty()) return SIZE_MAX;
+            pos = (pos + step) & __mask;
+        }
+    }
+
+    size_t FindFree(uint64_t hash) const {
+        size_t pos = H1(hash) & __mask;
+        for(size_t step = kGroupWidth;; step += kGroupWidth) {
+            uint32_t bits = Group(&__ctrl[pos]).MatchFree();
+            if(bits) return (pos + __builtin_ctz(bits)) & __mask;
+            pos = (pos + step) & __mask;
+        }
+    }
+
+    void Rehash(size_t capacity) {
+        std::vector<int8_t> old_ctrl = std::move(__ctrl);
+        std::vector<KvItem*> old_slots = std::move(__slots);
+        __ctrl.assign(capacity + kGroupWidth, kEmpty);
+        __slots.assign(capacity, nullptr);
+        __mask = capacity - 1;
+        __tombstones = 0;
+        for(size_t i = 0; i < old_slots.size(); i++) {
+            if(old_ctrl[i] < 0) continue;
+            size_t idx = FindFree(old_slots[i]->hash);
+            SetCtrl(idx, H2(old_slots[i]->hash));
+            __slots[idx] = old_slots[i];
+        }
+    }
+
+public:
+    size_t size() const { return __size; }
+    size_t capacity() const { return __slots.size(); }
+    size_t MemoryBytes() const { return __ctrl.size() + __slots.size() * sizeof(KvItem*); }
+
+    KvItem* Find(std::string_view key, uint64_t hash) const {
+        size_t idx = Probe(hash, [&](const KvItem* item) { return item->hash == hash and item->Key() == key; });
+        return idx == SIZE_MAX ? nullptr : __slots[idx];
+    }
+
+    // 调用者保证key不在表中
+    void Insert(KvItem* item) {
+        // 负载（含删除标记）超过7/8时扩容；删除标记占多数时原容量重建即可
+        if((__size + __tombstones + 1) * 8 > capacity() * 7) {
+            size_t cap = capacity() ? capacity() : kGroupWidth;
+            Rehash(__size * 2 + 2 > cap ? cap * 2 : cap);
+        }
+        size_t idx = FindFree(item->hash);
+        if(__ctrl[idx] == kDeleted) __tombstones--;
+        SetCtrl(idx, H2(item->hash));
+        __slots[idx] = item;
+        __size++;
+    }
+
+    void Erase(const KvItem* item) {
+        size_t idx = Probe(item->hash, [item](const KvItem* slot) { return slot == item; });
+        if(idx == SIZE_MAX) return;
+        SetCtrl(idx, kDeleted);
+        __slots[idx] = nullptr;
+        __size--;
+        __tombstones++;
+    }
+};
+
+// 内嵌指针的双向链表，表头为最近使用
+struct KvLruList {
+    KvItem* head = nullptr;
+    KvItem* tail = nullptr;
+    size_t size = 0;
+
+    void PushFront(KvItem* item) {
+        item->lru_prev = nullptr;
+        item->lru_next = head;
+        if(head) head->lru_prev = item;
+        else tail = item;
+        head = item;
+        size++;
+    }
+    void Remove(KvItem* item) {
+        if(item->lru_prev) item->lru_prev->lru_next = item->lru_next;
+        else head = item->lru_next;
+        if(item->lru_next) item->lru_next->lru_prev = item->lru_prev;
+        else tail = item->lru_prev;
+        item->lru_prev = item->lru_next = nullptr;
+        size--;
+    }
+};
+
+// 分片计数器：只有分片所属loop写入（单写者，load+store即可，不需要原子RMW），STATS可在任意线程读取
+struct KvCacheStats {
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> sets{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> expired{0};
+    std::atomic<uint64_t> rejected{0};    // 条目过大或内存不足而未写入
+    std::atomic<uint64_t> page_moves{0};
+    std::atomic<uint64_t> items{0};
+    std::atomic<uint64_t> bytes_data{0};  // 条目实际字节数（头部+key+value）
+    std::atomic<uint64_t> bytes_used{0};  // 条目占用的slab块字节数，与bytes_data之差为块内碎片
+    std::atomic<uint64_t> bytes_allocated{0};
+    std::atomic<uint64_t> bytes_index{0};
+    std::atomic<uint64_t> bytes_limit{0};
+
+    static void Add(std::atomic<uint64_t>& counter, int64_t delta = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+};
+
+// 一个分片的缓存：哈希表索引 + slab存储 + 每级别分段LRU + TTL时间轮，只由所属loop线程访问
+class KvCache {
+public:
+    static constexpr int64_t kTickMs = 100;
+
+private:
+    static constexpr size_t kWheelSlots = 1024; // 一圈约102秒，更长的TTL在槽位中多停留几圈
+    static constexpr size_t kProtectedPercent = 80;
+
+    // 分段LRU：新条目进入试用段，再次命中才晋升保护段；保护段超出比例时尾部降回试用段，
+    // 淘汰总是先取试用段尾部，一次性扫描的key不会冲掉反复访问的热点
+    struct ClassLru {
+        KvLruList probation;
+        KvLruList protect;
+    };
+
+    KvTable __table;
+    KvSlabAllocator __slab;
+    std::vector<ClassLru> __lru;
+    std::vector<KvItem*> __wheel;
+    int64_t __now;        // 分片粗粒度时钟，每个tick更新
+    int64_t __wheel_tick; // 时间轮已处理到的tick
+    KvCacheStats __stats;
+
+    static int64_t NowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool Expired(const KvItem* item) const { return item->expire_at != 0 and item->expire_at <= __now; }
+
+    void WheelAdd(KvItem* item) {
+        // 放入到期时刻向上取整所在的tick，处理该tick时条目必定已到期
+        int64_t tick = std::max((item->expire_at + kTickMs - 1) / kTickMs, __wheel_tick + 1);
+        item->tw_slot = static_cast<uint32_t>(tick % kWheelSlots);
+        item->tw_prev = nullptr;
+        item->tw_next = __wheel[item->tw_slot];
+        if(item->tw_next) item->tw_next->tw_prev = item;
+        __wheel[item->tw_slot] = item;
+    }
+
+    void WheelRemove(KvItem* item) {
+        if(item->tw_prev) item->tw_prev->tw_next = item->tw_next;
+        else __wheel[item->tw_slot] = item->tw_next;
+        if(item->tw_next) item->tw_next->tw_prev = item->tw_prev;
+        item->tw_prev = item->tw_next = nullptr;
+    }
+
+    KvLruList& ListOf(KvItem* item) {
+        ClassLru& lru = __lru[item->cls];
+        return item->flags & KvItem::kProtected ? lru.protect : lru.probation;
+    }
+
+    // 从表、LRU、时间轮中摘除并归还slab块
+    void Unlink(KvItem* item) {
+        __table.Erase(item);
+        ListOf(item).Remove(item);
+        if(item->expire_at) WheelRemove(item);
+        item->flags = 0;
+        KvCacheStats::Add(__stats.items, -1);
+        KvCacheStats::Add(__stats.bytes_data, -static_cast<int64_t>(item->TotalSize()));
+        KvCacheStats::Add(__stats.bytes_used, -static_cast<int64_t>(__slab.ChunkSize(item->cls)));
+        __slab.Free(item->cls, reinterpret_cast<char*>(item));
+    }
+
+    // 命中：试用段晋升保护段，保护段移到表头
+    void Touch(KvItem* item) {
+        ClassLru& lru = __lru[item->cls];
+        if(item->flags & KvItem::kProtected) {
+            if(lru.protect.head != item) {
+                lru.protect.Remove(item);
+                lru.protect.PushFront(item);
+            }
+            return;
+        }
+        lru.probation.Remove(item);
+        item->flags |= KvItem::kProtected;
+        lru.protect.PushFront(item);
+        while(lru.protect.size > 1 and lru.protect.size * 100 > (lru.protect.size + lru.probation.size) * kProtectedPercent) {
+            KvItem* demoted = lru.protect.tail;
+            lru.protect.Remove(demoted);
+            demoted->flags &= ~KvItem::kProtected;
+            lru.probation.PushFront(demoted);
+        }
+    }
+
+    // 预算内分配；不够时淘汰同级别最冷的条目，同级别为空则从占页最多的级别回收一页
+    KvItem* AllocItem(uint8_t cls) {
+        char* chunk = __slab.Alloc(cls);
+        if(!chunk) {
+            ClassLru& lru = __lru[cls];
+            KvItem* victim = lru.probation.tail ? lru.probation.tail : lru.protect.tail;
+            if(victim) {
+                Unlink(victim);
+                KvCacheStats::Add(__stats.evictions);
+            } else if(__slab.MovePage(__slab.LargestClass(), cls, [this](KvItem* item) {
+                          Unlink(item);
+                          KvCacheStats::Add(__stats.evictions);
+                      })) {
+                KvCacheStats::Add(__stats.page_moves);
+            }
+            chunk = __slab.Alloc(cls);
+            if(!chunk) return nullptr;
+        }
+        __stats.bytes_allocated.store(__slab.AllocatedBytes(), std::memory_order_relaxed);
+        return reinterpret_cast<KvItem*>(chunk);
+    }
+
+public:
+    explicit KvCache(size_t memory_limit) :
+        __slab(memory_limit), __wheel(kWheelSlots, nullptr), __now(NowMs()), __wheel_tick(__now / kTickMs)
+    {
+        __lru.resize(__slab.ClassCount());
+        __stats.bytes_limit.store(__slab.Limit(), std::memory_order_relaxed);
+    }
+
+    KvCache(const KvCache&) = delete;
+    KvCache& operator=(const KvCache&) = delete;
+
+    // 需在分片loop开始处理请求之前调用
+    void SetMemoryLimit(size_t bytes) {
+        __slab.SetLimit(bytes);
+        __stats.bytes_limit.store(__slab.Limit(), std::memory_order_relaxed);
+    }
+
+    const KvCacheStats& Stats() const { return __stats; }
+    size_t size() const { return __table.size(); }
+
+    // 命中时返回条目，在下一次修改本分片之前有效
+    const KvItem* Get(std::string_view key, uint64_t hash) {
+        KvItem* item = __table.Find(key, hash);
+        if(item and Expired(item)) {
+            Unlink(item);
+            KvCacheStats::Add(__stats.expired);
+            item = nullptr;
+        }
+        if(!item) {
+            KvCacheStats::Add(__stats.misses);
+            return nullptr;
+        }
+        KvCacheStats::Add(__stats.hits);
+        Touch(item);
+        return item;
+    }
+
+    // ttl_ms为0表示不过期；条目超过一页或内存不足时返回false（已有的旧值同时被删除）
+    bool Set(std::string_view key, uint64_t hash, std::string_view value, uint32_t ttl_ms = 0) {
+        KvCacheStats::Add(__stats.sets);
+        // 先摘除旧值：新值可能落在不同级别，且分配时的淘汰不能碰到正在替换的条目
+        if(KvItem* old = __table.Find(key, hash)) Unlink(old);
+        int cls = __slab.ClassOf(sizeof(KvItem) + key.size() + value.size());
+        KvItem* item = cls < 0 ? nullptr : AllocItem(static_cast<uint8_t>(cls));
+        if(!item) {
+            KvCacheStats::Add(__stats.rejected);
+            return false;
+        }
+        item->hash = hash;
+        item->expire_at = ttl_ms ? __now + ttl_ms : 0;
+        item->key_len = static_cast<uint16_t>(key.size());
+        item->value_len = static_cast<uint32_t>(value.size());
+        item->cls = static_cast<uint8_t>(cls);
+        item->flags = KvItem::kLinked;
+        memcpy(item->Data(), key.data(), key.size());
+        memcpy(item->Data() + key.size(), value.data(), value.size());
+        __table.Insert(item);
+        __lru[cls].probation.PushFront(item);
+        if(item->expire_at) WheelAdd(item);
+        KvCacheStats::Add(__stats.items);
+        KvCacheStats::Add(__stats.bytes_data, item->TotalSize());
+        KvCacheStats::Add(__stats.bytes_used, __slab.ChunkSize(item->cls));
+        __stats.bytes_index.store(__table.MemoryBytes(), std::memory_order_relaxed);
+        return true;
+    }
+
+    bool Erase(std::string_view key, uint64_t hash) {
+        KvItem* item = __table.Find(key, hash);
+        if(!item) return false;
+        bool expired = Expired(item);
+        Unlink(item);
+        if(expired) KvCacheStats::Add(__stats.expired);
+        return !expired;
+    }
+
+    // 遍历全部未过期的条目，fn(item, 剩余TTL毫秒，0为不过期)
+    template <typename F>
+    void ForEach(F fn) const {
+        for(const ClassLru& lru : __lru) {
+            for(const KvLruList* list : {&lru.probation, &lru.protect}) {
+                for(const KvItem* item = list->head; item; item = item->lru_next) {
+                    if(!Expired(item)) fn(item, item->expire_at ? item->expire_at - __now : 0);
+                }
+            }
+        }
+    }
+
+    // 由所属loop的定时器每kTickMs调用：推进时钟，回收到期条目
+    void Tick() {
+        __now = NowMs();
+        int64_t target = __now / kTickMs;
+        // 落后超过一圈时每个槽位扫一遍即可
+        int64_t tick = std::max(__wheel_tick + 1, target - static_cast<int64_t>(kWheelSlots) + 1);
+        for(; tick <= target; tick++) {
+            KvItem* item = __wheel[tick % kWheelSlots];
+            while(item) {
+                KvItem* next = item->tw_next;
+                if(item->expire_at <= __now) {
+                    Unlink(item);
+                    KvCacheStats::Add(__stats.expired);
+                }
+                item = next;
+            }
+        }
+        __wheel_tick = target;
+    }
+};
+
+// 追加一个响应帧
+inline void KvAppendResponse(std::string& out, KvStatus status, std::string_view value = {})
+{
+    uint32_t len = htonl(static_cast<uint32_t>(1 + value.size()));
+    out.append(reinterpret_cast<const char*>(&len), 4);
+    out.push_back(static_cast<char>(status));
+    out.append(value);
+}
+
+// 一个分片：只由所属从Reactor线程访问
+class KvShard {
+private:
+    KvCache __cache;
+    KvWal* __wal = nullptr;
+    uint64_t __wal_gen = 0;
+    std::string __wal_buf; // 当前任务中产生、尚未提交的日志记录；每个任务结束前提交，任务之间总为空
+
+    void Log(KvOp op, std::string_view key, std::string_view value = {}, int64_t expire_ms = 0) {
+        if(__wal) KvWal::AppendRecord(__wal_buf, static_cast<uint8_t>(op), key, value, expire_ms);
+    }
+
+public:
+    explicit KvShard(size_t memory_limit) : __cache(memory_limit) {}
+
+    void Execute(KvOp op, std::string_view key, uint64_t hash, std::string_view value, std::string& out) {
+        switch(op) {
+            case KvOp::kGet: {
+                const KvItem* found = __cache.Get(key, hash);
+                if(found) KvAppendResponse(out, KvStatus::kOk, found->Value());
+                else KvAppendResponse(out, KvStatus::kNotFound);
+                break;
+            }
+            case KvOp::kSet: {
+                // 写入失败时旧值已被删除，记为DEL
+                bool ok = __cache.Set(key, hash, value);
+                if(ok) Log(KvOp::kSet, key, value);
+                else Log(KvOp::kDel, key);
+                KvAppendResponse(out, ok ? KvStatus::kOk : KvStatus::kError);
+                break;
+            }
+            case KvOp::kSetEx: {
+                uint32_t ttl;
+                if(value.size() < 4) {
+                    KvAppendResponse(out, KvStatus::kError);
+                    break;
+                }
+                memcpy(&ttl, value.data(), 4);
+                ttl = ntohl(ttl);
+                bool ok = __cache.Set(key, hash, value.substr(4), ttl);
+                if(ok) Log(KvOp::kSet, key, value.substr(4), ttl ? WalNowMs() + ttl : 0);
+                else Log(KvOp::kDel, key);
+                KvAppendResponse(out, ok ? KvStatus::kOk : KvStatus::kError);
+                break;
+            }
+            case KvOp::kDel: {
+                bool found = __cache.Erase(key, hash);
+                if(found) Log(KvOp::kDel, key);
+                KvAppendResponse(out, found ? KvStatus::kOk : KvStatus::kNotFound);
+                break;
+            }
+            default:
+                KvAppendResponse(out, KvStatus::kError);
+        }
+    }
+
+    // 回放一条日志记录，不再产生日志；已过期的SET等同于DEL（覆盖更早的值）
+    void Apply(const WalRecord& rec) {
+        uint64_t hash = KvHash(rec.key);
+        if(static_cast<KvOp>(rec.op) == KvOp::kSet) {
+            int64_t ttl = rec.expire_ms ? rec.expire_ms - WalNowMs() : 0;
+            if(rec.expire_ms and ttl <= 0) __cache.Erase(rec.key, hash);
+            else __cache.Set(rec.key, hash, rec.value, static_cast<uint32_t>(ttl));
+        } else if(static_cast<KvOp>(rec.op) == KvOp::kDel) {
+            __cache.Erase(rec.key, hash);
+        }
+    }
+
+    void AttachWal(KvWal* wal, uint64_t gen) {
+        __wal = wal;
+        __wal_gen = gen;
+    }
+
+    size_t PendingLogBytes() const { return __wal_buf.size(); }
+
+    // 把当前任务产生的日志交给WAL，落盘后在I/O线程中调用done
+    void Commit(KvWal::Callback done) {
+        __wal->Submit(__wal_gen, std::move(__wal_buf), std::move(done));
+        __wal_buf.clear();
+    }
+
+    // 快照：之后的修改写入gen代日志，返回此刻的全部数据（SET记录）
+    std::string SwitchGeneration(uint64_t gen) {
+        __wal_gen = gen;
+        std::string data;
+        int64_t now = WalNowMs();
+        __cache.ForEach([&data, now](const KvItem* item, int64_t ttl) {
+            KvWal::AppendRecord(data, static_cast<uint8_t>(KvOp::kSet), item->Key(), item->Value(), ttl ? now + ttl : 0);
+        });
+        return data;
+    }
+
+    void Tick() { __cache.Tick(); }
+    void SetMemoryLimit(size_t bytes) { __cache.SetMemoryLimit(bytes); }
+    const KvCacheStats& Stats() const { return __cache.Stats(); }
+    size_t size() const { return __cache.size(); }
+};
+
+class KvServer {
+private:
+    static constexpr uint32_t kMaxFrame = 16 * 1024 * 1024;
+
+    // 转发到其他分片的请求，执行后按seq填回
+    struct ForwardOp {
+        uint64_t seq;
+        uint64_t hash;
+        KvOp op;
+        std::string key;
+        std::string value;
+    };
+
+    // 连接状态，只在连接所属loop中访问
+    struct KvSession {
+        size_t home = 0;               // 连接所属从Reactor（即本地分片）编号
+        uint64_t base = 0;             // pending.front() 对应的请求序号
+        std::deque<std::optional<std::string>> pending; // 等待转发结果的响应，保证按请求顺序回复
+    };
+    using KvSessionPtr = std::shared_ptr<KvSession>;
+    using Results = std::vector<std::pair<uint64_t, std::string>>;
+
+    // __server最后声明、最先析构：从Reactor线程退出之前，它们访问的分片与WAL都必须有效
+    std::unique_ptr<KvWal> __wal;
+    std::vector<std::unique_ptr<KvShard>> __shards;
+    std::unordered_map<EpollEventLoop*, size_t> __loop_index;
+    TCPServer __server;
+
+    size_t ShardOf(uint64_t hash) const { return (hash >> 40) % __shards.size(); }
+
+    void OnConnection(const ConnectionPtr& conn) {
+        if(!conn->Connected()) return;
+        auto session = std::make_shared<KvSession>();
+        session->home = __loop_index.at(conn->GetLoop());
+        conn->SetContext(session);
+    }
+
+    void OnMessage(const ConnectionPtr& conn, Buffer* buf) {
+        auto session = std::any_cast<KvSessionPtr>(conn->Context());
+        std::string out;
+        Results local;
+        std::vector<std::vector<ForwardOp>> batches(__shards.size());
+        while(buf->ReadableBytes() >= 4) {
+            uint32_t len;
+            memcpy(&len, buf->Peek(), 4);
+            len = ntohl(len);
+            if(len > kMaxFrame or len < 3) {
+                conn->ForceClose();
+                return;
+            }
+            if(buf->ReadableBytes() < 4 + len) break;
+            const char* body = buf->Peek() + 4;
+            KvOp op = static_cast<KvOp>(body[0]);
+            uint16_t key_len;
+            memcpy(&key_len, body + 1, 2);
+            key_len = ntohs(key_len);
+            if(3u + key_len > len) {
+                conn->ForceClose();
+                return;
+            }
+            std::string_view key(body + 3, key_len);
+            std::string_view value(body + 3 + key_len, len - 3 - key_len);
+            uint64_t hash = KvHash(key);
+            size_t shard = ShardOf(hash);
+
+            if(op == KvOp::kStats or shard == session->home) {
+                // 本地执行：前面没有未完成的响应时直接写入本批输出；产生了日志的修改等落盘后再回复
+                std::string resp;
+                size_t logged = __shards[session->home]->PendingLogBytes();
+                if(op == KvOp::kStats) KvAppendResponse(resp, KvStatus::kOk, StatsText());
+                else __shards[shard]->Execute(op, key, hash, value, resp);
+                if(__shards[session->home]->PendingLogBytes() != logged) {
+                    local.emplace_back(session->base + session->pending.size(), std::move(resp));
+                    session->pending.emplace_back(std::nullopt);
+                } else if(session->pending.empty()) {
+                    out.append(resp);
+                } else {
+                    session->pending.emplace_back(std::move(resp));
+                }
+            } else {
+                uint64_t seq = session->base + session->pending.size();
+                session->pending.emplace_back(std::nullopt);
+                batches[shard].push_back(ForwardOp{seq, hash, op, std::string(key), std::string(value)});
+            }
+            buf->Retrieve(4 + len);
+        }
+        if(!out.empty()) conn->Send(std::move(out));
+        if(!local.empty()) {
+            EpollEventLoop* loop = conn->GetLoop();
+            __shards[session->home]->Commit([loop, conn, session, local = std::move(local)]() mutable {
+                loop->QueueInLoop([conn, session, local = std::move(local)]() mutable { Deliver(conn, *session, local); });
+            });
+        }
+        for(size_t shard = 0; shard < batches.size(); shard++) {
+            if(!batches[shard].empty()) Forward(conn, session, shard, std::move(batches[shard]));
+        }
+    }
+
+    // 在连接所属loop中填回结果，按请求顺序发送已就绪的响应
+    static void Deliver(const ConnectionPtr& conn, KvSession& session, Results& results) {
+        for(auto& [seq, resp] : results) session.pending[seq - session.base] = std::move(resp);
+        std::string out;
+        while(!session.pending.empty() and session.pending.front()) {
+            out.append(*session.pending.front());
+            session.pending.pop_front();
+            session.base++;
+        }
+        if(!out.empty() and conn->Connected()) conn->Send(std::move(out));
+    }
+
+    // 一批请求一次投递到目标分片loop，结果一次投递回连接所属loop（有修改时等日志落盘）
+    void Forward(const ConnectionPtr& conn, const KvSessionPtr& session, size_t shard, std::vector<ForwardOp> batch) {
+        KvShard* target = __shards[shard].get();
+        __server.SubReactor(shard)->QueueInLoop([target, conn, session, batch = std::move(batch)]() mutable {
+            Results results;
+            results.reserve(batch.size());
+            for(auto& op : batch) {
+                std::string resp;
+                target->Execute(op.op, op.key, op.hash, op.value, resp);
+                results.emplace_back(op.seq, std::move(resp));
+            }
+            EpollEventLoop* loop = conn->GetLoop();
+            auto deliver = [conn, session, results = std::move(results)]() mutable { Deliver(conn, *session, results); };
+            if(target->PendingLogBytes()) target->Commit([loop, deliver = std::move(deliver)]() mutable { loop->QueueInLoop(std::move(deliver)); });
+            else loop->QueueInLoop(std::move(deliver));
+        });
+    }
+
+public:
+    static constexpr size_t kDefaultMemoryLimit = 64 << 20;
+
+    // 分片数 = 从Reactor数；KV请求都在loop中完成，不需要业务线程
+    KvServer(uint16_t port, int shards = 4, int listenfd = -1) :
+        __server(port, shards, 0, listenfd)
+    {
+        size_t n = __server.SubReactorCount();
+        for(size_t i = 0; i < n; i++) {
+            __shards.push_back(std::make_unique<KvShard>(kDefaultMemoryLimit / n));
+            __loop_index[__server.SubReactor(i)] = i;
+            KvShard* shard = __shards.back().get();
+            __server.SubReactor(i)->RunEvery(std::chrono::milliseconds(KvCache::kTickMs), [shard]() { shard->Tick(); });
+        }
+        __server.SetConnectionCallback([this](const ConnectionPtr& conn) { OnConnection(conn); });
+        __server.SetMessageCallback([this](const ConnectionPtr& conn, Buffer* buf) { OnMessage(conn, buf); });
+    }
+
+    // WAL的I/O线程在从Reactor之前停止：已提交记录的回调照常投递到仍在运行的loop
+    ~KvServer() noexcept {
+        if(__wal) __wal->stop();
+    }
+
+    // 开启持久化：在各分片loop中回放已有的快照与日志，再启动I/O线程；需在start之前调用，返回回放的记录数
+    size_t EnableWal(const WalOptions& opts) {
+        __wal = std::make_unique<KvWal>(opts, __shards.size());
+        std::vector<std::string> per_shard(__shards.size());
+        size_t count = __wal->Replay([this, &per_shard](const WalRecord& rec, std::string_view raw) {
+            per_shard[ShardOf(KvHash(rec.key))].append(raw);
+        });
+        KvWal* wal = __wal.get();
+        uint64_t gen = wal->Generation();
+        std::vector<std::future<void>> replayed;
+        for(size_t i = 0; i < __shards.size(); i++) {
+            auto task = std::make_shared<std::packaged_task<void()>>([shard = __shards[i].get(), wal, gen, data = std::move(per_shard[i])]() {
+                KvWal::ParseRecords(data, [shard](const WalRecord& rec, std::string_view) { shard->Apply(rec); });
+                shard->AttachWal(wal, gen);
+            });
+            replayed.push_back(task->get_future());
+            __server.SubReactor(i)->RunInLoop([task]() { (*task)(); });
+        }
+        for(auto& f : replayed) f.get();
+
+        wal->SetCompactor([this, wal](uint64_t gen) {
+            for(size_t i = 0; i < __shards.size(); i++) {
+                KvShard* shard = __shards[i].get();
+                __server.SubReactor(i)->QueueInLoop([wal, shard, gen]() { wal->AddSnapshotPart(shard->SwitchGeneration(gen)); });
+            }
+        });
+        wal->start();
+        return count;
+    }
+
+    // 总内存预算，平均分给各分片；需在start之前调用
+    void SetMemoryLimit(size_t bytes) {
+        for(auto& shard : __shards) shard->SetMemoryLimit(bytes / __shards.size());
+    }
+
+    // 各分片计数器之和，任意线程可调用
+    std::string StatsText() const {
+        using Counter = std::atomic<uint64_t> KvCacheStats::*;
+        static const std::pair<const char*, Counter> kFields[] = {
+            {"hits", &KvCacheStats::hits},
+            {"misses", &KvCacheStats::misses},
+            {"sets", &KvCacheStats::sets},
+            {"evictions", &KvCacheStats::evictions},
+            {"expired", &KvCacheStats::expired},
+            {"rejected", &KvCacheStats::rejected},
+            {"page_moves", &KvCacheStats::page_moves},
+            {"items", &KvCacheStats::items},
+            {"bytes_data", &KvCacheStats::bytes_data},
+            {"bytes_used", &KvCacheStats::bytes_used},
+            {"bytes_allocated", &KvCacheStats::bytes_allocated},
+            {"bytes_index", &KvCacheStats::bytes_index},
+            {"bytes_limit", &KvCacheStats::bytes_limit},
+        };
+        std::string text = "shards " + std::to_string(__shards.size()) + "\n";
+        for(auto& [name, field] : kFields) {
+            uint64_t sum = 0;
+            for(auto& shard : __shards) sum += (shard->Stats().*field).load(std::memory_order_relaxed);
+            text.append(name).append(" ").append(std::to_string(sum)).append("\n");
+        }
+        if(__wal) text.append(__wal->StatsText());
+        return text;
+    }
+
+    TCPServer& tcp() { return __server; }
+    void start() { __server.start(); }
+    void stop() { __server.stop(); }
+};
+
+#endif // KVSTORE_H
@@ -0,0 +1,463 @@
+// 追加写日志（WAL）：各从Reactor执行修改后把日志记录交给专用I/O线程，
+// I/O线程把期间所有分片提交的记录合并成一次writev，再按同步策略fdatasync（组提交），
+// 落盘后在I/O线程中回调提交方，修改在此之后才回复客户端。
+//
+// 文件：<dir>/wal-<gen>.log 日志，<dir>/snapshot 快照（头部记录快照覆盖到哪一代日志）
+// 当前日志超过阈值时切换到新一代：各分片在自己的loop中切换代号并导出全部数据，
+// 导出结果由后台线程写成新快照（tmp + fdatasync + rename），之后删除旧代日志。
+// 启动时先加载快照，再按代号顺序回放日志，遇到不完整或校验失败的记录即停止（崩溃时未写完的尾部），
+// 之后总是写入新的一代，不会在损坏的尾部之后追加。
+//
+// 记录格式（本机字节序）：len(4) | crc32(4) | op(1) | key长度(2) | 过期时间(8，Unix毫秒，0为不过期) | key | value
+// len与crc均只覆盖len之后的部分
+
+#ifndef KVWAL_H
+#define KVWAL_H
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class WalSync {
+    kNone,     // 只write进页缓存即确认，进程崩溃不丢，掉电可能丢
+    kAlways,   // 每次组提交都fdatasync
+    kInterval, // 两次fdatasync至少间隔interval，期间的提交合并成一组
+};
+
+struct WalOptions {
+    std::string dir = "kvdata";
+    WalSync sync = WalSync::kAlways;
+    std::chrono::milliseconds interval{10};
+    size_t compact_bytes = 64 << 20; // 当前日志超过该大小时做一次快照
+};
+
+struct WalRecord {
+    uint8_t op;
+    std::string_view key;
+    std::string_view value;
+    int64_t expire_ms; // Unix毫秒，0为不过期
+};
+
+inline uint32_t Crc32(const char* data, size_t len, uint32_t crc = 0)
+{
+    static const std::array<uint32_t, 256> kTable = []() {
+        std::array<uint32_t, 256> table{};
+        for(uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for(int k = 0; k < 8; k++) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return table;
+    }();
+    crc = ~crc;
+    for(size_t i = 0; i < len; i++) crc = kTable[(crc ^ static_cast<uint8_t>(data[i])) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+inline int64_t WalNowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+class KvWal {
+public:
+    using Callback = std::function<void()>;
+
+private:
+    static constexpr size_t kHeaderSize = 8;        // len + crc
+    static constexpr size_t kFixedSize = 1 + 2 + 8; // op + key长度 + 过期时间
+    static constexpr char kSnapshotMagic[8] = {'K', 'V', 'S', 'N', 'A', 'P', '0', '1'};
+
+    struct Entry {
+        uint64_t gen;
+        std::string records;
+        Callback done;
+    };
+
+    WalOptions __opts;
+    size_t __parts;                 // 一次快照需要收齐的分片数
+    uint64_t __gen = 1;             // 当前写入的代号，启动后只由I/O线程在__mtx下修改
+    uint64_t __snapshot_gen = 0;    // 最新快照覆盖的代号，受__mtx保护
+    std::map<uint64_t, int> __fds;  // 各代日志的fd，只由I/O线程访问
+    size_t __log_bytes = 0;         // 当前代日志大小
+
+    std::mutex __mtx;
+    std::condition_variable __cv;
+    std::vector<Entry> __queue;
+    bool __stopping = false;
+    bool __compacting = false;
+    std::vector<std::string> __snapshot_parts;
+    std::function<void(uint64_t)> __compactor;
+    std::thread __io_thread;
+    std::thread __compact_thread;
+
+    std::atomic<uint64_t> __commits{0};
+    std::atomic<uint64_t> __entries{0};
+    std::atomic<uint64_t> __bytes{0};
+    std::atomic<uint64_t> __syncs{0};
+    std::atomic<uint64_t> __sync_us{0};
+    std::atomic<uint64_t> __max_sync_us{0};
+    std::atomic<uint64_t> __compactions{0};
+
+    std::string LogPath(uint64_t gen) const { return __opts.dir + "/wal-" + std::to_string(gen) + ".log"; }
+    std::string SnapshotPath() const { return __opts.dir + "/snapshot"; }
+
+    static bool ReadFile(const std::string& path, std::string& out) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fd == -1) return false;
+        struct stat st{};
+        fstat(fd, &st);
+        out.resize(st.st_size);
+        size_t got = 0;
+        while(got < out.size()) {
+            ssize_t n = read(fd, out.data() + got, out.size() - got);
+            if(n <= 0) break;
+            got += n;
+        }
+        out.resize(got);
+        close(fd);
+        return true;
+    }
+
+    static bool WriteAll(int fd, const char* data, size_t len) {
+        while(len > 0) {
+            ssize_t n = write(fd, data, len);
+            if(n == -1 and errno == EINTR) continue;
+            if(n <= 0) return false;
+            data += n;
+            len -= n;
+        }
+        return true;
+    }
+
+    void SyncDir() const {
+        int fd = open(__opts.dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(fd == -1) return;
+        fsync(fd);
+        close(fd);
+    }
+
+    // 目录中现有的日志代号（升序）
+    std::vector<uint64_t> ListLogs() const {
+        std::vector<uint64_t> gens;
+        DIR* dir = opendir(__opts.dir.c_str());
+        if(!dir) return gens;
+        while(dirent* e = readdir(dir)) {
+            unsigned long long gen;
+            char tail;
+            if(sscanf(e->d_name, "wal-%llu.lo%c", &gen, &tail) == 2 and tail == 'g') gens.push_back(gen);
+        }
+        closedir(dir);
+        std::sort(gens.begin(), gens.end());
+        return gens;
+    }
+
+    int FdFor(uint64_t gen) {
+        auto it = __fds.find(gen);
+        if(it != __fds.end()) return it->second;
+        int fd = open(LogPath(gen).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if(fd == -1) {
+            perror("[WAL] Failed to open log!");
+            std::abort();
+        }
+        SyncDir(); // 新建的日志文件本身也要持久化
+        __fds[gen] = fd;
+        return fd;
+    }
+
+    // 一组记录同一代的写一次writev；写入或同步失败时页缓存状态不可知，继续运行可能确认未持久化的修改，直接终止
+    void WriteGroup(int fd, const std::vector<Entry*>& group) {
+        std::vector<iovec> iov;
+        iov.reserve(group.size());
+        for(Entry* e : group) {
+            if(!e->records.empty()) iov.push_back({e->records.data(), e->records.size()});
+        }
+        size_t idx = 0;
+        while(idx < iov.size()) {
+            int cnt = static_cast<int>(std::min<size_t>(iov.size() - idx, IOV_MAX));
+            ssize_t n = writev(fd, &iov[idx], cnt);
+            if(n == -1 and errno == EINTR) continue;
+            if(n == -1) {
+                perror("[WAL] writev failed!");
+                std::abort();
+            }
+            size_t left = n;
+            while(idx < iov.size() and left >= iov[idx].iov_len) left -= iov[idx++].iov_len;
+            if(left) {
+                iov[idx].iov_base = static_cast<char*>(iov[idx].iov_base) + left;
+                iov[idx].iov_len -= left;
+            }
+        }
+    }
+
+    void Sync(int fd) {
+        auto start = std::chrono::steady_clock::now();
+        if(fdatasync(fd) == -1) {
+            perror("[WAL] fdatasync failed!");
+            std::abort();
+        }
+        uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        __syncs.fetch_add(1, std::memory_order_relaxed);
+        __sync_us.fetch_add(us, std::memory_order_relaxed);
+        if(us > __max_sync_us.load(std::memory_order_relaxed)) __max_sync_us.store(us, std::memory_order_relaxed);
+    }
+
+    void IoLoop() {
+        std::vector<Entry> batch;
+        auto last_sync = std::chrono::steady_clock::now();
+        while(true) {
+            uint64_t snapshot_gen;
+            {
+                std::unique_lock<std::mutex> lock(__mtx);
+                __cv.wait(lock, [this]() { return !__queue.empty() or __stopping; });
+                if(__queue.empty()) break;
+                if(__opts.sync == WalSync::kInterval)
+                    __cv.wait_until(lock, last_sync + __opts.interval, [this]() { return __stopping; });
+                // 在取走队列前读取：快照完成之前提交的旧代记录都已在本批中，本批写完即可关闭旧代fd
+                snapshot_gen = __snapshot_gen;
+                batch.swap(__queue);
+            }
+
+            size_t bytes = 0;
+            std::map<uint64_t, std::vector<Entry*>> groups;
+            for(auto& e : batch) {
+                groups[e.gen].push_back(&e);
+                bytes += e.records.size();
+            }
+            for(auto& [gen, group] : groups) {
+                int fd = FdFor(gen);
+                WriteGroup(fd, group);
+                if(__opts.sync != WalSync::kNone) Sync(fd);
+                if(gen == __gen) {
+                    for(Entry* e : group) __log_bytes += e->records.size();
+                }
+            }
+            last_sync = std::chrono::steady_clock::now();
+            __commits.fetch_add(1, std::memory_order_relaxed);
+            __entries.fetch_add(batch.size(), std::memory_order_relaxed);
+            __bytes.fetch_add(bytes, std::memory_order_relaxed);
+            for(auto& e : batch) {
+                if(e.done) e.done();
+            }
+            batch.clear();
+
+            for(auto it = __fds.begin(); it != __fds.end() and it->first < snapshot_gen;) {
+                close(it->second);
+                it = __fds.erase(it);
+            }
+            MaybeCompact();
+        }
+    }
+
+    // 当前代日志过大时切换到新一代，由compactor通知各分片切换代号并导出数据
+    void MaybeCompact() {
+        if(__log_bytes < __opts.compact_bytes or !__compactor) return;
+        uint64_t gen;
+        {
+            std::lock_guard<std::mutex> lock(__mtx);
+            if(__compacting or __stopping) return;
+            __compacting = true;
+            __snapshot_parts.clear();
+            gen = ++__gen;
+        }
+        __log_bytes = 0;
+        __compactor(gen);
+    }
+
+    // 后台线程：写新快照，成功后删除它覆盖的旧代日志
+    void WriteSnapshot(uint64_t gen, std::vector<std::string> parts) {
+        std::string tmp = SnapshotPath() + ".tmp";
+        int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        bool ok = fd != -1 and WriteAll(fd, kSnapshotMagic, sizeof(kSnapshotMagic))
+                  and WriteAll(fd, reinterpret_cast<const char*>(&gen), sizeof(gen));
+        for(auto& part : parts) ok = ok and WriteAll(fd, part.data(), part.size());
+        ok = ok and fdatasync(fd) == 0;
+        if(fd != -1) close(fd);
+        if(!ok or rename(tmp.c_str(), SnapshotPath().c_str()) == -1) {
+            // 旧快照与全部日志仍在，数据不丢，下次日志增长时重试
+            perror("[WAL] Failed to write snapshot!");
+            unlink(tmp.c_str());
+            std::lock_guard<std::mutex> lock(__mtx);
+            __compacting = false;
+            return;
+        }
+        SyncDir();
+        for(uint64_t old : ListLogs()) {
+            if(old < gen) unlink(LogPath(old).c_str());
+        }
+        std::lock_guard<std::mutex> lock(__mtx);
+        __snapshot_gen = gen;
+        __compacting = false;
+        __compactions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+public:
+    static void AppendRecord(std::string& out, uint8_t op, std::string_view key, std::string_view value, int64_t expire_ms) {
+        uint32_t len = static_cast<uint32_t>(kFixedSize + key.size() + value.size());
+        size_t start = out.size();
+        out.resize(start + kHeaderSize + kFixedSize);
+        char* p = out.data() + start;
+        uint16_t key_len = static_cast<uint16_t>(key.size());
+        memcpy(p, &len, 4);
+        p[8] = static_cast<char>(op);
+        memcpy(p + 9, &key_len, 2);
+        memcpy(p + 11, &expire_ms, 8);
+        out.append(key);
+        out.append(value);
+        uint32_t crc = Crc32(out.data() + start + kHeaderSize, len);
+        memcpy(out.data() + start + 4, &crc, 4);
+    }
+
+    // 逐条解析，fn(record, 原始字节)；返回完整且校验通过的前缀长度
+    template <typename F>
+    static size_t ParseRecords(std::string_view buf, F fn) {
+        size_t pos = 0;
+        while(buf.size() - pos >= kHeaderSize + kFixedSize) {
+            uint32_t len, crc;
+            memcpy(&len, buf.data() + pos, 4);
+            memcpy(&crc, buf.data() + pos + 4, 4);
+            if(len < kFixedSize or buf.size() - pos - kHeaderSize < len) break;
+            const char* body = buf.data() + pos + kHeaderSize;
+            if(Crc32(body, len) != crc) break;
+            WalRecord rec;
+            uint16_t key_len;
+            rec.op = static_cast<uint8_t>(body[0]);
+            memcpy(&key_len, body + 1, 2);
+            memcpy(&rec.expire_ms, body + 3, 8);
+            if(kFixedSize + key_len > len) break;
+            rec.key = std::string_view(body + kFixedSize, key_len);
+            rec.value = std::string_view(body + kFixedSize + key_len, len - kFixedSize - key_len);
+            fn(rec, buf.substr(pos, kHeaderSize + len));
+            pos += kHeaderSize + len;
+        }
+        return pos;
+    }
+
+    // parts：每次快照需要收到的AddSnapshotPart次数（分片数）
+    KvWal(WalOptions opts, size_t parts) : __opts(std::move(opts)), __parts(parts) {
+        if(mkdir(__opts.dir.c_str(), 0755) == -1 and errno != EEXIST)
+            throw std::runtime_error("WAL: cannot create " + __opts.dir + ": " + strerror(errno));
+    }
+
+    KvWal(const KvWal&) = delete;
+    KvWal& operator=(const KvWal&) = delete;
+    ~KvWal() noexcept {
+        stop();
+        for(auto& [gen, fd] : __fds) close(fd);
+    }
+
+    // 启动前调用：按快照、各代日志的顺序回放全部记录，fn(record, 原始字节)；返回回放的记录数
+    template <typename F>
+    size_t Replay(F fn) {
+        size_t count = 0;
+        auto counted = [&count, &fn](const WalRecord& rec, std::string_view raw) {
+            count++;
+            fn(rec, raw);
+        };
+        std::string data;
+        if(ReadFile(SnapshotPath(), data)) {
+            if(data.size() < sizeof(kSnapshotMagic) + 8 or memcmp(data.data(), kSnapshotMagic, sizeof(kSnapshotMagic)) != 0)
+                throw std::runtime_error("WAL: bad snapshot header in " + SnapshotPath());
+            memcpy(&__snapshot_gen, data.data() + sizeof(kSnapshotMagic), 8);
+            std::string_view body(data.data() + sizeof(kSnapshotMagic) + 8, data.size() - sizeof(kSnapshotMagic) - 8);
+            if(ParseRecords(body, counted) != body.size())
+                throw std::runtime_error("WAL: corrupted snapshot " + SnapshotPath());
+        }
+        uint64_t max_gen = __snapshot_gen;
+        for(uint64_t gen : ListLogs()) {
+            if(gen < __snapshot_gen) {
+                unlink(LogPath(gen).c_str()); // 快照写完、删除旧日志之前崩溃留下的
+                continue;
+            }
+            if(!ReadFile(LogPath(gen), data)) continue;
+            size_t valid = ParseRecords(data, counted);
+            if(valid != data.size())
+                std::cerr << "[WAL] " << LogPath(gen) << ": dropped " << data.size() - valid << " bytes of torn tail" << std::endl;
+            max_gen = std::max(max_gen, gen);
+        }
+        __gen = max_gen + 1;
+        return count;
+    }
+
+    uint64_t Generation() const { return __gen; }
+
+    // compactor(gen)：在I/O线程中调用，须让每个分片切换到gen并把导出数据交给AddSnapshotPart
+    void SetCompactor(std::function<void(uint64_t)> compactor) { __compactor = std::move(compactor); }
+
+    void start() { __io_thread = std::thread([this]() { IoLoop(); }); }
+
+    // 任意线程调用：records写入gen代日志并按同步策略落盘后，在I/O线程中调用done；停止后提交的记录被丢弃
+    void Submit(uint64_t gen, std::string records, Callback done) {
+        {
+            std::lock_guard<std::mutex> lock(__mtx);
+            if(__stopping) return;
+            __queue.push_back(Entry{gen, std::move(records), std::move(done)});
+        }
+        __cv.notify_one();
+    }
+
+    void AddSnapshotPart(std::string data) {
+        std::lock_guard<std::mutex> lock(__mtx);
+        if(__stopping or !__compacting) return;
+        __snapshot_parts.push_back(std::move(data));
+        if(__snapshot_parts.size() < __parts) return;
+        if(__compact_thread.joinable()) __compact_thread.join(); // 上一次的线程已结束
+        __compact_thread = std::thread([this, gen = __gen, parts = std::move(__snapshot_parts)]() mutable {
+            WriteSnapshot(gen, std::move(parts));
+        });
+        __snapshot_parts.clear();
+    }
+
+    // 处理完已提交的记录（回调照常执行）后停止，之后的Submit被丢弃
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(__mtx);
+            __stopping = true;
+        }
+        __cv.notify_all();
+        if(__io_thread.joinable()) __io_thread.join();
+        if(__compact_thread.joinable()) __compact_thread.join();
+    }
+
+    std::string StatsText() const {
+        uint64_t commits = __commits.load(std::memory_order_relaxed);
+        uint64_t syncs = __syncs.load(std::memory_order_relaxed);
+        std::string text;
+        auto line = [&text](const char* name, uint64_t value) {
+            text.append(name).append(" ").append(std::to_string(value)).append("\n");
+        };
+        line("wal_commits", commits);
+        line("wal_entries", __entries.load(std::memory_order_relaxed));
+        line("wal_bytes", __bytes.load(std::memory_order_relaxed));
+        line("wal_syncs", syncs);
+        line("wal_sync_avg_us", syncs ? __sync_us.load(std::memory_order_relaxed) / syncs : 0);
+        line("wal_sync_max_us", __max_sync_us.load(std::memory_order_relaxed));
+        line("wal_compactions", __compactions.load(std::memory_order_relaxed));
+        return text;
+    }
+};
+
+#endif // KVWAL_H
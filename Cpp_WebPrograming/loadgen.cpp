@@ -0,0 +1,487 @@
+// 压测工具（wrk风格）：多线程，每个线程一个epoll驱动若干长连接，每条连接保持固定深度的在途请求
+// 用法: ./loadgen [-H host] [-p port] [-c 连接数] [-t 线程数] [-d 秒] [-m http|echo|packet|kv]
+//                 [-D 流水线深度] [-s 请求大小/kv的value大小] [-r 回复大小(echo)] [-u 路径(http)]
+//                 [-k kv键空间大小] [-w kv中SET所占百分比] [-b 源地址个数] [-C 输出CSV行]
+// -b N：连接轮流绑定 127.0.0.1..127.0.0.N 作为源地址（仅压测本机时），突破单个源地址约2.8万个临时端口的限制
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <cctype>
+#include <algorithm>
+
+using Clock = std::chrono::steady_clock;
+
+// 对数分桶直方图：64以内逐一计数，之后每个2的幂区间再分32份，相对误差约3%
+class Histogram {
+private:
+    static constexpr int kLinear = 64;
+    static constexpr int kSub = 32;
+    std::vector<uint64_t> __buckets;
+    uint64_t __count = 0;
+    uint64_t __max = 0;
+
+    static size_t Index(uint64_t v) {
+        if(v < kLinear) return v;
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - 5;
+        return kLinear + (msb - 6) * kSub + ((v >> shift) - kSub);
+    }
+    static uint64_t LowerBound(size_t idx) {
+        if(idx < kLinear) return idx;
+        size_t msb = (idx - kLinear) / kSub + 6;
+        uint64_t sub = (idx - kLinear) % kSub + kSub;
+        return sub << (msb - 5);
+    }
+
+public:
+    Histogram() : __buckets(kLinear + 58 * kSub, 0) {}
+
+    void Record(uint64_t v) {
+        __buckets[Index(v)]++;
+        __count++;
+        if(v > __max) __max = v;
+    }
+    void Merge(const Histogram& other) {
+        for(size_t i = 0; i < __buckets.size(); i++) __buckets[i] += other.__buckets[i];
+        __count += other.__count;
+        __max = std::max(__max, other.__max);
+    }
+    uint64_t Percentile(double p) const {
+        if(__count == 0) return 0;
+        uint64_t target = static_cast<uint64_t>(p / 100.0 * __count);
+        uint64_t seen = 0;
+        for(size_t i = 0; i < __buckets.size(); i++) {
+            seen += __buckets[i];
+            if(seen > target) return LowerBound(i);
+        }
+        return __max;
+    }
+    uint64_t Count() const { return __count; }
+    uint64_t Max() const { return __max; }
+};
+
+enum class Mode { kHttp, kEcho, kPacket, kKv };
+
+struct Options {
+    std::string host = "127.0.0.1";
+    uint16_t port = 8080;
+    int conns = 64;
+    int threads = 2;
+    int duration = 10;
+    Mode mode = Mode::kHttp;
+    int depth = 1;
+    size_t size = 64;
+    size_t reply_size = 0; // echo模式下每个回复的字节数，0表示与请求相同
+    std::string path = "/";
+    uint64_t keys = 100000; // kv：随机键范围
+    int set_percent = 10;   // kv：SET请求占比，其余为GET
+    int sources = 1;        // 源地址个数，>1 时轮流绑定 127.0.0.x
+    bool csv = false;
+};
+
+struct Conn {
+    int fd = -1;
+    bool connected = false;
+    bool closing = false; // 服务器已声明 Connection: close（如优雅退出），收到该响应后主动重连
+    std::string out;
+    size_t out_pos = 0;
+    std::string in;
+    size_t in_pos = 0;
+    std::deque<Clock::time_point> inflight; // 在途请求的发出时间，按序完成
+};
+
+struct WorkerStats {
+    Histogram latency; // 微秒
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    uint64_t reconnects = 0; // 服务器声明关闭后的正常重连，不计为错误
+    uint64_t non2xx = 0;
+    uint64_t bytes = 0;
+};
+
+// 大小写不敏感地查找头字段，返回值的起点（未找到返回npos）
+static size_t FindHeader(std::string_view head, std::string_view name)
+{
+    for(size_t pos = head.find("\r\n"); pos != std::string_view::npos; pos = head.find("\r\n", pos + 2)) {
+        size_t line = pos + 2;
+        if(head.size() - line < name.size() + 1) break;
+        bool match = true;
+        for(size_t i = 0; i < name.size() and match; i++)
+            match = std::tolower(static_cast<unsigned char>(head[line + i])) == name[i];
+        if(match and head[line + name.size()] == ':') {
+            size_t v = line + name.size() + 1;
+            while(v < head.size() and head[v] == ' ') v++;
+            return v;
+        }
+    }
+    return std::string_view::npos;
+}
+
+class Worker {
+private:
+    const Options& __opt;
+    std::vector<Conn> __conns;
+    std::string __request;
+    std::string __kv_value;
+    uint64_t __rng;
+    int __epfd = -1;
+    WorkerStats __stats;
+    sockaddr_in __addr{};
+    uint32_t __next_source = 0;
+
+    // 返回buf中第一个完整响应的长度，不完整返回0；status输出HTTP状态码，close输出是否带 Connection: close
+    size_t ResponseLength(std::string_view buf, int& status, bool& close) const {
+        switch(__opt.mode) {
+            case Mode::kEcho: {
+                size_t want = __opt.reply_size ? __opt.reply_size : __opt.size;
+                return buf.size() >= want ? want : 0;
+            }
+            case Mode::kPacket:
+            case Mode::kKv: {
+                if(buf.size() < 4) return 0;
+                uint32_t len;
+                memcpy(&len, buf.data(), 4);
+                len = ntohl(len);
+                // kv响应首字节为状态：2表示服务端错误（NOT_FOUND属于正常结果）
+                if(__opt.mode == Mode::kKv and buf.size() > 4 and buf[4] == 2) status = 500;
+                return buf.size() >= 4 + len ? 4 + len : 0;
+            }
+            case Mode::kHttp: {
+                size_t end = buf.find("\r\n\r\n");
+                if(end == std::string_view::npos) return 0;
+                std::string_view head = buf.substr(0, end + 2);
+                status = head.size() > 12 ? std::atoi(head.data() + 9) : 0;
+                size_t body = end + 4;
+                size_t conn = FindHeader(head, "connection");
+                close = conn != std::string_view::npos and head.substr(conn, 5) == "close";
+                size_t cl = FindHeader(head, "content-length");
+                if(cl != std::string_view::npos) {
+                    size_t len = std::strtoull(head.data() + cl, nullptr, 10);
+                    return buf.size() >= body + len ? body + len : 0;
+                }
+                if(FindHeader(head, "transfer-encoding") != std::string_view::npos) {
+                    // 逐块跳过直到长度为0的结束块
+                    size_t pos = body;
+                    while(true) {
+                        size_t line_end = buf.find("\r\n", pos);
+                        if(line_end == std::string_view::npos) return 0;
+                        size_t chunk = std::strtoull(buf.data() + pos, nullptr, 16);
+                        pos = line_end + 2 + chunk + 2;
+                        if(pos > buf.size()) return 0;
+                        if(chunk == 0) return pos;
+                    }
+                }
+                return body;
+            }
+        }
+        return 0;
+    }
+
+    void Open(Conn& c) {
+        c = Conn{};
+        c.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if(__opt.sources > 1) {
+            // 端口推迟到connect时按完整四元组分配，否则bind阶段就会耗尽临时端口
+            setsockopt(c.fd, IPPROTO_IP, IP_BIND_ADDRESS_NO_PORT, &one, sizeof(one));
+            sockaddr_in src{};
+            src.sin_family = AF_INET;
+            src.sin_addr.s_addr = htonl(INADDR_LOOPBACK + __next_source++ % __opt.sources);
+            bind(c.fd, reinterpret_cast<sockaddr*>(&src), sizeof(src));
+        }
+        int ret = connect(c.fd, reinterpret_cast<sockaddr*>(&__addr), sizeof(__addr));
+        if(ret == -1 and errno != EINPROGRESS) {
+            __stats.errors++;
+            close(c.fd);
+            c.fd = -1;
+            return;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT;
+        ev.data.ptr = &c;
+        epoll_ctl(__epfd, EPOLL_CTL_ADD, c.fd, &ev);
+    }
+
+    void Reopen(Conn& c, bool error = true) {
+        if(error) __stats.errors++;
+        else __stats.reconnects++;
+        if(c.fd != -1) close(c.fd);
+        Open(c);
+    }
+
+    uint64_t NextRandom() {
+        // xorshift64*：足够均匀且不成为压测瓶颈
+        __rng ^= __rng >> 12;
+        __rng ^= __rng << 25;
+        __rng ^= __rng >> 27;
+        return __rng * 0x2545f4914f6cdd1dull;
+    }
+
+    // kv请求：op | key长度 | key | value，随机key，按比例选择SET/GET
+    void AppendKvRequest(std::string& out) {
+        char key[32];
+        int key_len = snprintf(key, sizeof(key), "key:%012llu", static_cast<unsigned long long>(NextRandom() % __opt.keys));
+        bool set = static_cast<int>(NextRandom() % 100) < __opt.set_percent;
+        uint32_t len = htonl(static_cast<uint32_t>(3 + key_len + (set ? __kv_value.size() : 0)));
+        uint16_t klen = htons(static_cast<uint16_t>(key_len));
+        out.append(reinterpret_cast<const char*>(&len), 4);
+        out.push_back(set ? 2 : 1);
+        out.append(reinterpret_cast<const char*>(&klen), 2);
+        out.append(key, key_len);
+        if(set) out.append(__kv_value);
+    }
+
+    void Fill(Conn& c) {
+        auto now = Clock::now();
+        while(static_cast<int>(c.inflight.size()) < __opt.depth) {
+            if(__opt.mode == Mode::kKv) AppendKvRequest(c.out);
+            else c.out.append(__request);
+            c.inflight.push_back(now);
+        }
+    }
+
+    bool Flush(Conn& c) {
+        while(c.out_pos < c.out.size()) {
+            ssize_t n = send(c.fd, c.out.data() + c.out_pos, c.out.size() - c.out_pos, MSG_NOSIGNAL);
+            if(n < 0) {
+                if(errno == EAGAIN or errno == EWOULDBLOCK) break;
+                return false;
+            }
+            c.out_pos += n;
+        }
+        if(c.out_pos == c.out.size()) {
+            c.out.clear();
+            c.out_pos = 0;
+        }
+        epoll_event ev{};
+        ev.events = c.out.empty() ? EPOLLIN : (EPOLLIN | EPOLLOUT);
+        ev.data.ptr = &c;
+        epoll_ctl(__epfd, EPOLL_CTL_MOD, c.fd, &ev);
+        return true;
+    }
+
+    bool OnReadable(Conn& c) {
+        char buf[65536];
+        bool eof = false; // 对端关闭前发来的响应仍需统计
+        while(true) {
+            ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+            if(n == 0) {
+                eof = true;
+                break;
+            }
+            if(n < 0) {
+                if(errno == EAGAIN or errno == EWOULDBLOCK) break;
+                return false;
+            }
+            c.in.append(buf, n);
+            __stats.bytes += n;
+        }
+        auto now = Clock::now();
+        bool completed = false;
+        while(!c.inflight.empty()) {
+            int status = 200;
+            bool close = false;
+            size_t len = ResponseLength(std::string_view(c.in).substr(c.in_pos), status, close);
+            if(len == 0) break;
+            c.in_pos += len;
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(now - c.inflight.front()).count();
+            c.inflight.pop_front();
+            __stats.latency.Record(us);
+            __stats.requests++;
+            if(status < 200 or status >= 300) __stats.non2xx++;
+            completed = true;
+            if(close) {
+                // 同一连接上之后的在途请求不会再被处理，丢弃并重连
+                c.closing = true;
+                return false;
+            }
+        }
+        // 已解析部分一次性丢弃，避免每个响应都移动缓冲
+        if(c.in_pos > 0 and (c.in_pos == c.in.size() or c.in_pos > 65536)) {
+            c.in.erase(0, c.in_pos);
+            c.in_pos = 0;
+        }
+        if(eof) return false;
+        if(completed) {
+            Fill(c);
+            return Flush(c);
+        }
+        return true;
+    }
+
+public:
+    explicit Worker(const Options& opt, int conns, uint64_t seed) : __opt(opt), __conns(conns), __rng(seed | 1) {
+        __addr.sin_family = AF_INET;
+        __addr.sin_port = htons(opt.port);
+        inet_pton(AF_INET, opt.host.c_str(), &__addr.sin_addr);
+        switch(opt.mode) {
+            case Mode::kHttp:
+                __request = "GET " + opt.path + " HTTP/1.1\r\nHost: " + opt.host + "\r\n\r\n";
+                break;
+            case Mode::kEcho:
+                __request.assign(opt.size, 'x');
+                break;
+            case Mode::kPacket: {
+                uint32_t len = htonl(static_cast<uint32_t>(opt.size));
+                __request.assign(reinterpret_cast<char*>(&len), 4);
+                __request.append(opt.size, 'x');
+                break;
+            }
+            case Mode::kKv:
+                __kv_value.assign(opt.size, 'v');
+                break;
+        }
+    }
+
+    void Run(Clock::time_point deadline) {
+        __epfd = epoll_create1(EPOLL_CLOEXEC);
+        for(auto& c : __conns) Open(c);
+        std::vector<epoll_event> events(1024);
+        while(Clock::now() < deadline) {
+            int nfds = epoll_wait(__epfd, events.data(), events.size(), 100);
+            for(int i = 0; i < nfds; i++) {
+                Conn& c = *static_cast<Conn*>(events[i].data.ptr);
+                uint32_t ev = events[i].events;
+                if(ev & (EPOLLERR | EPOLLHUP) and !(ev & EPOLLIN)) {
+                    Reopen(c);
+                    continue;
+                }
+                if(!c.connected and (ev & EPOLLOUT)) {
+                    int err = 0;
+                    socklen_t len = sizeof(err);
+                    getsockopt(c.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                    if(err != 0) {
+                        Reopen(c);
+                        continue;
+                    }
+                    c.connected = true;
+                    Fill(c);
+                }
+                if((ev & EPOLLIN) and !OnReadable(c)) {
+                    Reopen(c, !c.closing);
+                    continue;
+                }
+                if((ev & EPOLLOUT) and !Flush(c)) Reopen(c);
+            }
+        }
+        for(auto& c : __conns) {
+            if(c.fd != -1) close(c.fd);
+        }
+        close(__epfd);
+    }
+
+    const WorkerStats& Stats() const { return __stats; }
+};
+
+static void Usage(const char* prog)
+{
+    std::cerr << "Usage: " << prog << " [-H host] [-p port] [-c conns] [-t threads] [-d seconds]"
+              << " [-m http|echo|packet|kv] [-D depth] [-s size] [-r reply_size] [-u path] [-k keys] [-w set%] [-b sources] [-C]" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    signal(SIGPIPE, SIG_IGN);
+    Options opt;
+    int ch;
+    while((ch = getopt(argc, argv, "H:p:c:t:d:m:D:s:r:u:k:w:b:C")) != -1) {
+        switch(ch) {
+            case 'H': opt.host = optarg; break;
+            case 'p': opt.port = static_cast<uint16_t>(std::stoi(optarg)); break;
+            case 'c': opt.conns = std::stoi(optarg); break;
+            case 't': opt.threads = std::stoi(optarg); break;
+            case 'd': opt.duration = std::stoi(optarg); break;
+            case 'm': {
+                std::string m = optarg;
+                if(m == "http") opt.mode = Mode::kHttp;
+                else if(m == "echo") opt.mode = Mode::kEcho;
+                else if(m == "packet") opt.mode = Mode::kPacket;
+                else if(m == "kv") opt.mode = Mode::kKv;
+                else { Usage(argv[0]); return 1; }
+                break;
+            }
+            case 'D': opt.depth = std::max(1, std::stoi(optarg)); break;
+            case 's': opt.size = std::stoul(optarg); break;
+            case 'r': opt.reply_size = std::stoul(optarg); break;
+            case 'u': opt.path = optarg; break;
+            case 'k': opt.keys = std::max<uint64_t>(1, std::stoull(optarg)); break;
+            case 'w': opt.set_percent = std::clamp(std::stoi(optarg), 0, 100); break;
+            case 'b': opt.sources = std::clamp(std::stoi(optarg), 1, 254); break;
+            case 'C': opt.csv = true; break;
+            default: Usage(argv[0]); return 1;
+        }
+    }
+    opt.threads = std::max(1, std::min(opt.threads, opt.conns));
+
+    const char* mode_name = opt.mode == Mode::kHttp ? "http" : opt.mode == Mode::kEcho ? "echo"
+                          : opt.mode == Mode::kPacket ? "packet" : "kv";
+    if(!opt.csv) {
+        std::cout << "Running " << opt.duration << "s test @ " << opt.host << ":" << opt.port << " (" << mode_name << ")\n"
+                  << "  " << opt.threads << " threads and " << opt.conns << " connections, pipeline depth " << opt.depth << std::endl;
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for(int i = 0; i < opt.threads; i++) {
+        int conns = opt.conns / opt.threads + (i < opt.conns % opt.threads ? 1 : 0);
+        workers.emplace_back(std::make_unique<Worker>(opt, conns, 0x9e3779b97f4a7c15ull * (i + 1)));
+    }
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::seconds(opt.duration);
+    std::vector<std::thread> threads;
+    for(auto& w : workers) threads.emplace_back([&w, deadline]() { w->Run(deadline); });
+    for(auto& t : threads) t.join();
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+    WorkerStats total;
+    for(auto& w : workers) {
+        const WorkerStats& s = w->Stats();
+        total.latency.Merge(s.latency);
+        total.requests += s.requests;
+        total.errors += s.errors;
+        total.reconnects += s.reconnects;
+        total.non2xx += s.non2xx;
+        total.bytes += s.bytes;
+    }
+    double rps = total.requests / secs;
+    double mbps = total.bytes / secs / (1024.0 * 1024.0);
+
+    if(opt.csv) {
+        // mode,conns,depth,size,requests,errors,rps,MB/s,p50,p90,p99,p999,max（延迟单位微秒）
+        std::cout << mode_name << "," << opt.conns << "," << opt.depth << "," << opt.size << ","
+                  << total.requests << "," << total.errors << "," << std::fixed << std::setprecision(1) << rps << ","
+                  << std::setprecision(2) << mbps << "," << total.latency.Percentile(50) << ","
+                  << total.latency.Percentile(90) << "," << total.latency.Percentile(99) << ","
+                  << total.latency.Percentile(99.9) << "," << total.latency.Max() << std::endl;
+        return 0;
+    }
+    std::cout << "  Latency(us)  p50 " << total.latency.Percentile(50)
+              << "  p90 " << total.latency.Percentile(90)
+              << "  p99 " << total.latency.Percentile(99)
+              << "  p99.9 " << total.latency.Percentile(99.9)
+              << "  max " << total.latency.Max() << "\n"
+              << "  " << total.requests << " requests in " << std::fixed << std::setprecision(2) << secs << "s, "
+              << mbps * secs << " MB read\n";
+    if(total.errors) std::cout << "  Socket errors/reconnects: " << total.errors << "\n";
+    if(total.reconnects) std::cout << "  Server-closed reconnects: " << total.reconnects << "\n";
+    if(total.non2xx) std::cout << "  Non-2xx responses: " << total.non2xx << "\n";
+    std::cout << "Requests/sec: " << std::setprecision(1) << rps << "\n"
+              << "Transfer/sec: " << std::setprecision(2) << mbps << " MB" << std::endl;
+    return 0;
+}
@@ -0,0 +1,107 @@
+// 流水线深度基准：一条连接上保持depth个在途请求（1、2、4 ... 256），每完成一个立即补发一个，
+// 统计每个深度下的吞吐与延迟分位数。depth=1 即 package_client 的一问一答模式
+// 用法: ./pipeline_bench [host] [port] [每个深度的秒数，默认3] [payload字节数，默认64]
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "pipeline_client.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct DepthResult {
+    uint64_t completed = 0;
+    uint64_t errors = 0;
+    double seconds = 0;
+    std::vector<double> latency_us;
+};
+
+// 回调都在客户端的接收线程中执行，不需要加锁；只有结束时的通知需要
+class DepthRun {
+private:
+    PipelineClient& __client;
+    std::string __payload;
+    Clock::time_point __deadline;
+    DepthResult __result;
+    int __outstanding = 0;
+    std::mutex __mtx;
+    std::condition_variable __cv;
+    bool __done = false;
+
+    void Issue() {
+        auto start = Clock::now();
+        __client.Call(__payload, [this, start](PipelineResponse resp) { OnResponse(resp, start); });
+    }
+
+    void OnResponse(const PipelineResponse& resp, Clock::time_point start) {
+        auto now = Clock::now();
+        if(resp.ok()) {
+            __result.completed++;
+            __result.latency_us.push_back(std::chrono::duration<double, std::micro>(now - start).count());
+        } else {
+            __result.errors++;
+        }
+        if(now < __deadline and __client.Connected()) {
+            Issue();
+            return;
+        }
+        if(--__outstanding == 0) {
+            std::lock_guard<std::mutex> lock(__mtx);
+            __done = true;
+            __cv.notify_one();
+        }
+    }
+
+public:
+    DepthRun(PipelineClient& client, std::string payload) : __client(client), __payload(std::move(payload)) {}
+
+    DepthResult Run(int depth, std::chrono::seconds duration) {
+        auto start = Clock::now();
+        __deadline = start + duration;
+        __outstanding = depth;
+        __result.latency_us.reserve(1 << 20);
+        for(int i = 0; i < depth; i++) Issue();
+        std::unique_lock<std::mutex> lock(__mtx);
+        __cv.wait(lock, [this]() { return __done; });
+        __result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::sort(__result.latency_us.begin(), __result.latency_us.end());
+        return std::move(__result);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+    uint16_t port = argc > 2 ? static_cast<uint16_t>(std::stoi(argv[2])) : 9999;
+    int seconds = argc > 3 ? std::stoi(argv[3]) : 3;
+    size_t payload_size = argc > 4 ? std::stoul(argv[4]) : 64;
+
+    std::cout << "pipeline bench @ " << host << ":" << port << ", " << payload_size << "B payload, "
+              << seconds << "s per depth\n\n"
+              << std::setw(6) << "depth" << std::setw(14) << "req/s" << std::setw(10) << "p50" << std::setw(10) << "p99"
+              << std::setw(10) << "p99.9" << "  (us)" << std::endl;
+    try {
+        for(int depth = 1; depth <= 256; depth *= 2) {
+            // 每个深度用新连接，避免上一轮的尾部响应干扰
+            PipelineClient client(host, port);
+            DepthRun run(client, std::string(payload_size, 'x'));
+            DepthResult r = run.Run(depth, std::chrono::seconds(seconds));
+            auto pct = [&r](double p) {
+                return r.latency_us.empty() ? 0.0 : r.latency_us[static_cast<size_t>(p / 100 * (r.latency_us.size() - 1))];
+            };
+            std::cout << std::setw(6) << depth << std::fixed << std::setprecision(0) << std::setw(14) << r.completed / r.seconds
+                      << std::setw(10) << pct(50) << std::setw(10) << pct(99) << std::setw(10) << pct(99.9);
+            if(r.errors) std::cout << "  errors " << r.errors;
+            std::cout << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+// 流水线客户端（v2帧，见 frame.h）：一条连接上同时发出多个请求，不等待前一个响应；
+// 独立的接收线程按请求id把响应交给对应的future或回调，响应可以乱序到达。
+// 发送采用合并写：并发调用者把帧追加到同一缓冲，正在发送的线程顺带把后来者的数据一起发出
+//
+//   PipelineClient client("127.0.0.1", 9999);
+//   auto f1 = client.Call("a");                 // future接口
+//   client.Call("b", [](PipelineResponse r) {}); // 回调接口，在接收线程中执行，不要在其中阻塞
+//   std::cout << f1.get().payload;
+
+#ifndef PIPELINE_CLIENT_H
+#define PIPELINE_CLIENT_H
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "frame.h"
+
+struct PipelineResponse {
+    uint64_t id = 0;
+    uint8_t flags = 0;
+    std::string payload;
+    bool ok() const { return !(flags & kFrameError); }
+};
+
+class PipelineClient {
+public:
+    using Callback = std::function<void(PipelineResponse)>;
+
+private:
+    int __fd = -1;
+    std::atomic<uint64_t> __next_id{1};
+    std::atomic<bool> __closed{false};
+
+    std::mutex __pending_mtx;
+    std::unordered_map<uint64_t, Callback> __pending;
+
+    std::mutex __write_mtx;
+    std::string __out;
+    bool __flushing = false;
+
+    std::thread __reader;
+
+    bool SendAll(const std::string& data) {
+        size_t sent = 0;
+        while(sent < data.size()) {
+            ssize_t n = send(__fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if(n == -1 and errno == EINTR) continue;
+            if(n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    // 追加一帧；没有线程在发送时由本线程循环发送，直到缓冲为空
+    void Write(uint64_t id, uint8_t flags, std::string_view payload) {
+        std::unique_lock<std::mutex> lock(__write_mtx);
+        AppendFrame(__out, id, flags, payload);
+        if(__flushing) return;
+        __flushing = true;
+        while(!__out.empty()) {
+            std::string data;
+            data.swap(__out);
+            lock.unlock();
+            bool ok = SendAll(data);
+            lock.lock();
+            if(!ok) {
+                __out.clear();
+                shutdown(__fd, SHUT_RDWR); // 接收线程随之退出并让所有在途请求失败
+                break;
+            }
+        }
+        __flushing = false;
+    }
+
+    void Complete(PipelineResponse&& resp) {
+        Callback cb;
+        {
+            std::lock_guard<std::mutex> lock(__pending_mtx);
+            auto it = __pending.find(resp.id);
+            if(it == __pending.end()) return;
+            cb = std::move(it->second);
+            __pending.erase(it);
+        }
+        cb(std::move(resp));
+    }
+
+    void ReadLoop() {
+        std::vector<char> buf(64 * 1024);
+        size_t len = 0;
+        while(true) {
+            if(len == buf.size()) buf.resize(buf.size() * 2);
+            ssize_t n = recv(__fd, buf.data() + len, buf.size() - len, 0);
+            if(n == -1 and errno == EINTR) continue;
+            if(n <= 0) break;
+            len += n;
+            size_t pos = 0;
+            Frame frame;
+            ssize_t used;
+            while((used = ParseFrame(buf.data() + pos, len - pos, frame)) > 0) {
+                Complete(PipelineResponse{frame.id, frame.flags, std::string(frame.payload)});
+                pos += used;
+            }
+            if(used < 0) break;
+            memmove(buf.data(), buf.data() + pos, len - pos);
+            len -= pos;
+        }
+        // 连接断开：所有在途请求以错误完成
+        __closed.store(true);
+        std::unordered_map<uint64_t, Callback> pending;
+        {
+            std::lock_guard<std::mutex> lock(__pending_mtx);
+            pending.swap(__pending);
+        }
+        for(auto& [id, cb] : pending) cb(PipelineResponse{id, kFrameResponse | kFrameError, "connection closed"});
+    }
+
+public:
+    PipelineClient(const std::string& host, uint16_t port) {
+        __fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(__fd == -1) throw std::runtime_error(std::string("socket failed: ") + strerror(errno));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if(inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1 or
+           connect(__fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+            int err = errno;
+            close(__fd);
+            throw std::runtime_error("connect " + host + ":" + std::to_string(port) + " failed: " + strerror(err));
+        }
+        int one = 1;
+        setsockopt(__fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        __reader = std::thread([this]() { ReadLoop(); });
+    }
+
+    PipelineClient(const PipelineClient&) = delete;
+    PipelineClient& operator=(const PipelineClient&) = delete;
+
+    ~PipelineClient() noexcept {
+        Close();
+        if(__reader.joinable()) __reader.join();
+        close(__fd);
+    }
+
+    // 关闭连接，在途请求以错误完成
+    void Close() { shutdown(__fd, SHUT_RDWR); }
+
+    bool Connected() const { return !__closed.load(); }
+
+    size_t InFlight() {
+        std::lock_guard<std::mutex> lock(__pending_mtx);
+        return __pending.size();
+    }
+
+    // 回调在接收线程中执行（连接已断开时立即在当前线程以错误执行），返回请求id
+    uint64_t Call(std::string_view payload, Callback cb) {
+        uint64_t id = __next_id.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(__pending_mtx);
+            if(!__closed.load()) {
+                __pending.emplace(id, std::move(cb));
+                cb = nullptr;
+            }
+        }
+        if(cb) {
+            cb(PipelineResponse{id, kFrameResponse | kFrameError, "connection closed"});
+            return id;
+        }
+        Write(id, 0, payload);
+        return id;
+    }
+
+    std::future<PipelineResponse> Call(std::string_view payload) {
+        auto promise = std::make_shared<std::promise<PipelineResponse>>();
+        auto future = promise->get_future();
+        Call(payload, [promise](PipelineResponse resp) { promise->set_value(std::move(resp)); });
+        return future;
+    }
+
+    // 不需要响应的请求
+    void Send(std::string_view payload) {
+        Write(__next_id.fetch_add(1, std::memory_order_relaxed), kFrameOneway, payload);
+    }
+};
+
+#endif // PIPELINE_CLIENT_H
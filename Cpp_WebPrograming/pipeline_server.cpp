@@ -0,0 +1,170 @@
+// 流水线请求服务器：v2帧（frame.h）的每个请求单独交给业务线程池，谁先完成谁先回复（按请求id匹配）；
+// 兼容 package_client 的v1帧（4字节长度前缀）：v1没有请求id，同一连接的请求依次排队，由一个业务线程按序处理
+// 请求payload为 "sleep:<毫秒> ..." 时业务线程先睡眠，用于观察乱序完成
+// 用法: ./pipeline_server [port] [从Reactor数] [业务线程数]
+#include <iostream>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <deque>
+#include <vector>
+
+#include "reactor.h"
+#include "frame.h"
+
+// 连接状态：version在从Reactor中确定，其余由业务线程与从Reactor共享
+struct PipelineSession {
+    int version = 0;                  // 0：尚未收到数据
+    std::atomic<int> in_flight{0};
+    std::mutex mtx;
+    std::string out;                  // 已完成、待发送的响应，合并后一次投递给从Reactor
+    bool flush_queued = false;
+    std::deque<std::string> v1_requests; // v1：待处理的请求，按到达顺序
+    bool v1_running = false;             // v1：已有业务线程在处理本连接的队列
+};
+using PipelineSessionPtr = std::shared_ptr<PipelineSession>;
+
+static constexpr int kMaxInFlight = 4096; // 单连接在途请求上限：v2超出直接回复错误，v1排队超出时关闭连接
+
+static std::string Handle(std::string_view payload)
+{
+    if(payload.substr(0, 6) == "sleep:") {
+        int ms = atoi(std::string(payload.substr(6, 8)).c_str());
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+    return "服务器已收到：" + std::string(payload);
+}
+
+// 业务线程调用：追加到连接的待发送缓冲，只有第一个追加者向从Reactor投递发送任务
+static void Reply(const ConnectionPtr& conn, const PipelineSessionPtr& session, uint64_t id, uint8_t flags, std::string_view payload)
+{
+    {
+        std::lock_guard<std::mutex> lock(session->mtx);
+        AppendFrame(session->out, id, flags, payload);
+        if(session->flush_queued) return;
+        session->flush_queued = true;
+    }
+    conn->GetLoop()->QueueInLoop([conn, session]() {
+        std::string data;
+        {
+            std::lock_guard<std::mutex> lock(session->mtx);
+            data.swap(session->out);
+            session->flush_queued = false;
+        }
+        conn->Send(std::move(data)); // 排空中（kDisconnecting）的连接也要把响应发完，已断开的连接Send会忽略
+    });
+}
+
+// 业务线程中依次处理v1队列直到取空；同一时刻每个连接最多一个这样的任务，响应按请求顺序投递
+static void DrainV1(const ConnectionPtr& conn, const PipelineSessionPtr& session)
+{
+    while(true) {
+        std::string payload;
+        {
+            std::lock_guard<std::mutex> lock(session->mtx);
+            if(session->v1_requests.empty()) {
+                session->v1_running = false;
+                return;
+            }
+            payload = std::move(session->v1_requests.front());
+            session->v1_requests.pop_front();
+        }
+        std::string resp = Handle(payload);
+        uint32_t resp_len = htonl(static_cast<uint32_t>(resp.size()));
+        std::string out(reinterpret_cast<const char*>(&resp_len), 4);
+        out.append(resp);
+        conn->Send(std::move(out));
+    }
+}
+
+static void OnMessageV1(const ConnectionPtr& conn, const PipelineSessionPtr& session, Buffer* buf)
+{
+    std::vector<std::string> requests;
+    while(buf->ReadableBytes() >= 4) {
+        uint32_t len;
+        memcpy(&len, buf->Peek(), 4);
+        len = ntohl(len);
+        if(len > kFrameMaxPayload) {
+            conn->ForceClose();
+            return;
+        }
+        if(buf->ReadableBytes() < 4 + len) break;
+        requests.emplace_back(buf->Peek() + 4, len);
+        buf->Retrieve(4 + len);
+    }
+    if(requests.empty()) return;
+    // Handle可能睡眠，不能在从Reactor里执行，否则同一loop上的所有连接都被阻塞
+    {
+        std::lock_guard<std::mutex> lock(session->mtx);
+        if(session->v1_requests.size() + requests.size() > static_cast<size_t>(kMaxInFlight)) {
+            std::cerr << "[Warning] Too many v1 requests queued by client " << conn->fd() << ", closing." << std::endl;
+            conn->ForceClose();
+            return;
+        }
+        for(auto& r : requests) session->v1_requests.push_back(std::move(r));
+        if(session->v1_running) return;
+        session->v1_running = true;
+    }
+    conn->SubmitWork([conn, session]() { DrainV1(conn, session); });
+}
+
+static void OnMessageV2(const ConnectionPtr& conn, const PipelineSessionPtr& session, Buffer* buf)
+{
+    std::string rejected;
+    Frame frame;
+    ssize_t n;
+    while((n = ParseFrame(buf->Peek(), buf->ReadableBytes(), frame)) > 0) {
+        bool oneway = frame.flags & kFrameOneway;
+        if(!oneway and session->in_flight.fetch_add(1, std::memory_order_relaxed) >= kMaxInFlight) {
+            session->in_flight.fetch_sub(1, std::memory_order_relaxed);
+            AppendFrame(rejected, frame.id, kFrameResponse | kFrameError, "too many requests in flight");
+        } else {
+            conn->SubmitWork([conn, session, id = frame.id, oneway, payload = std::string(frame.payload)]() {
+                std::string resp = Handle(payload);
+                if(oneway) return;
+                session->in_flight.fetch_sub(1, std::memory_order_relaxed);
+                Reply(conn, session, id, kFrameResponse, resp);
+            });
+        }
+        buf->Retrieve(n);
+    }
+    if(!rejected.empty()) conn->Send(std::move(rejected));
+    if(n < 0) {
+        std::cerr << "[Warning] Bad frame from client " << conn->fd() << ", closing." << std::endl;
+        conn->ForceClose();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    signal(SIGPIPE, SIG_IGN);
+    SignalWatcher::BlockSignals({SIGINT, SIGTERM}); // 必须在创建任何线程之前
+
+    uint16_t port = argc > 1 ? static_cast<uint16_t>(std::stoi(argv[1])) : 9999;
+    int sub_reactors = argc > 2 ? std::stoi(argv[2]) : 4;
+    int workers = argc > 3 ? std::stoi(argv[3]) : 8;
+
+    try {
+        TCPServer server(port, sub_reactors, workers);
+        server.SetConnectionCallback([](const ConnectionPtr& conn) {
+            if(conn->Connected()) conn->SetContext(std::make_shared<PipelineSession>());
+        });
+        server.SetMessageCallback([](const ConnectionPtr& conn, Buffer* buf) {
+            auto session = std::any_cast<PipelineSessionPtr>(conn->Context());
+            if(session->version == 0) session->version = static_cast<uint8_t>(*buf->Peek()) == kFrameMagic ? 2 : 1;
+            if(session->version == 2) OnMessageV2(conn, session, buf);
+            else OnMessageV1(conn, session, buf);
+        });
+        SignalWatcher term(server.MainReactor(), {SIGINT, SIGTERM}, [&server](int) {
+            server.GracefulStop(std::chrono::seconds(5));
+        });
+        std::cout << "[Info] Pipeline server started on port " << port << ", " << sub_reactors << " sub reactors, "
+                  << workers << " workers" << std::endl;
+        server.start();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+    return 0;
+}
@@ -1,12 +1,12 @@
 // BBL DRIZZY
 #include "threadpool.h"
+#include "fd_registry.h"
 #include <iostream>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <sys/select.h>
 #include <unistd.h>
 #include <string>
-#include <unordered_set>
 #include <algorithm>
 #include <thread>
 #include <signal.h>
@@ -23,34 +23,24 @@ private:
     int server_fd;
     std::atomic<bool> is_running;
     const uint16_t server_port;
-    std::vector<pollfd> fds;          // 仅存储有效fd的pollfd，下标无需和fd对应
-    std::unordered_set<int> client_fds; 
-    std::mutex mtx;
+    FdRegistry registry;              // 监听fd和所有客户端fd；pollfd数组由poll线程独占，增删在两次poll之间批量生效
     ThreadPool pool;
 
-    // 查找监听fd在fds中的索引（仅主线程调用，无需加锁）
-    int find_listen_fd_idx() const 
+    // 关闭所有客户端fd（poll线程或poll线程退出后调用）
+    void close_clients()
     {
-        for(size_t i=0;i<fds.size();i++)
-            if(fds[i].fd == server_fd) return i;
-        return -1;
-    }
-    // 查找客户端fd在fds中的索引（加锁后调用）
-    int find_client_fd_idx(int fd) const
-    {
-        for(size_t i=0;i<fds.size();i++) 
-            if(fds[i].fd == fd)  return i;
-        return -1;
+        registry.Apply();
+        std::vector<pollfd> fds = registry.PollFds();
+        for(const pollfd& pfd : fds)
+            if(pfd.fd != server_fd) disconnect(pfd.fd);
+        registry.Apply();
     }
 
     void error(const std::string& msg, bool CloseServer = true)
     {
-        std::unique_lock<std::mutex> lock(mtx);
         std::cerr << "[Error] " << msg << std::endl;
         // 清理客户端fd
-        for(int fd : client_fds) if(fd != -1) close(fd);
-        client_fds.clear();
-        fds.clear();
+        close_clients();
         // 关闭服务器fd
         if(CloseServer && server_fd != -1)
         {
@@ -61,6 +51,12 @@ private:
         throw std::runtime_error(msg);
     }
 
+    void disconnect(int fd)
+    {
+        close(fd);
+        registry.Remove(fd);
+    }
+
 public:
     explicit TCPServer(const uint16_t _port) 
         : server_port(_port), server_fd(-1), is_running(true), pool(10) {}
@@ -68,11 +64,8 @@ public:
     ~TCPServer() noexcept
     {
         stop();
-        std::unique_lock<std::mutex> lock(mtx);
         // 清理所有客户端fd
-        for(int fd : client_fds) if(fd != -1) close(fd);
-        client_fds.clear();
-        fds.clear();
+        close_clients();
         // 关闭服务器fd
         if(server_fd != -1) 
         {
@@ -115,7 +108,7 @@ public:
         }
 
         // 初始化pollfd数组：仅加入监听fd
-        fds.push_back({server_fd, POLLIN, 0});
+        registry.Add(server_fd, POLLIN);
         std::cout << "Server is currently listening on port: " << server_port << std::endl; 
     }
 
@@ -128,14 +121,13 @@ public:
             return;
         }
 
-        std::unique_lock<std::mutex> lock(mtx);
-        // 将新客户端fd加入poll监听和客户端集合
-        fds.push_back({client_fd, POLLIN, 0});
-        client_fds.insert(client_fd);
-        std::cout << "[Info] New client connected: " << client_fd << " (total clients: " << client_fds.size() << ")" << std::endl;
+        // 将新客户端fd加入poll监听（下一次poll前生效）
+        registry.Add(client_fd, POLLIN);
+        std::cout << "[Info] New client connected: " << client_fd << " (total clients: " << registry.Size() - 1 << ")" << std::endl;
     }
 
-    void client_communicate(int fd)
+    // 返回false表示连接已关闭
+    bool client_communicate(int fd)
     {
         char buffer[1024]{};
         ssize_t len = recv(fd, buffer, sizeof(buffer) - 1, 0);
@@ -144,13 +136,9 @@ public:
         if(len <= 0)
         {
             std::cout << "[Info] Client " << fd << " disconnected" << std::endl;
-            std::unique_lock<std::mutex> lock(mtx);
             // 关闭fd并清理资源
-            close(fd);
-            int idx = find_client_fd_idx(fd);
-            if(idx != -1) fds.erase(fds.begin() + idx);
-            client_fds.erase(fd);
-            return;
+            disconnect(fd);
+            return false;
         }
 
         // 读取到数据，提交到线程池处理
@@ -169,6 +157,7 @@ public:
             }
 
         });
+        return true;
     }
 
     void poll_loop()
@@ -176,6 +165,9 @@ public:
         std::cout << "[Info] Server is waiting for client connections..." << std::endl;
         while(is_running)
         {   
+            // 上一轮积累的增删在这里统一生效，之后直接对pollfd数组poll，无需加锁或拷贝
+            registry.Apply();
+            std::vector<pollfd>& fds = registry.PollFds();
             int cnt = poll(fds.data(),fds.size(),1000); // 1秒超时，避免永久阻塞
             // poll调用失败
             if(cnt == -1)
@@ -189,15 +181,12 @@ public:
                 continue;
             }
             if(cnt == 0) continue;
-            // 遍历所有pollfd，处理事件（复制fds避免遍历中修改）
-            std::vector<pollfd> fds_copy;
-            {
-                std::unique_lock<std::mutex> lock(mtx);
-                fds_copy = fds;
-            }
-            for(const auto& pfd : fds_copy)
+            // 遍历所有pollfd，处理事件；期间的增删只是登记，不会改动正在遍历的数组
+            for(const auto& pfd : fds)
             {
+                if(cnt == 0) break; // 就绪的fd都处理完了
                 if(pfd.revents == 0) continue;
+                cnt--;
                 // 处理读事件
                 if(pfd.revents & POLLIN)
                 {
@@ -205,21 +194,17 @@ public:
                     {
                         new_client(); // 新连接
                     } 
-                    else 
+                    else if(!client_communicate(pfd.fd)) // 客户端数据
                     {
-                        client_communicate(pfd.fd); // 客户端数据
+                        continue; // 已断开，不再处理错误事件
                     }
                 }
 
                 // 处理错误事件
-                if(pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) 
+                if(pfd.fd != server_fd and (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)))
                 {
                     std::cout << "[Info] Client " << pfd.fd << " error, disconnecting" << std::endl;
-                    std::unique_lock<std::mutex> lock(mtx);
-                    close(pfd.fd);
-                    int idx = find_client_fd_idx(pfd.fd);
-                    if(idx != -1) fds.erase(fds.begin() + idx);
-                    client_fds.erase(pfd.fd);
+                    disconnect(pfd.fd);
                 }
             }
         }
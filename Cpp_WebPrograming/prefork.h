@@ -0,0 +1,301 @@
+// 多进程prefork：master 按CPU核数 fork+exec 出N个worker进程，每个worker是完整的Reactor服务器，
+// 各自创建SO_REUSEPORT监听socket，由内核在各进程的accept队列间分发新连接。
+// 进程间不共享堆与锁，单个worker崩溃不影响其他worker，master负责回收与重启。
+//
+// master 信号：
+//   SIGINT/SIGTERM  向所有worker转发SIGTERM（优雅退出），超过deadline后SIGKILL
+//   SIGHUP          滚动重启：逐个拉起新worker（exec当前磁盘上的可执行文件），新worker就绪后旧worker优雅退出
+// worker 崩溃后立即重启；启动后1秒内即退出视为启动失败，按指数退避延迟重启（最多10秒）
+
+#ifndef PREFORK_H
+#define PREFORK_H
+
+#include <sys/prctl.h>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+#include <sched.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern char** environ;
+
+class PreforkMaster {
+    using Clock = std::chrono::steady_clock;
+private:
+    static constexpr const char* kWorkerEnv = "CPPBACKEND_WORKER";
+    static constexpr const char* kReadyEnv = "CPPBACKEND_READY_FD";
+
+    struct Worker {
+        pid_t pid = -1;
+        pid_t replacing = -1;         // 滚动重启中：新worker就绪后需要退出的旧worker
+        Clock::time_point started;
+        int fast_failures = 0;        // 连续启动失败次数
+        Clock::time_point respawn_at; // pid == -1 时的重启时间
+    };
+
+    std::vector<std::string> __argv;
+    std::vector<Worker> __workers;
+    std::set<pid_t> __retiring; // 已发送SIGTERM、等待退出的旧worker
+    std::chrono::milliseconds __deadline;
+    pid_t __master_pid;
+    int __sig_fd = -1;
+    int __ready_pipe[2] = {-1, -1};
+    bool __stopping = false;
+    Clock::time_point __kill_at;
+
+    void Spawn(size_t idx) {
+        // 子进程在exec前只调用异步信号安全函数，参数提前准备好
+        std::vector<std::string> env_storage;
+        for(char** e = environ; *e; e++) {
+            if(strncmp(*e, kWorkerEnv, strlen(kWorkerEnv)) != 0 and strncmp(*e, kReadyEnv, strlen(kReadyEnv)) != 0)
+                env_storage.emplace_back(*e);
+        }
+        env_storage.push_back(std::string(kWorkerEnv) + "=" + std::to_string(idx));
+        env_storage.push_back(std::string(kReadyEnv) + "=" + std::to_string(__ready_pipe[1]));
+        std::vector<char*> envp, argv;
+        for(auto& e : env_storage) envp.push_back(e.data());
+        envp.push_back(nullptr);
+        for(auto& a : __argv) argv.push_back(a.data());
+        argv.push_back(nullptr);
+
+        Worker& w = __workers[idx];
+        pid_t pid = fork();
+        if(pid == 0) {
+            // master 意外退出时worker收到SIGTERM优雅退出，不会成为无人管理的孤儿
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+            if(getppid() != __master_pid) _exit(1);
+            fcntl(__ready_pipe[1], F_SETFD, 0);
+            sigset_t empty;
+            sigemptyset(&empty);
+            sigprocmask(SIG_SETMASK, &empty, nullptr);
+            execvpe(argv[0], argv.data(), envp.data());
+            _exit(127);
+        }
+        if(pid == -1) {
+            perror("[Master] Failed to fork worker!");
+            w.respawn_at = Clock::now() + std::chrono::seconds(1);
+            return;
+        }
+        w.pid = pid;
+        w.started = Clock::now();
+        std::cout << "[Master] Worker " << idx << " started, pid " << pid << std::endl;
+    }
+
+    void Reap() {
+        int status;
+        pid_t pid;
+        while((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            if(__retiring.erase(pid)) {
+                std::cout << "[Master] Old worker " << pid << " exited." << std::endl;
+                continue;
+            }
+            // 滚动重启中被替换的旧worker在新worker就绪前就退出了：清掉记录，否则HandleReady会去kill一个可能已被复用的pid
+            auto old = std::find_if(__workers.begin(), __workers.end(), [pid](const Worker& w) { return w.replacing == pid; });
+            if(old != __workers.end()) {
+                std::cout << "[Master] Old worker " << pid << " exited before its replacement was ready." << std::endl;
+                old->replacing = -1;
+                continue;
+            }
+            auto it = std::find_if(__workers.begin(), __workers.end(), [pid](const Worker& w) { return w.pid == pid; });
+            if(it == __workers.end()) continue;
+            size_t idx = it - __workers.begin();
+            if(WIFSIGNALED(status))
+                std::cout << "[Master] Worker " << idx << " (pid " << pid << ") killed by signal " << WTERMSIG(status) << std::endl;
+            else
+                std::cout << "[Master] Worker " << idx << " (pid " << pid << ") exited with status " << WEXITSTATUS(status) << std::endl;
+            it->pid = -1;
+            if(__stopping) continue;
+            auto now = Clock::now();
+            it->fast_failures = now - it->started < std::chrono::seconds(1) ? it->fast_failures + 1 : 0;
+            auto backoff = it->fast_failures ? std::min<std::chrono::milliseconds>(
+                std::chrono::milliseconds(100 << std::min(it->fast_failures, 7)), std::chrono::seconds(10)) : std::chrono::milliseconds(0);
+            it->respawn_at = now + backoff;
+            if(backoff.count()) std::cout << "[Master] Worker " << idx << " failing fast, respawn in " << backoff.count() << "ms" << std::endl;
+        }
+    }
+
+    // worker就绪：若它替换的是旧worker，此时让旧worker退出，保证监听组内始终有进程在accept
+    void HandleReady() {
+        pid_t pids[64];
+        ssize_t n = read(__ready_pipe[0], pids, sizeof(pids));
+        for(ssize_t i = 0; i + static_cast<ssize_t>(sizeof(pid_t)) <= n; i += sizeof(pid_t)) {
+            pid_t pid = pids[i / sizeof(pid_t)];
+            for(auto& w : __workers) {
+                if(w.pid != pid or w.replacing == -1) continue;
+                kill(w.replacing, SIGTERM);
+                __retiring.insert(w.replacing);
+                w.replacing = -1;
+            }
+        }
+    }
+
+    void Reload() {
+        std::cout << "[Master] Rolling restart of " << __workers.size() << " workers..." << std::endl;
+        for(size_t i = 0; i < __workers.size(); i++) {
+            Worker& w = __workers[i];
+            if(w.pid == -1) continue;
+            if(w.replacing != -1) {
+                // 上一次重载的新worker尚未就绪，直接替换它
+                kill(w.pid, SIGTERM);
+                __retiring.insert(w.pid);
+            } else {
+                w.replacing = w.pid;
+            }
+            w.fast_failures = 0;
+            Spawn(i);
+        }
+    }
+
+    void Stop() {
+        if(__stopping) return;
+        __stopping = true;
+        __kill_at = Clock::now() + __deadline + std::chrono::seconds(1);
+        for(auto& w : __workers) {
+            if(w.replacing != -1) __retiring.insert(w.replacing);
+            w.replacing = -1;
+        }
+        std::cout << "[Master] Stopping workers..." << std::endl;
+        ForEachChild([](pid_t pid) { kill(pid, SIGTERM); });
+    }
+
+    template <typename F>
+    void ForEachChild(F f) const {
+        for(auto& w : __workers) {
+            if(w.pid != -1) f(w.pid);
+        }
+        for(pid_t pid : __retiring) f(pid);
+    }
+
+    bool HasChildren() const {
+        return !__retiring.empty() or std::any_of(__workers.begin(), __workers.end(), [](const Worker& w) { return w.pid != -1; });
+    }
+
+    // 距下一次需要处理的定时事件（重启或强杀）的毫秒数，-1表示无
+    int NextTimeout() const {
+        auto now = Clock::now();
+        Clock::time_point next = Clock::time_point::max();
+        if(__stopping) next = __kill_at;
+        else {
+            for(auto& w : __workers) {
+                if(w.pid == -1) next = std::min(next, w.respawn_at);
+            }
+        }
+        if(next == Clock::time_point::max()) return -1;
+        if(next <= now) return 0;
+        return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count()) + 1;
+    }
+
+public:
+    // worker进程返回其编号，master返回-1
+    static int WorkerIndex() {
+        const char* env = getenv(kWorkerEnv);
+        return env ? atoi(env) : -1;
+    }
+
+    // worker：把进程及之后创建的所有线程绑定到一个CPU，需在创建线程前调用
+    static void PinToCpu(int idx) {
+        int ncpu = static_cast<int>(std::thread::hardware_concurrency());
+        if(ncpu <= 1) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(idx % ncpu, &set);
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+
+    // worker：监听socket创建完毕、事件循环开始运行后调用，通知master可以让旧worker退出
+    static void NotifyReady() {
+        const char* env = getenv(kReadyEnv);
+        if(!env) return;
+        int fd = atoi(env);
+        unsetenv(kReadyEnv);
+        pid_t pid = getpid();
+        if(write(fd, &pid, sizeof(pid)) != sizeof(pid))
+            std::cerr << "[Warning] Failed to notify master!" << std::endl;
+        close(fd);
+    }
+
+    PreforkMaster(char* argv[], int workers, std::chrono::milliseconds drain_deadline) :
+        __workers(std::max(workers, 1)), __deadline(drain_deadline), __master_pid(getpid())
+    {
+        for(char** a = argv; *a; a++) __argv.emplace_back(*a);
+    }
+
+    ~PreforkMaster() noexcept {
+        if(__sig_fd != -1) close(__sig_fd);
+        if(__ready_pipe[0] != -1) {
+            close(__ready_pipe[0]);
+            close(__ready_pipe[1]);
+        }
+    }
+
+    PreforkMaster(const PreforkMaster&) = delete;
+    PreforkMaster& operator=(const PreforkMaster&) = delete;
+
+    // master主循环：所有worker退出后返回
+    int Run() {
+        sigset_t mask;
+        sigemptyset(&mask);
+        for(int sig : {SIGCHLD, SIGINT, SIGTERM, SIGHUP}) sigaddset(&mask, sig);
+        sigprocmask(SIG_BLOCK, &mask, nullptr);
+        __sig_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+        // 就绪管道：写端经exec传给worker，写入pid（<=PIPE_BUF，原子）
+        if(__sig_fd == -1 or pipe2(__ready_pipe, O_CLOEXEC) == -1) {
+            perror("[Master] Failed to initialize!");
+            return 1;
+        }
+        fcntl(__ready_pipe[0], F_SETFL, O_NONBLOCK);
+
+        std::cout << "[Master] pid " << __master_pid << ", starting " << __workers.size() << " workers" << std::endl;
+        for(size_t i = 0; i < __workers.size(); i++) Spawn(i);
+
+        while(true) {
+            pollfd fds[2] = {{__sig_fd, POLLIN, 0}, {__ready_pipe[0], POLLIN, 0}};
+            int ret = poll(fds, 2, NextTimeout());
+            if(ret == -1 and errno != EINTR) {
+                perror("[Master] poll failed!");
+                break;
+            }
+            if(fds[0].revents & POLLIN) {
+                signalfd_siginfo info{};
+                while(read(__sig_fd, &info, sizeof(info)) == sizeof(info)) {
+                    switch(info.ssi_signo) {
+                        case SIGCHLD: Reap(); break;
+                        case SIGHUP: if(!__stopping) Reload(); break;
+                        default: Stop(); break;
+                    }
+                }
+            }
+            if(fds[1].revents & POLLIN) HandleReady();
+
+            auto now = Clock::now();
+            if(__stopping) {
+                if(!HasChildren()) break;
+                if(now >= __kill_at) {
+                    std::cout << "[Master] Deadline reached, killing remaining workers." << std::endl;
+                    ForEachChild([](pid_t pid) { kill(pid, SIGKILL); });
+                    __kill_at = Clock::time_point::max();
+                }
+                continue;
+            }
+            for(size_t i = 0; i < __workers.size(); i++) {
+                if(__workers[i].pid == -1 and now >= __workers[i].respawn_at) Spawn(i);
+            }
+        }
+        std::cout << "[Master] All workers exited." << std::endl;
+        return 0;
+    }
+};
+
+#endif // PREFORK_H
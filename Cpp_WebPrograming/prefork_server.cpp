@@ -0,0 +1,56 @@
+// 多进程prefork HTTP服务器：master只负责监管，每个worker进程是独立的主从Reactor（1个从Reactor）
+// 用法: ./prefork_server [port] [workers，默认CPU核数] [static_dir]
+// kill -HUP <master>：滚动重启所有worker；kill -TERM <master> 或 Ctrl-C：优雅退出
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+
+#include "http.h"
+#include "prefork.h"
+
+static int RunWorker(int idx, uint16_t port, const std::string& static_dir)
+{
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, SIG_IGN); // 终端Ctrl-C会发给整个进程组，由master统一转发SIGTERM
+    PreforkMaster::PinToCpu(idx);
+    SignalWatcher::BlockSignals({SIGTERM}); // 必须在创建任何线程之前
+
+    try {
+        HttpServer server(port, 1, 2);
+        TCPServer& tcp = server.tcp();
+        tcp.SetMaxConnections(10000);
+        tcp.SetCloseListenerOnDrain(true);
+
+        std::string greeting = "Hello from worker " + std::to_string(idx) + " (pid " + std::to_string(getpid()) + ")\n";
+        server.router().Get("/", [greeting](const HttpRequest&, HttpResponse& resp) {
+            resp.SetContentType("text/plain; charset=utf-8");
+            resp.SetBody(greeting);
+        });
+        server.router().Static("/static/", static_dir);
+
+        SignalWatcher term(tcp.MainReactor(), {SIGTERM}, [&tcp](int) {
+            tcp.GracefulStop(std::chrono::seconds(5));
+        });
+        tcp.MainReactor()->QueueInLoop([]() { PreforkMaster::NotifyReady(); });
+        server.start();
+    } catch (const std::exception& e) {
+        std::cerr << "[Worker " << idx << "] " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    uint16_t port = argc > 1 ? static_cast<uint16_t>(std::stoi(argv[1])) : 8080;
+    int workers = argc > 2 ? std::stoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+    std::string static_dir = argc > 3 ? argv[3] : ".";
+
+    int idx = PreforkMaster::WorkerIndex();
+    if(idx >= 0) return RunWorker(idx, port, static_dir);
+
+    std::cout << "[Info] Prefork HTTP server on port " << port << std::endl;
+    PreforkMaster master(argv, workers, std::chrono::seconds(5));
+    return master.Run();
+}
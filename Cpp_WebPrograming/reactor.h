@@ -0,0 +1,1175 @@
+// 主从Reactor公共组件
+// 由 multithread_reactor.cpp 抽出：Buffer / Channel / EpollEventLoop / ReactorThreadPool / Connection / Acceptor / TCPServer
+// 上层协议（echo、HTTP……）只需设置回调，不再直接操作 recv/send
+
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+
+#include <iostream>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <chrono>
+#include <set>
+#include <algorithm>
+#include <any>
+#include <cstring>
+#include <stdexcept>
+
+#include "threadpool.h"
+
+inline int SetNonBlocking(int fd)
+{
+    int flag = fcntl(fd, F_GETFL, 0);
+    return fcntl(fd ,F_SETFL, flag | O_NONBLOCK);
+}
+
+// 读写缓冲区：[__read_idx, __write_idx) 为可读数据，前部空间不足时整体前移复用
+class Buffer {
+private:
+    std::vector<char> __buf;
+    size_t __read_idx = 0;
+    size_t __write_idx = 0;
+
+    void EnsureWritable(size_t len) {
+        if(__buf.size() - __write_idx >= len) return;
+        size_t readable = ReadableBytes();
+        if(__buf.size() - readable >= len) {
+            // 已读部分腾出的空间足够，前移即可，不重新分配
+            std::memmove(__buf.data(), __buf.data() + __read_idx, readable);
+        } else {
+            std::vector<char> bigger(std::max(__buf.size() * 2, readable + len));
+            std::memcpy(bigger.data(), __buf.data() + __read_idx, readable);
+            __buf.swap(bigger);
+        }
+        __read_idx = 0;
+        __write_idx = readable;
+    }
+
+public:
+    explicit Buffer(size_t init_size = 4096) : __buf(init_size) {}
+
+    size_t ReadableBytes() const { return __write_idx - __read_idx; }
+    const char* Peek() const { return __buf.data() + __read_idx; }
+
+    void Retrieve(size_t len) {
+        if(len >= ReadableBytes()) RetrieveAll();
+        else __read_idx += len;
+    }
+    void RetrieveAll() { __read_idx = __write_idx = 0; }
+    std::string RetrieveAllAsString() {
+        std::string str(Peek(), ReadableBytes());
+        RetrieveAll();
+        return str;
+    }
+
+    void Append(const char* data, size_t len) {
+        EnsureWritable(len);
+        std::memcpy(__buf.data() + __write_idx, data, len);
+        __write_idx += len;
+    }
+    void Append(std::string_view data) { Append(data.data(), data.size()); }
+
+    // 一次readv读尽内核缓冲：先填本缓冲剩余空间，溢出部分落到栈上再追加，避免为每个连接预留大缓冲
+    ssize_t ReadFd(int fd, int* saved_errno) {
+        char extra[65536];
+        iovec vec[2];
+        size_t writable = __buf.size() - __write_idx;
+        vec[0].iov_base = __buf.data() + __write_idx;
+        vec[0].iov_len = writable;
+        vec[1].iov_base = extra;
+        vec[1].iov_len = sizeof(extra);
+        ssize_t n = readv(fd, vec, 2);
+        if(n < 0) {
+            *saved_errno = errno;
+        } else if(static_cast<size_t>(n) <= writable) {
+            __write_idx += n;
+        } else {
+            __write_idx = __buf.size();
+            Append(extra, n - writable);
+        }
+        return n;
+    }
+};
+
+// 事件类：记录fd关注的事件并分发读/写/关闭回调
+class Channel {
+    using CB_Func = std::function<void()>;
+private:
+    int __fd;
+    uint32_t __events;
+    CB_Func __read_cb;
+    CB_Func __write_cb;
+    CB_Func __close_cb;
+    // 绑定所属对象（Connection）的生命周期，回调执行期间对象不会被析构
+    std::weak_ptr<void> __tie;
+    bool __tied = false;
+
+    void HandleEventWithGuard(uint32_t event) {
+        if((event & EPOLLHUP) and !(event & EPOLLIN)) {
+            if(__close_cb) __close_cb();
+            return;
+        }
+        // EPOLLERR 交给读回调，由 recv 返回值得到具体错误
+        if((event & (EPOLLIN | EPOLLPRI | EPOLLRDHUP | EPOLLERR)) and __read_cb) {
+            __read_cb();
+        }
+        if((event & EPOLLOUT) and __write_cb) {
+            __write_cb();
+        }
+    }
+
+public:
+    explicit Channel(int fd) : __fd(fd), __events(EPOLLIN) {}
+    void SetReadCallBack(CB_Func cb) { __read_cb = std::move(cb); }
+    void SetWriteCallBack(CB_Func cb) { __write_cb = std::move(cb); }
+    void SetCloseCallBack(CB_Func cb) { __close_cb = std::move(cb); }
+    void Tie(const std::shared_ptr<void>& obj) { __tie = obj; __tied = true; }
+
+    void HandleEvent(uint32_t event) {
+        if(__tied) {
+            std::shared_ptr<void> guard = __tie.lock();
+            if(guard) HandleEventWithGuard(event);
+        } else {
+            HandleEventWithGuard(event);
+        }
+    }
+
+    int fd() const { return __fd; }
+    uint32_t events() const { return __events; }
+    void SetEvents(uint32_t events) { __events = events; }
+    bool IsWriting() const { return __events & EPOLLOUT; }
+};
+
+// Epoll封装：事件循环 + 跨线程任务队列（eventfd唤醒）+ 定时器（timerfd）
+class EpollEventLoop {
+    using Functor = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+public:
+    using TimerId = uint64_t;
+private:
+    struct Timer {
+        Functor cb;
+        Clock::time_point when;
+        std::chrono::milliseconds interval; // 0 表示一次性定时器
+    };
+
+    int __epfd;
+    int __wakeup_fd;
+    int __timer_fd;
+    std::atomic<bool> __is_running{true};
+    std::atomic<std::thread::id> __thread_id{};
+    std::vector<epoll_event> __events;
+    std::unique_ptr<Channel> __wakeup_channel;
+    std::unique_ptr<Channel> __timer_channel;
+    std::mutex __mtx;
+    std::vector<Functor> __pending; // 其他线程投递到本loop执行的任务
+    std::atomic<bool> __calling_pending{false};
+    // 定时器只在loop线程访问：按到期时间排序的队列 + id索引（用于取消）
+    std::set<std::pair<Clock::time_point, TimerId>> __timer_queue;
+    std::unordered_map<TimerId, Timer> __timers;
+    inline static std::atomic<TimerId> s_next_timer_id{1};
+
+    void HandleWakeup() {
+        uint64_t one;
+        ssize_t n = read(__wakeup_fd, &one, sizeof(one));
+        (void)n;
+    }
+
+    // timerfd始终只对准最早到期的定时器
+    void ResetTimerFd() {
+        itimerspec spec{};
+        if(!__timer_queue.empty()) {
+            auto delay = std::chrono::duration_cast<std::chrono::nanoseconds>(__timer_queue.begin()->first - Clock::now());
+            long long ns = std::max<long long>(delay.count(), 1000);
+            spec.it_value.tv_sec = ns / 1000000000;
+            spec.it_value.tv_nsec = ns % 1000000000;
+        }
+        timerfd_settime(__timer_fd, 0, &spec, nullptr);
+    }
+
+    void HandleTimers() {
+        uint64_t expirations;
+        ssize_t n = read(__timer_fd, &expirations, sizeof(expirations));
+        (void)n;
+        auto now = Clock::now();
+        while(!__timer_queue.empty() and __timer_queue.begin()->first <= now) {
+            TimerId id = __timer_queue.begin()->second;
+            __timer_queue.erase(__timer_queue.begin());
+            auto it = __timers.find(id);
+            if(it == __timers.end()) continue;
+            Functor cb;
+            if(it->second.interval.count() == 0) {
+                cb = std::move(it->second.cb);
+                __timers.erase(it);
+            } else {
+                // 先重新入队再回调，回调里可以安全地取消自己
+                it->second.when = now + it->second.interval;
+                __timer_queue.emplace(it->second.when, id);
+                cb = it->second.cb;
+            }
+            cb();
+        }
+        ResetTimerFd();
+    }
+
+    TimerId AddTimer(std::chrono::milliseconds delay, std::chrono::milliseconds interval, Functor cb) {
+        TimerId id = s_next_timer_id.fetch_add(1);
+        RunInLoop([this, id, delay, interval, cb = std::move(cb)]() mutable {
+            auto when = Clock::now() + delay;
+            __timers.emplace(id, Timer{std::move(cb), when, interval});
+            bool earliest = __timer_queue.empty() or when < __timer_queue.begin()->first;
+            __timer_queue.emplace(when, id);
+            if(earliest) ResetTimerFd();
+        });
+        return id;
+    }
+
+    void DoPendingFunctors() {
+        std::vector<Functor> functors;
+        __calling_pending.store(true);
+        {
+            std::unique_lock<std::mutex> lock(__mtx);
+            functors.swap(__pending);
+        }
+        for(auto& f : functors) f();
+        __calling_pending.store(false);
+    }
+
+public:
+    explicit EpollEventLoop(int size = 1024) {
+        __events.resize(size);
+        __epfd = epoll_create1(EPOLL_CLOEXEC);
+        if(__epfd == -1)
+            throw std::runtime_error("Failed to create epoll!");
+        __wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(__wakeup_fd == -1) {
+            close(__epfd);
+            throw std::runtime_error("Failed to create eventfd!");
+        }
+        __timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if(__timer_fd == -1) {
+            close(__wakeup_fd);
+            close(__epfd);
+            throw std::runtime_error("Failed to create timerfd!");
+        }
+        __wakeup_channel = std::make_unique<Channel>(__wakeup_fd);
+        __wakeup_channel->SetReadCallBack([this](){ HandleWakeup(); });
+        AddChannel(__wakeup_channel.get());
+        __timer_channel = std::make_unique<Channel>(__timer_fd);
+        __timer_channel->SetReadCallBack([this](){ HandleTimers(); });
+        AddChannel(__timer_channel.get());
+    }
+    ~EpollEventLoop() noexcept {
+        __is_running.store(false);
+        if(__timer_fd != -1)
+            close(__timer_fd);
+        if(__wakeup_fd != -1)
+            close(__wakeup_fd);
+        if(__epfd != -1)
+            close(__epfd);
+    }
+    EpollEventLoop(const EpollEventLoop&) = delete;
+    EpollEventLoop& operator=(const EpollEventLoop&) = delete;
+
+    void AddChannel(Channel* ch) {
+        epoll_event ev{};
+        ev.events = ch->events();
+        ev.data.ptr = ch;
+        epoll_ctl(__epfd, EPOLL_CTL_ADD, ch->fd(), &ev);
+    }
+    void UpdateChannel(Channel* ch) {
+        epoll_event ev{};
+        ev.events = ch->events();
+        ev.data.ptr = ch;
+        epoll_ctl(__epfd, EPOLL_CTL_MOD, ch->fd(), &ev);
+    }
+    void DelChannel(Channel* ch) {
+        epoll_ctl(__epfd, EPOLL_CTL_DEL, ch->fd(), nullptr);
+    }
+    void loop() {
+        __thread_id.store(std::this_thread::get_id());
+        while (__is_running) {
+            int nfds = epoll_wait(__epfd, __events.data(), __events.size(), -1);
+            if(nfds == -1) {
+                if(errno == EINTR) continue;
+                std::cerr << "[Error] epoll_wait failed: " << strerror(errno) << std::endl;
+                break;
+            }
+            for(int i=0;i<nfds;i++) {
+                auto* ch = static_cast<Channel*>(__events[i].data.ptr);
+                ch->HandleEvent(__events[i].events);
+            }
+            // 事件表被填满说明并发较高，扩容以减少epoll_wait次数
+            if(static_cast<size_t>(nfds) == __events.size())
+                __events.resize(__events.size() * 2);
+            DoPendingFunctors();
+        }
+    }
+    void stop() {
+        __is_running.store(false);
+        Wakeup();
+    }
+    bool isRunning() const { return __is_running; }
+    bool IsInLoopThread() const { return __thread_id.load() == std::this_thread::get_id(); }
+
+    void Wakeup() {
+        uint64_t one = 1;
+        ssize_t n = write(__wakeup_fd, &one, sizeof(one));
+        (void)n;
+    }
+    // 在loop线程中执行：本线程直接调用，否则入队并唤醒
+    void RunInLoop(Functor cb) {
+        if(IsInLoopThread()) cb();
+        else QueueInLoop(std::move(cb));
+    }
+    void QueueInLoop(Functor cb) {
+        {
+            std::unique_lock<std::mutex> lock(__mtx);
+            __pending.emplace_back(std::move(cb));
+        }
+        // 正在执行任务队列时新投递的任务也要唤醒，否则会等到下一次IO事件
+        if(!IsInLoopThread() or __calling_pending.load())
+            Wakeup();
+    }
+
+    // 定时器：可在任意线程调用，回调总在loop线程执行
+    TimerId RunAfter(std::chrono::milliseconds delay, Functor cb) {
+        return AddTimer(delay, std::chrono::milliseconds(0), std::move(cb));
+    }
+    TimerId RunEvery(std::chrono::milliseconds interval, Functor cb) {
+        return AddTimer(interval, interval, std::move(cb));
+    }
+    void CancelTimer(TimerId id) {
+        RunInLoop([this, id]() {
+            auto it = __timers.find(id);
+            if(it == __timers.end()) return;
+            __timer_queue.erase({it->second.when, id});
+            __timers.erase(it);
+        });
+    }
+};
+
+// signalfd：把信号变成普通的可读事件，在loop线程里同步处理，回调中可以安全地加锁、打印、停止服务
+// BlockSignals 必须在创建任何线程之前调用，子线程继承屏蔽字，信号只会经由signalfd投递
+class SignalWatcher {
+    using SignalCallback = std::function<void(int)>;
+private:
+    int __fd;
+    EpollEventLoop* __loop;
+    std::unique_ptr<Channel> __channel;
+    SignalCallback __cb;
+
+    static sigset_t MakeSet(std::initializer_list<int> signals) {
+        sigset_t mask;
+        sigemptyset(&mask);
+        for(int sig : signals) sigaddset(&mask, sig);
+        return mask;
+    }
+
+    void HandleRead() {
+        signalfd_siginfo info{};
+        while(read(__fd, &info, sizeof(info)) == sizeof(info)) {
+            if(__cb) __cb(static_cast<int>(info.ssi_signo));
+        }
+    }
+
+public:
+    static void BlockSignals(std::initializer_list<int> signals) {
+        sigset_t mask = MakeSet(signals);
+        pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    }
+
+    SignalWatcher(EpollEventLoop* loop, std::initializer_list<int> signals, SignalCallback cb) :
+        __loop(loop), __cb(std::move(cb))
+    {
+        sigset_t mask = MakeSet(signals);
+        pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+        __fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+        if(__fd == -1)
+            throw std::runtime_error("Failed to create signalfd!");
+        __channel = std::make_unique<Channel>(__fd);
+        __channel->SetReadCallBack([this](){ HandleRead(); });
+        __loop->AddChannel(__channel.get());
+    }
+
+    ~SignalWatcher() noexcept {
+        __loop->DelChannel(__channel.get());
+        close(__fd);
+    }
+
+    SignalWatcher(const SignalWatcher&) = delete;
+    SignalWatcher& operator=(const SignalWatcher&) = delete;
+};
+
+// 从Reactor线程池（管理多个从Reactor，负责分发connfd）
+class ReactorThreadPool {
+private:
+    std::vector<std::unique_ptr<EpollEventLoop>> __sub_reactors;
+    std::vector<std::thread> __reactor_threads;
+    std::atomic<int> __next_reactor{0}; // 轮询分发索引
+public:
+    // 初始化从Reactor线程池
+    void init(int sub_reactor_num, ThreadPool& work_pool) {
+        if (sub_reactor_num <= 0) sub_reactor_num = 1;
+        for (int i = 0; i < sub_reactor_num; ++i) {
+            __sub_reactors.emplace_back(std::make_unique<EpollEventLoop>());
+        }
+        // 先创建全部loop再启动线程，避免线程访问扩容中的vector
+        for (int i = 0; i < sub_reactor_num; ++i) {
+            __reactor_threads.emplace_back([this, i]() {
+                __sub_reactors[i]->loop();
+            });
+        }
+        (void)work_pool;
+    }
+
+    // 轮询获取一个从Reactor（分发connfd使用）
+    EpollEventLoop* getNextSubReactor() {
+        if (__sub_reactors.empty()) return nullptr;
+        int idx = __next_reactor.fetch_add(1) % __sub_reactors.size();
+        return __sub_reactors[idx].get();
+    }
+
+    size_t size() const { return __sub_reactors.size(); }
+    EpollEventLoop* getSubReactor(size_t idx) { return __sub_reactors[idx].get(); }
+
+    // 停止所有从Reactor并等待线程退出
+    void stop() {
+        for (auto& sub_reactor : __sub_reactors) {
+            sub_reactor->stop();
+        }
+        for (auto& thread : __reactor_threads) {
+            if (thread.joinable()) thread.join();
+        }
+    }
+
+    ~ReactorThreadPool() noexcept {
+        stop();
+    }
+};
+
+// 已打开的文件（RAII），SendFile期间由输出队列持有，发送完毕后自动关闭
+struct FileDesc {
+    int fd;
+    explicit FileDesc(int _fd) : fd(_fd) {}
+    ~FileDesc() noexcept { if(fd != -1) close(fd); }
+    FileDesc(const FileDesc&) = delete;
+    FileDesc& operator=(const FileDesc&) = delete;
+};
+using FileDescPtr = std::shared_ptr<const FileDesc>;
+
+// 文件段的零拷贝方式：sendfile 直接文件->socket；splice 经由每连接一个管道中转（文件->管道->socket）
+enum class FileTransfer { kSendfile, kSplice };
+
+class Connection;
+using ConnectionPtr = std::shared_ptr<Connection>;
+using MessageCallback = std::function<void(const ConnectionPtr&, Buffer*)>;
+using ConnectionCallback = std::function<void(const ConnectionPtr&)>;
+
+// 客户端连接：由shared_ptr管理生命周期，所有IO都在所属从Reactor线程执行
+// Send/SendFile/Shutdown 可在任意线程调用（如业务线程池），会被投递回所属loop
+// 业务任务经 SubmitWork 提交时计入本连接的在途任务，Shutdown 的半关闭会等它们的响应都进了输出队列
+class Connection : public std::enable_shared_from_this<Connection> {
+private:
+    enum State { kConnecting, kConnected, kDisconnecting, kDisconnected };
+
+    // 输出队列中的一段：内存数据（send/writev）或文件区间（sendfile/splice）
+    struct OutSegment {
+        std::string data;
+        size_t pos = 0;
+        FileDescPtr file;
+        off_t file_off = 0;
+        size_t file_len = 0;   // 尚未从文件读出的字节数
+        off_t advised_end = 0; // 已下发预读提示的位置
+    };
+    enum class IoResult { kDone, kBlocked, kError };
+
+    int __fd;
+    EpollEventLoop* __epoll; // 所属从Reactor
+    ThreadPool& __pool;
+    Channel __channel;
+    std::atomic<int> __state{kConnecting};
+    Buffer __input;
+    std::deque<OutSegment> __output;
+    MessageCallback __message_cb;
+    ConnectionCallback __connection_cb;     // 建立/断开时各调用一次
+    ConnectionCallback __write_complete_cb; // 输出队列清空时调用
+    ConnectionCallback __close_cb;          // 供TCPServer移除连接
+    std::any __context;                     // 上层协议的连接状态（如HTTP解析器）
+    FileTransfer __file_transfer = FileTransfer::kSendfile;
+    int __pipe[2] = {-1, -1};               // splice中转管道，首次使用时创建
+    size_t __pipe_bytes = 0;                // 管道中尚未写入socket的字节
+    std::atomic<int> __pending_work{0};     // SubmitWork 提交、尚未执行完的任务数
+
+    static constexpr size_t kMergeLimit = 64 * 1024; // 小块数据合并进上一段，减少系统调用
+    static constexpr off_t kReadaheadWindow = 2 * 1024 * 1024;
+    static constexpr size_t kPipeSize = 1024 * 1024;
+
+    void EnableWriting() {
+        if(__channel.IsWriting()) return;
+        __channel.SetEvents(__channel.events() | EPOLLOUT);
+        __epoll->UpdateChannel(&__channel);
+    }
+    void DisableWriting() {
+        if(!__channel.IsWriting()) return;
+        __channel.SetEvents(__channel.events() & ~EPOLLOUT);
+        __epoll->UpdateChannel(&__channel);
+    }
+
+    void HandleRead() {
+        int saved_errno = 0;
+        ssize_t len = __input.ReadFd(__fd, &saved_errno);
+        if(len > 0) {
+            if(__message_cb) __message_cb(shared_from_this(), &__input);
+        } else if(len == 0) {
+            HandleClose();
+        } else if(saved_errno != EAGAIN and saved_errno != EWOULDBLOCK and saved_errno != EINTR) {
+            HandleClose();
+        }
+    }
+
+    void HandleWrite() {
+        if(!FlushOutput()) HandleClose();
+    }
+
+    // 大文件按窗口提前下发WILLNEED，让磁盘读与网络发送重叠；页缓存命中时几乎无开销
+    void AdviseReadahead(OutSegment& seg) {
+        off_t end = seg.file_off + static_cast<off_t>(seg.file_len);
+        while(seg.advised_end < end and seg.advised_end < seg.file_off + kReadaheadWindow) {
+            off_t len = std::min(kReadaheadWindow, end - seg.advised_end);
+            posix_fadvise(seg.file->fd, seg.advised_end, len, POSIX_FADV_WILLNEED);
+            seg.advised_end += len;
+        }
+    }
+
+    IoResult SendfileSegment(OutSegment& seg) {
+        while(seg.file_len > 0) {
+            AdviseReadahead(seg);
+            ssize_t n = sendfile(__fd, seg.file->fd, &seg.file_off, seg.file_len);
+            if(n < 0) {
+                if(errno == EAGAIN or errno == EWOULDBLOCK) return IoResult::kBlocked;
+                if(errno == EINTR) continue;
+                return IoResult::kError;
+            }
+            if(n == 0) return IoResult::kError; // 文件被截断，无法按承诺的长度发完
+            seg.file_len -= n;
+        }
+        return IoResult::kDone;
+    }
+
+    // 文件->管道->socket；socket写满时管道里可能残留数据，下次可写时先把管道排空
+    IoResult SpliceSegment(OutSegment& seg) {
+        if(__pipe[0] == -1) {
+            if(pipe2(__pipe, O_NONBLOCK | O_CLOEXEC) == -1) return IoResult::kError;
+            fcntl(__pipe[1], F_SETPIPE_SZ, kPipeSize); // 尽力扩大管道，失败则用默认64KB
+        }
+        while(seg.file_len > 0 or __pipe_bytes > 0) {
+            if(__pipe_bytes == 0) {
+                AdviseReadahead(seg);
+                ssize_t n = splice(seg.file->fd, &seg.file_off, __pipe[1], nullptr, std::min(seg.file_len, kPipeSize),
+                                   SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                if(n < 0) {
+                    if(errno == EINTR) continue;
+                    return IoResult::kError;
+                }
+                if(n == 0) return IoResult::kError;
+                seg.file_len -= n;
+                __pipe_bytes = n;
+            }
+            ssize_t n = splice(__pipe[0], nullptr, __fd, nullptr, __pipe_bytes, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if(n < 0) {
+                if(errno == EAGAIN or errno == EWOULDBLOCK) return IoResult::kBlocked;
+                if(errno == EINTR) continue;
+                return IoResult::kError;
+            }
+            __pipe_bytes -= n;
+        }
+        return IoResult::kDone;
+    }
+
+    // 尽量写出输出队列：连续的内存段合并为一次writev，文件段走sendfile
+    // 内核缓冲写满时注册EPOLLOUT，可写后从断点继续；返回false表示连接出错
+    bool FlushOutput() {
+        while(!__output.empty()) {
+            OutSegment& front = __output.front();
+            if(front.file) {
+                IoResult r = __file_transfer == FileTransfer::kSplice ? SpliceSegment(front) : SendfileSegment(front);
+                if(r == IoResult::kError) return false;
+                if(r == IoResult::kBlocked) break;
+                __output.pop_front();
+            } else {
+                iovec vec[16];
+                int cnt = 0;
+                size_t total = 0;
+                for(auto it = __output.begin(); it != __output.end() and cnt < 16 and !it->file; ++it, ++cnt) {
+                    vec[cnt].iov_base = it->data.data() + it->pos;
+                    vec[cnt].iov_len = it->data.size() - it->pos;
+                    total += vec[cnt].iov_len;
+                }
+                msghdr msg{};
+                msg.msg_iov = vec;
+                msg.msg_iovlen = cnt;
+                ssize_t n = sendmsg(__fd, &msg, MSG_NOSIGNAL);
+                if(n < 0) {
+                    if(errno == EAGAIN or errno == EWOULDBLOCK) break;
+                    if(errno == EINTR) continue;
+                    return false;
+                }
+                size_t remain = n;
+                while(remain > 0) {
+                    OutSegment& seg = __output.front();
+                    size_t left = seg.data.size() - seg.pos;
+                    if(remain < left) {
+                        seg.pos += remain;
+                        break;
+                    }
+                    remain -= left;
+                    __output.pop_front();
+                }
+                if(static_cast<size_t>(n) < total) break; // 内核缓冲已满
+            }
+        }
+        if(!__output.empty()) {
+            EnableWriting();
+            return true;
+        }
+        DisableWriting();
+        if(__write_complete_cb) __write_complete_cb(shared_from_this());
+        if(__state == kDisconnecting) QueueShutdownWrite();
+        return true;
+    }
+
+    // 半关闭写端放到任务队列里做：业务线程在任务结束前投递的Send排在它前面，先进入输出队列
+    void QueueShutdownWrite() {
+        __epoll->QueueInLoop([self = shared_from_this()]() {
+            if(self->__state == kDisconnecting and self->__output.empty() and self->__pending_work.load() == 0)
+                ::shutdown(self->__fd, SHUT_WR);
+        });
+    }
+
+    void SendInLoop(std::string&& data) {
+        if(__state == kDisconnected or data.empty()) return;
+        if(!__output.empty() and !__output.back().file
+            and __output.back().data.size() + data.size() <= kMergeLimit) {
+            __output.back().data.append(data);
+        } else {
+            OutSegment seg;
+            seg.data = std::move(data);
+            __output.emplace_back(std::move(seg));
+        }
+        // 已注册EPOLLOUT说明内核缓冲满，等可写事件统一发送
+        if(!__channel.IsWriting() and !FlushOutput()) HandleClose();
+    }
+
+    void SendFileInLoop(FileDescPtr file, off_t offset, size_t len) {
+        if(__state == kDisconnected or len == 0) return;
+        OutSegment seg;
+        seg.file = std::move(file);
+        seg.file_off = offset;
+        seg.file_len = len;
+        seg.advised_end = offset;
+        __output.emplace_back(std::move(seg));
+        if(!__channel.IsWriting() and !FlushOutput()) HandleClose();
+    }
+
+    void HandleClose() {
+        if(__state == kDisconnected) return;
+        __state = kDisconnected;
+        __epoll->DelChannel(&__channel);
+        __output.clear();
+        ConnectionPtr guard = shared_from_this();
+        if(__connection_cb) __connection_cb(guard);
+        if(__close_cb) __close_cb(guard);
+        // 本轮epoll_wait可能还有指向本Channel的事件，延后到任务队列阶段再释放
+        __epoll->QueueInLoop([guard]() {});
+    }
+
+public:
+    // fd须已是非阻塞的（accept4/socket 时带 SOCK_NONBLOCK），由Connection负责关闭
+    Connection(EpollEventLoop* epoll, ThreadPool& pool, int fd) :
+        __fd(fd), __epoll(epoll), __pool(pool), __channel(fd) {
+            __channel.SetReadCallBack([this](){ HandleRead(); });
+            __channel.SetWriteCallBack([this](){ HandleWrite(); });
+            __channel.SetCloseCallBack([this](){ HandleClose(); });
+        }
+
+    ~Connection() noexcept {
+        if(__fd != -1)
+            close(__fd);
+        if(__pipe[0] != -1) {
+            close(__pipe[0]);
+            close(__pipe[1]);
+        }
+    }
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    void SetMessageCallback(MessageCallback cb) { __message_cb = std::move(cb); }
+    void SetConnectionCallback(ConnectionCallback cb) { __connection_cb = std::move(cb); }
+    void SetWriteCompleteCallback(ConnectionCallback cb) { __write_complete_cb = std::move(cb); }
+    void SetCloseCallback(ConnectionCallback cb) { __close_cb = std::move(cb); }
+    // 在loop线程、首次SendFile之前设置
+    void SetFileTransfer(FileTransfer mode) { __file_transfer = mode; }
+
+    // 在所属loop线程调用：注册到从Reactor开始收发
+    void ConnectEstablished() {
+        __state = kConnected;
+        __channel.Tie(shared_from_this());
+        __epoll->AddChannel(&__channel);
+        if(__connection_cb) __connection_cb(shared_from_this());
+    }
+
+    void Send(std::string data) {
+        if(__epoll->IsInLoopThread()) {
+            SendInLoop(std::move(data));
+        } else {
+            __epoll->QueueInLoop([self = shared_from_this(), data = std::move(data)]() mutable {
+                self->SendInLoop(std::move(data));
+            });
+        }
+    }
+
+    // 零拷贝发送文件区间[offset, offset+len)，与Send的数据严格保序
+    // 超过socket缓冲的部分在EPOLLOUT到来时从上次的偏移继续
+    void SendFile(FileDescPtr file, off_t offset, size_t len) {
+        if(__epoll->IsInLoopThread()) {
+            SendFileInLoop(std::move(file), offset, len);
+        } else {
+            __epoll->QueueInLoop([self = shared_from_this(), file = std::move(file), offset, len]() mutable {
+                self->SendFileInLoop(std::move(file), offset, len);
+            });
+        }
+    }
+
+    // 经 SubmitWork 提交的任务都执行完、输出队列发送完毕后半关闭写端，对端读到EOF后关闭连接
+    void Shutdown() {
+        __epoll->RunInLoop([self = shared_from_this()]() {
+            if(self->__state != kConnected) return;
+            self->__state = kDisconnecting;
+            if(self->__output.empty()) self->QueueShutdownWrite();
+        });
+    }
+
+    // 交给业务线程池执行。任务里的Send在任务返回前投递，Shutdown（包括优雅退出的排空）据此等待这些响应
+    void SubmitWork(std::function<void()> task) {
+        __pending_work.fetch_add(1);
+        __pool.submit([self = shared_from_this(), task = std::move(task)]() {
+            task();
+            // 与Shutdown相对：先减计数再读状态，Shutdown先置状态再读计数，两边至少有一方看到对方
+            if(self->__pending_work.fetch_sub(1) == 1 and self->__state == kDisconnecting) self->QueueShutdownWrite();
+        });
+    }
+
+    void ForceClose() {
+        __epoll->RunInLoop([self = shared_from_this()]() { self->HandleClose(); });
+    }
+
+    int fd() const { return __fd; }
+    bool Connected() const { return __state == kConnected; }
+    EpollEventLoop* GetLoop() const { return __epoll; }
+    ThreadPool& WorkPool() const { return __pool; }
+    Buffer* InputBuffer() { return &__input; }
+    std::any& Context() { return __context; }
+    void SetContext(std::any context) { __context = std::move(context); }
+};
+
+// 按源IP的令牌桶限速：每个IP每秒补充rate个令牌，最多积累burst个，每个新连接消耗一个
+// 只在主Reactor线程中使用，无锁；空闲IP的桶定期清理，防止伪造源地址撑大表
+class IpRateLimiter {
+    using Clock = std::chrono::steady_clock;
+private:
+    struct Bucket {
+        double tokens;
+        Clock::time_point last;
+    };
+    double __rate = 0;  // 0 表示不限速
+    double __burst = 0;
+    std::unordered_map<uint32_t, Bucket> __buckets;
+
+public:
+    void Configure(double rate, double burst) {
+        __rate = rate;
+        __burst = std::max(burst, 1.0);
+        __buckets.clear();
+    }
+    bool Enabled() const { return __rate > 0; }
+
+    bool Allow(uint32_t ip, Clock::time_point now = Clock::now()) {
+        if(__rate <= 0) return true;
+        auto [it, inserted] = __buckets.try_emplace(ip, Bucket{__burst, now});
+        Bucket& b = it->second;
+        if(!inserted) {
+            b.tokens = std::min(__burst, b.tokens + std::chrono::duration<double>(now - b.last).count() * __rate);
+            b.last = now;
+        }
+        if(b.tokens < 1.0) return false;
+        b.tokens -= 1.0;
+        return true;
+    }
+
+    // 令牌已补满的桶与新建无异，删除
+    void Prune(Clock::time_point now = Clock::now()) {
+        for(auto it = __buckets.begin(); it != __buckets.end();) {
+            double tokens = it->second.tokens + std::chrono::duration<double>(now - it->second.last).count() * __rate;
+            if(tokens >= __burst) it = __buckets.erase(it);
+            else ++it;
+        }
+    }
+
+    size_t size() const { return __buckets.size(); }
+};
+
+// Acceptor（主Reactor中处理listenfd，把新连接交给上层分发）
+class Acceptor {
+    using NewConnectionCallback = std::function<void(int, const sockaddr_in&)>;
+private:
+    static constexpr int kMaxAcceptPerEvent = 256; // 单次事件最多accept的连接数，避免连接风暴时饿死定时器等其他事件
+    static constexpr std::chrono::milliseconds kPauseOnExhausted{100}; // 没有预留fd可用时暂停accept的时长
+
+    int __listenfd;
+    int __idle_fd; // 预留fd：进程fd耗尽时释放它来accept并立即关闭新连接，否则监听fd持续可读会空转
+    EpollEventLoop* __main_reactor; // 主Reactor（仅处理连接）
+    Channel __channel;
+    NewConnectionCallback __new_connection_cb;
+    std::function<void()> __shed_cb; // 每因fd耗尽丢弃一个连接调用一次
+    bool __stopped = false; // Stop()之后本轮epoll_wait里剩下的监听事件直接忽略
+    EpollEventLoop::TimerId __resume_timer = 0; // fd耗尽且没有预留fd时暂停读监听fd，到时恢复；0表示未暂停
+
+    // 返回true表示达到单次上限，队列中可能还有连接
+    bool HandleAccept() {
+        for (int i = 0; i < kMaxAcceptPerEvent; i++) {
+            sockaddr_in peer{};
+            socklen_t len = sizeof(peer);
+            // accept4 一次完成非阻塞与CLOEXEC设置，省去两次fcntl
+            int client_fd = accept4(__listenfd, reinterpret_cast<sockaddr*>(&peer), &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if(client_fd == -1) {
+                if(errno == EINTR or errno == ECONNABORTED) continue;
+                if(errno == EMFILE or errno == ENFILE) {
+                    if(__idle_fd != -1) {
+                        ShedOne();
+                        continue;
+                    }
+                    PauseAccept(); // 连接留在accept队列里，监听fd一直可读，不暂停就会空转
+                    return false;
+                }
+                return false; // EAGAIN 或其他错误
+            }
+            if(__new_connection_cb) __new_connection_cb(client_fd, peer);
+            else close(client_fd);
+        }
+        return true;
+    }
+
+    void ShedOne() {
+        close(__idle_fd);
+        int fd = accept4(__listenfd, nullptr, nullptr, SOCK_CLOEXEC);
+        if(fd != -1) {
+            close(fd);
+            if(__shed_cb) __shed_cb();
+        }
+        __idle_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
+
+    // 预留fd没能打开（构造时或ShedOne重开时fd已耗尽）：暂停读监听fd，稍后重开预留fd再恢复
+    void PauseAccept() {
+        if(__resume_timer) return;
+        __channel.SetEvents(0);
+        __main_reactor->UpdateChannel(&__channel);
+        __resume_timer = __main_reactor->RunAfter(kPauseOnExhausted, [this]() {
+            __resume_timer = 0;
+            if(__stopped) return;
+            if(__idle_fd == -1) __idle_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+            __channel.SetEvents(EPOLLIN); // 重开失败也恢复：若仍耗尽，下一次accept会再次暂停
+            __main_reactor->UpdateChannel(&__channel);
+        });
+    }
+
+public:
+    Acceptor(EpollEventLoop* main_reactor, int lisfd) :
+        __listenfd(lisfd), __idle_fd(open("/dev/null", O_RDONLY | O_CLOEXEC)),
+        __main_reactor(main_reactor), __channel(lisfd) {
+            __channel.SetReadCallBack([this](){ if(!__stopped) HandleAccept(); });
+            __main_reactor->AddChannel(&__channel);
+        }
+
+    ~Acceptor() noexcept {
+        Stop();
+        if(__idle_fd != -1) close(__idle_fd);
+    }
+
+    // 停止accept：从epoll中移除监听fd。本轮事件分发可能还持有Channel指针，
+    // 在分发中调用时Acceptor要延后到QueueInLoop里再析构
+    void Stop() {
+        if(__stopped) return;
+        __stopped = true;
+        if(__resume_timer) __main_reactor->CancelTimer(__resume_timer);
+        __resume_timer = 0;
+        __main_reactor->DelChannel(&__channel);
+    }
+
+    void SetNewConnectionCallback(NewConnectionCallback cb) { __new_connection_cb = std::move(cb); }
+    void SetShedCallback(std::function<void()> cb) { __shed_cb = std::move(cb); }
+
+    // 取走accept队列中剩余的全部连接（关闭监听socket前调用，否则这些连接会被内核RST）
+    void AcceptPending() {
+        while (HandleAccept()) {}
+    }
+};
+
+// 准入统计
+struct AdmissionStats {
+    uint64_t accepted = 0;
+    uint64_t rejected_capacity = 0; // 超过服务器或从Reactor连接上限
+    uint64_t rejected_rate = 0;     // 源IP超过速率限制
+    uint64_t shed_emfile = 0;       // fd耗尽时丢弃
+};
+
+// TCPServer（主Reactor仅处理连接，从Reactor线程池处理客户端IO，业务工作池处理耗时任务）
+class TCPServer {
+private:
+    int __listenfd;
+    EpollEventLoop __main_reactor; // 主Reactor（仅处理客户端连接）
+    ReactorThreadPool __sub_reactor_pool; // 从Reactor线程池（处理客户端IO）
+    ThreadPool __work_pool; // 业务工作池
+    std::unique_ptr<Acceptor> __acceptor;
+    std::mutex __conn_mtx;
+    std::unordered_map<int, ConnectionPtr> __connections; // 持有连接，断开时移除
+    MessageCallback __message_cb;
+    ConnectionCallback __connection_cb;
+    ConnectionCallback __drain_cb; // 优雅退出时在连接所属loop中调用，默认Shutdown
+    std::atomic<bool> __draining{false};
+    bool __close_listener_on_drain = false;
+
+    // 准入控制：上限为0表示不限制；计数与__connections一起受__conn_mtx保护
+    size_t __max_connections = 0;
+    size_t __max_per_loop = 0;
+    std::unordered_map<EpollEventLoop*, size_t> __loop_conns;
+    IpRateLimiter __rate_limiter; // 仅主Reactor线程访问
+    EpollEventLoop::TimerId __prune_timer = 0; // 限速表的定期清理，0表示未注册；仅主Reactor线程访问
+    std::atomic<uint64_t> __accepted{0}, __rejected_capacity{0}, __rejected_rate{0}, __shed{0};
+
+    void DrainConnection(const ConnectionPtr& conn) {
+        if(!conn->Connected()) return;
+        if(__drain_cb) __drain_cb(conn);
+        else conn->Shutdown();
+    }
+
+    std::vector<ConnectionPtr> SnapshotConnections() {
+        std::unique_lock<std::mutex> lock(__conn_mtx);
+        std::vector<ConnectionPtr> conns;
+        conns.reserve(__connections.size());
+        for(auto& [fd, conn] : __connections) conns.push_back(conn);
+        return conns;
+    }
+
+    void DoGracefulStop(std::chrono::milliseconds deadline) {
+        if(__draining.exchange(true)) return;
+        if(__close_listener_on_drain) {
+            __acceptor->AcceptPending();
+            __acceptor->Stop();
+            close(__listenfd);
+            __listenfd = -1;
+        } else {
+            __acceptor->Stop(); // 不再accept；监听socket保持打开，热重启时由新进程继续accept
+        }
+        // 这里在主Reactor的事件分发中（信号、热重启控制消息），同一批事件里可能还有监听fd，延后释放Acceptor
+        __main_reactor.QueueInLoop([acceptor = std::shared_ptr<Acceptor>(std::move(__acceptor))]() {});
+        std::vector<ConnectionPtr> conns = SnapshotConnections();
+        std::cout << "[Info] Stop accepting, draining " << conns.size() << " connections (deadline "
+                  << deadline.count() << "ms)..." << std::endl;
+        for(auto& conn : conns) {
+            conn->GetLoop()->RunInLoop([this, conn]() { DrainConnection(conn); });
+        }
+        auto expire = std::chrono::steady_clock::now() + deadline;
+        __main_reactor.RunEvery(std::chrono::milliseconds(20), [this, expire]() {
+            size_t remain = ConnectionCount();
+            if(remain == 0) {
+                std::cout << "[Info] All connections drained." << std::endl;
+                __main_reactor.stop();
+            } else if(std::chrono::steady_clock::now() >= expire) {
+                std::cout << "[Warning] Drain deadline reached, force closing " << remain << " connections." << std::endl;
+                for(auto& conn : SnapshotConnections()) conn->ForceClose();
+                __main_reactor.stop();
+            }
+        });
+    }
+
+    // 轮询选择未满的从Reactor；服务器已满或所有从Reactor都满时返回nullptr。需持有__conn_mtx
+    EpollEventLoop* PickSubReactor() {
+        if(__max_connections and __connections.size() >= __max_connections) return nullptr;
+        for(size_t i = 0; i < __sub_reactor_pool.size(); i++) {
+            EpollEventLoop* loop = __sub_reactor_pool.getNextSubReactor();
+            if(!__max_per_loop or __loop_conns[loop] < __max_per_loop) return loop;
+        }
+        return nullptr;
+    }
+
+    void NewConnection(int client_fd, const sockaddr_in& peer) {
+        // 先做最便宜的检查：超速的源IP直接关闭，不分配任何资源
+        if(!__rate_limiter.Allow(ntohl(peer.sin_addr.s_addr))) {
+            __rejected_rate.fetch_add(1, std::memory_order_relaxed);
+            close(client_fd);
+            return;
+        }
+        ConnectionPtr conn;
+        EpollEventLoop* sub_reactor;
+        {
+            std::unique_lock<std::mutex> lock(__conn_mtx);
+            // 获取一个从Reactor，将connfd交给从Reactor处理
+            sub_reactor = PickSubReactor();
+            if (!sub_reactor) {
+                lock.unlock();
+                __rejected_capacity.fetch_add(1, std::memory_order_relaxed);
+                close(client_fd); // 已达连接上限，关闭连接
+                return;
+            }
+            conn = std::make_shared<Connection>(sub_reactor, __work_pool, client_fd);
+            __connections[client_fd] = conn;
+            __loop_conns[sub_reactor]++;
+        }
+        __accepted.fetch_add(1, std::memory_order_relaxed);
+        conn->SetMessageCallback(__message_cb);
+        conn->SetConnectionCallback(__connection_cb);
+        conn->SetCloseCallback([this](const ConnectionPtr& c) { RemoveConnection(c); });
+        sub_reactor->RunInLoop([this, conn]() {
+            conn->ConnectEstablished();
+            // 排空开始前已被accept、但尚未注册的连接
+            if(__draining) DrainConnection(conn);
+        });
+    }
+
+    // fd在Connection析构时才关闭，所以移除前该fd不会被新连接复用
+    void RemoveConnection(const ConnectionPtr& conn) {
+        std::unique_lock<std::mutex> lock(__conn_mtx);
+        if(__connections.erase(conn->fd())) __loop_conns[conn->GetLoop()]--;
+    }
+
+    void Listen(uint16_t port) {
+        __listenfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if(__listenfd == -1) {
+            perror("Failed to create socket!");
+        }
+        int opt = 1;
+        setsockopt(__listenfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        // 多个进程可各自bind同一端口，内核按四元组哈希在各监听socket间分发新连接
+        setsockopt(__listenfd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = INADDR_ANY;
+        if(bind(__listenfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+            perror("Failed to bind socket!");
+        }
+        int ret = listen(__listenfd, 1024);
+        if(ret == -1) perror("Failed to set listening!");
+    }
+
+public:
+    // listenfd >= 0 时直接使用已在监听的socket（热重启时从旧进程接收），不再bind
+    TCPServer(uint16_t port, int sub_reactor_num = 4, int work_threads = 50, int listenfd = -1) :
+        __listenfd(listenfd), __main_reactor(), __work_pool(work_threads)
+    {
+        if(__listenfd < 0) Listen(port);
+        else SetNonBlocking(__listenfd);
+
+        __sub_reactor_pool.init(sub_reactor_num, __work_pool);
+
+        __acceptor = std::make_unique<Acceptor>(&__main_reactor, __listenfd);
+        __acceptor->SetNewConnectionCallback([this](int fd, const sockaddr_in& peer) {
+            NewConnection(fd, peer);
+        });
+        __acceptor->SetShedCallback([this]() { __shed.fetch_add(1, std::memory_order_relaxed); });
+    }
+
+    ~TCPServer() noexcept {
+        __main_reactor.stop();
+        __sub_reactor_pool.stop();
+        __acceptor.reset();
+        {
+            std::unique_lock<std::mutex> lock(__conn_mtx);
+            __connections.clear();
+        }
+        if(__listenfd != -1)
+            close(__listenfd);
+    }
+
+    // 需在start()之前设置
+    void SetMessageCallback(MessageCallback cb) { __message_cb = std::move(cb); }
+    void SetConnectionCallback(ConnectionCallback cb) { __connection_cb = std::move(cb); }
+    void SetDrainCallback(ConnectionCallback cb) { __drain_cb = std::move(cb); }
+    // 准入控制，0表示不限制
+    void SetMaxConnections(size_t max) { __max_connections = max; }
+    void SetMaxConnectionsPerLoop(size_t max) { __max_per_loop = max; }
+    // 优雅退出时关闭监听socket（先取走已排队的连接）。用于SO_REUSEPORT多进程：
+    // 组内监听socket仍打开就会继续被分到新连接，关闭后内核只向其他进程分发
+    void SetCloseListenerOnDrain(bool close) { __close_listener_on_drain = close; }
+    // 每个源IP每秒最多新建rate个连接，允许突发burst个；可在任意线程、多次调用
+    void SetRateLimit(double rate, double burst) {
+        __main_reactor.RunInLoop([this, rate, burst]() {
+            __rate_limiter.Configure(rate, burst);
+            if(__rate_limiter.Enabled() and __prune_timer == 0) {
+                __prune_timer = __main_reactor.RunEvery(std::chrono::seconds(10), [this]() { __rate_limiter.Prune(); });
+            } else if(!__rate_limiter.Enabled() and __prune_timer != 0) {
+                __main_reactor.CancelTimer(__prune_timer);
+                __prune_timer = 0;
+            }
+        });
+    }
+
+    ThreadPool& WorkPool() { return __work_pool; }
+    EpollEventLoop* MainReactor() { return &__main_reactor; }
+    size_t SubReactorCount() const { return __sub_reactor_pool.size(); }
+    EpollEventLoop* SubReactor(size_t idx) { return __sub_reactor_pool.getSubReactor(idx); }
+    int ListenFd() const { return __listenfd; }
+
+    size_t ConnectionCount() {
+        std::unique_lock<std::mutex> lock(__conn_mtx);
+        return __connections.size();
+    }
+
+    AdmissionStats GetAdmissionStats() const {
+        AdmissionStats stats;
+        stats.accepted = __accepted.load(std::memory_order_relaxed);
+        stats.rejected_capacity = __rejected_capacity.load(std::memory_order_relaxed);
+        stats.rejected_rate = __rejected_rate.load(std::memory_order_relaxed);
+        stats.shed_emfile = __shed.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void start()
+    {
+        __main_reactor.loop(); // 主Reactor启动事件循环（仅处理连接）
+    }
+
+    // 立即退出主循环，剩余连接在析构时直接关闭
+    void stop() { __main_reactor.stop(); }
+
+    // 优雅退出：停止accept，通知每个连接收尾（SetDrainCallback），
+    // 连接全部关闭或超过deadline（强制关闭剩余连接）后主循环返回
+    void GracefulStop(std::chrono::milliseconds deadline) {
+        __main_reactor.RunInLoop([this, deadline]() { DoGracefulStop(deadline); });
+    }
+};
+
+#endif // REACTOR_H
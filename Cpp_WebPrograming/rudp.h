@@ -0,0 +1,590 @@
+// 可靠UDP：在UDP之上提供按消息的可靠传输，每个对端（sockaddr_in）一个会话
+// - 每条消息一个数据报，带32位序号；接收方去重后立即交付，不等前面丢失的包（没有队头阻塞，也不保证顺序），
+//   适合自带请求id的请求/响应
+// - 确认：累计确认号 + 选择确认位图（覆盖整个接收窗口），优先捎带在反向数据包上，本轮没有数据可捎带时单独发ACK
+// - 重传：RTO按RFC 6298估算（只用未重传过的包采样），超时由时间轮驱动，逐次翻倍；
+//   比它晚发出的包已被确认3次、或被确认且已超过 srtt+重排窗口 的包判为丢失，立即重传（类RACK，按发送顺序而非序号判断，
+//   重传出去的包不会因为更早的确认被重复判丢）
+// - 拥塞控制：类Reno的慢启动/拥塞避免，判定丢包（快速或超时）时窗口减半，一个窗口内只减一次，最小为2
+//   （同RFC 9002，单次超时不把窗口打回1，否则随机丢包下每次都要等满一个RTO）；发送按 cwnd/srtt 的速率节拍化
+// - 同一个包超时重传 max_retransmits 次仍未确认时判定对端失联，拆除会话并回调 PeerDownCallback
+// - RudpOptions::loss_rate 按概率丢弃发出的包，用于在回环上测试
+//
+// 包头16字节（网络字节序），之后是 sack_words 个64位SACK字，再之后是消息：
+//   magic(1)=0xE7 | type(1) | sack_words(1) | flags(1) | conv(4) | seq(4) | ack(4)
+// ack为累计确认（此前的序号都已收到）；SACK第w个字的第i位表示序号 ack+1+w*64+i 已收到
+// conv由先发送的一方随机选取，每个conv的序号从0开始。收到对端任何一个本conv的包之前，数据包都带SYN标志：
+//   收到带SYN的未知conv：对端新建了会话（或重启），丢弃旧会话，从序号0开始接收
+//   收到不带SYN的未知conv：本端已丢失这个会话（重启或空闲回收），回RST；发送方收到RST后换一个新conv，
+//   把未确认的消息重新排队发送（这些消息可能已被交付过，应用须能识别重复的请求id）
+// 所有方法（Send除外）只能在loop线程中调用；析构须在loop线程中或loop停止之后
+
+#ifndef RUDP_H
+#define RUDP_H
+
+#include <netinet/in.h>
+
+#include <bitset>
+#include <random>
+#include <sstream>
+
+#include "reactor.h"
+
+constexpr uint8_t kRudpMagic = 0xE7;
+constexpr size_t kRudpHeaderSize = 16;
+constexpr size_t kRudpMaxPayload = 1200;  // 加上包头与SACK仍小于以太网MTU，避免IP分片
+constexpr uint32_t kRudpWindow = 1024;    // 发送方未确认包数上限，也是接收窗口
+constexpr size_t kRudpMaxSackWords = kRudpWindow / 64;
+
+constexpr uint8_t kRudpData = 1;
+constexpr uint8_t kRudpAck = 2;
+constexpr uint8_t kRudpReset = 3;
+
+constexpr uint8_t kRudpFlagSyn = 0x01;
+
+// 序号回绕后按有符号差比较
+inline bool RudpSeqBefore(uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) < 0; }
+
+struct RudpOptions {
+    int tick_ms = 1;                 // 时间轮刻度，也是节拍发送的最小间隔
+    int min_rto_ms = 2;              // 确认从不延迟，下限只需覆盖时间轮精度
+    int max_rto_ms = 2000;
+    double max_cwnd = 256;
+    int idle_timeout_ms = 30000;     // 没有未确认数据且空闲这么久的会话被回收
+    int max_retransmits = 10;        // 同一个包超时重传这么多次后判定对端失联（默认rto约15秒）
+    double loss_rate = 0;            // 测试用：发包丢弃概率
+};
+
+class RudpEndpoint {
+    using Clock = std::chrono::steady_clock;
+public:
+    using MessageCallback = std::function<void(const sockaddr_in& peer, std::string_view msg)>;
+    using PeerDownCallback = std::function<void(const sockaddr_in& peer, size_t unsent)>; // unsent：被丢弃的未确认消息数
+
+private:
+    struct OutPacket {
+        std::string payload;
+        Clock::time_point sent_at;
+        uint64_t tx = 0;      // 最近一次发送在本会话中的发送顺序
+        uint32_t xmit = 0;    // 发送次数，时间轮条目据此识别过期
+        int rto_ms = 0;       // 本包当前的超时，超时重传后翻倍
+        int skipped = 0;      // 比它晚发出的包被确认的次数
+        bool acked = false;
+    };
+
+    struct Session {
+        sockaddr_in peer{};
+        uint32_t conv = 0;
+        bool dead = false;
+        bool established = false; // 收到过对端本conv的包；之前发出的数据包带SYN
+
+        // 发送端：window[i] 对应序号 snd_una+i，queue 为等待拥塞窗口的消息
+        uint32_t snd_una = 0;
+        uint32_t snd_nxt = 0;
+        std::deque<OutPacket> window;
+        std::deque<std::string> queue;
+        uint64_t tx_count = 0;
+        uint32_t inflight = 0;
+        double cwnd = 2;
+        double ssthresh = kRudpWindow;
+        bool in_recovery = false;
+        uint32_t recover = 0;  // 进入恢复时的snd_nxt，确认越过它才退出；恢复期间窗口不增长，也不再减
+        double srtt_ms = 0;
+        double rttvar_ms = 0;
+        int rto_ms = 200;
+        double tokens = 0;
+        Clock::time_point last_refill;
+        bool paced = false;    // 已在节拍等待列表中
+
+        // 接收端：rcv_mask 记录 [rcv_nxt, rcv_nxt+kRudpWindow) 内已收到的序号（按 seq % kRudpWindow）
+        uint32_t rcv_nxt = 0;
+        uint32_t rcv_max = 0;  // 已收到的最大序号+1
+        std::bitset<kRudpWindow> rcv_mask;
+        bool ack_pending = false;
+
+        Clock::time_point last_active;
+    };
+    using SessionPtr = std::shared_ptr<Session>;
+
+    struct WheelEntry {
+        SessionPtr session;
+        uint32_t seq;
+        uint32_t xmit;
+        uint64_t due_tick;
+    };
+
+    static constexpr size_t kWheelSlots = 512;
+    static constexpr double kMinCwnd = 2;
+
+    EpollEventLoop* __loop;
+    int __fd;
+    RudpOptions __opts;
+    Channel __channel;
+    EpollEventLoop::TimerId __tick_timer = 0;
+    MessageCallback __message_cb;
+    PeerDownCallback __peer_down_cb;
+
+    std::unordered_map<uint64_t, SessionPtr> __sessions; // key: IP<<16 | port
+    std::vector<SessionPtr> __ack_dirty;                 // 本轮收到过数据、可能需要单独回ACK的会话
+    std::vector<SessionPtr> __paced;                     // 被节拍限制、下个刻度继续发送的会话
+    std::vector<std::vector<WheelEntry>> __wheel;
+    uint64_t __tick_no = 0;
+
+    std::mt19937 __rng{std::random_device{}()};
+    std::uniform_real_distribution<double> __loss_dist{0.0, 1.0};
+
+    std::atomic<uint64_t> __sent{0};
+    std::atomic<uint64_t> __received{0};
+    std::atomic<uint64_t> __delivered{0};
+    std::atomic<uint64_t> __duplicates{0};
+    std::atomic<uint64_t> __timeout_retransmits{0};
+    std::atomic<uint64_t> __fast_retransmits{0};
+    std::atomic<uint64_t> __injected_drops{0};
+    std::atomic<uint64_t> __send_errors{0};
+    std::atomic<uint64_t> __resets_sent{0};
+    std::atomic<uint64_t> __resets_received{0};
+    std::atomic<uint64_t> __peers_down{0};
+
+    static void Add(std::atomic<uint64_t>& counter, uint64_t n = 1) { counter.fetch_add(n, std::memory_order_relaxed); }
+
+    static uint64_t PeerKey(const sockaddr_in& addr) {
+        return (static_cast<uint64_t>(addr.sin_addr.s_addr) << 16) | addr.sin_port;
+    }
+
+    SessionPtr NewSession(const sockaddr_in& peer, uint32_t conv) {
+        auto s = std::make_shared<Session>();
+        s->peer = peer;
+        while(conv == 0) conv = __rng();
+        s->conv = conv;
+        s->rto_ms = std::max(__opts.min_rto_ms, 200);
+        s->tokens = s->cwnd;
+        s->last_refill = s->last_active = Clock::now();
+        auto& slot = __sessions[PeerKey(peer)];
+        if(slot) slot->dead = true; // 旧会话可能还挂在时间轮或各列表里，标记后自然失效
+        slot = s;
+        return s;
+    }
+
+    // 以新conv重建会话（对端回了RST时conv为0，随机选一个；对端重启发来SYN时用对端的conv），
+    // 旧会话里未确认的消息按序号顺序移到新会话重新发送
+    SessionPtr RestartSession(const SessionPtr& old, uint32_t conv) {
+        std::deque<std::string> pending;
+        for(auto& pkt : old->window) {
+            if(!pkt.acked) pending.push_back(std::move(pkt.payload));
+        }
+        for(auto& msg : old->queue) pending.push_back(std::move(msg));
+        SessionPtr s = NewSession(old->peer, conv);
+        s->queue = std::move(pending);
+        return s;
+    }
+
+    // 对端失联：拆除会话，未确认的消息丢弃
+    void DropSession(const SessionPtr& s) {
+        s->dead = true;
+        auto it = __sessions.find(PeerKey(s->peer));
+        if(it != __sessions.end() and it->second == s) __sessions.erase(it);
+        size_t unsent = s->queue.size();
+        for(auto& pkt : s->window) unsent += !pkt.acked;
+        Add(__peers_down);
+        if(__peer_down_cb) __peer_down_cb(s->peer, unsent);
+    }
+
+    // ---------------- 发送 ----------------
+
+    void SendPacket(Session& s, uint8_t type, uint32_t seq, std::string_view payload) {
+        s.ack_pending = false; // 每个包都带着当前的确认
+        if(__opts.loss_rate > 0 and __loss_dist(__rng) < __opts.loss_rate) {
+            Add(__injected_drops);
+            return;
+        }
+        // 需要的SACK字数：覆盖到已收到的最大序号
+        size_t words = 0;
+        if(RudpSeqBefore(s.rcv_nxt + 1, s.rcv_max))
+            words = std::min<size_t>((s.rcv_max - s.rcv_nxt - 1 + 63) / 64, kRudpMaxSackWords);
+        char buf[kRudpHeaderSize + kRudpMaxSackWords * 8 + kRudpMaxPayload];
+        buf[0] = static_cast<char>(kRudpMagic);
+        buf[1] = static_cast<char>(type);
+        buf[2] = static_cast<char>(words);
+        buf[3] = static_cast<char>(type == kRudpData and !s.established ? kRudpFlagSyn : 0);
+        uint32_t conv = htonl(s.conv), nseq = htonl(seq), ack = htonl(s.rcv_nxt);
+        memcpy(buf + 4, &conv, 4);
+        memcpy(buf + 8, &nseq, 4);
+        memcpy(buf + 12, &ack, 4);
+        for(size_t w = 0; w < words; w++) {
+            uint64_t bits = 0;
+            for(uint32_t i = 0; i < 64; i++) {
+                uint32_t sq = s.rcv_nxt + 1 + static_cast<uint32_t>(w * 64 + i);
+                if(!RudpSeqBefore(sq, s.rcv_max)) break;
+                if(s.rcv_mask[sq % kRudpWindow]) bits |= uint64_t(1) << i;
+            }
+            bits = htobe64(bits);
+            memcpy(buf + kRudpHeaderSize + w * 8, &bits, 8);
+        }
+        size_t len = kRudpHeaderSize + words * 8;
+        if(!payload.empty()) memcpy(buf + len, payload.data(), payload.size());
+        len += payload.size();
+        ssize_t n = sendto(__fd, buf, len, 0, reinterpret_cast<const sockaddr*>(&s.peer), sizeof(s.peer));
+        if(n < 0) Add(__send_errors); // 缓冲区满等错误当作丢包，由重传恢复
+        else Add(__sent);
+    }
+
+    // 回复RST：只有包头，conv为对方包里的conv
+    void SendReset(const sockaddr_in& to, uint32_t conv) {
+        char buf[kRudpHeaderSize] = {};
+        buf[0] = static_cast<char>(kRudpMagic);
+        buf[1] = static_cast<char>(kRudpReset);
+        uint32_t nconv = htonl(conv);
+        memcpy(buf + 4, &nconv, 4);
+        if(sendto(__fd, buf, sizeof(buf), 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to)) < 0) Add(__send_errors);
+        else Add(__resets_sent);
+    }
+
+    void Schedule(const SessionPtr& s, uint32_t seq, const OutPacket& pkt) {
+        uint64_t ticks = (pkt.rto_ms + __opts.tick_ms - 1) / __opts.tick_ms;
+        uint64_t due = __tick_no + std::max<uint64_t>(ticks, 1);
+        __wheel[due % kWheelSlots].push_back(WheelEntry{s, seq, pkt.xmit, due});
+    }
+
+    void Transmit(const SessionPtr& s, uint32_t seq, OutPacket& pkt, int rto_ms) {
+        pkt.tx = ++s->tx_count;
+        pkt.xmit++;
+        pkt.sent_at = Clock::now();
+        pkt.rto_ms = rto_ms;
+        pkt.skipped = 0;
+        SendPacket(*s, kRudpData, seq, pkt.payload);
+        Schedule(s, seq, pkt);
+    }
+
+    // 节拍：令牌按 cwnd/srtt 的速率补充（慢启动时加倍），最多积累四分之一个窗口
+    void Refill(Session& s) {
+        auto now = Clock::now();
+        double elapsed_ms = std::chrono::duration<double, std::milli>(now - s.last_refill).count();
+        s.last_refill = now;
+        double burst = std::max(2.0, s.cwnd / 4);
+        if(s.srtt_ms <= 0) {
+            s.tokens = burst; // 还没有RTT样本，不限速
+            return;
+        }
+        double gain = s.cwnd < s.ssthresh ? 2.0 : 1.25;
+        s.tokens = std::min(burst, s.tokens + elapsed_ms * gain * s.cwnd / s.srtt_ms);
+    }
+
+    void TrySend(const SessionPtr& s) {
+        if(s->dead or s->queue.empty()) return;
+        Refill(*s);
+        while(!s->queue.empty() and s->inflight < s->cwnd and s->window.size() < kRudpWindow and (s->tokens >= 1 or s->inflight == 0)) {
+            uint32_t seq = s->snd_nxt++;
+            s->window.emplace_back();
+            OutPacket& pkt = s->window.back();
+            pkt.payload = std::move(s->queue.front());
+            s->queue.pop_front();
+            s->inflight++;
+            s->tokens -= 1;
+            Transmit(s, seq, pkt, s->rto_ms);
+        }
+        // 没有在途包时不受节拍限制（否则没有确认来驱动下一次发送）；
+        // 只被令牌挡住时等下一个刻度，被窗口挡住时等确认到来
+        if(!s->queue.empty() and s->tokens < 1 and s->inflight < s->cwnd and !s->paced) {
+            s->paced = true;
+            __paced.push_back(s);
+        }
+    }
+
+    // ---------------- 确认与拥塞控制 ----------------
+
+    void SampleRtt(Session& s, double rtt_ms) {
+        if(s.srtt_ms <= 0) {
+            s.srtt_ms = rtt_ms;
+            s.rttvar_ms = rtt_ms / 2;
+        } else {
+            s.rttvar_ms = 0.75 * s.rttvar_ms + 0.25 * std::abs(s.srtt_ms - rtt_ms);
+            s.srtt_ms = 0.875 * s.srtt_ms + 0.125 * rtt_ms;
+        }
+        int rto = static_cast<int>(s.srtt_ms + std::max(4 * s.rttvar_ms, static_cast<double>(__opts.tick_ms)));
+        s.rto_ms = std::clamp(rto, __opts.min_rto_ms, __opts.max_rto_ms);
+    }
+
+    void MarkAcked(Session& s, OutPacket& pkt, Clock::time_point now) {
+        if(pkt.acked) return;
+        pkt.acked = true;
+        pkt.payload.clear();
+        pkt.payload.shrink_to_fit();
+        s.inflight--;
+        if(pkt.xmit == 1) SampleRtt(s, std::chrono::duration<double, std::milli>(now - pkt.sent_at).count());
+        if(s.in_recovery) return;
+        s.cwnd += s.cwnd < s.ssthresh ? 1.0 : 1.0 / s.cwnd;
+        s.cwnd = std::min(s.cwnd, __opts.max_cwnd);
+    }
+
+    void OnCongestion(Session& s) {
+        if(s.in_recovery) return;
+        s.ssthresh = std::max(s.cwnd / 2, kMinCwnd);
+        s.cwnd = s.ssthresh;
+        s.in_recovery = true;
+        s.recover = s.snd_nxt;
+    }
+
+    void HandleAck(const SessionPtr& s, uint32_t ack, const char* sack, size_t words) {
+        if(RudpSeqBefore(s->snd_nxt, ack)) return; // 确认了还没发出的序号，非法
+        auto now = Clock::now();
+        uint64_t highest_tx = 0; // 本次新确认的包中最晚的发送顺序
+        for(uint32_t seq = s->snd_una; RudpSeqBefore(seq, ack); seq++) {
+            OutPacket& pkt = s->window[seq - s->snd_una];
+            if(!pkt.acked) {
+                highest_tx = std::max(highest_tx, pkt.tx);
+                MarkAcked(*s, pkt, now);
+            }
+        }
+        for(size_t w = 0; w < words; w++) {
+            uint64_t bits;
+            memcpy(&bits, sack + w * 8, 8);
+            bits = be64toh(bits);
+            while(bits) {
+                int i = __builtin_ctzll(bits);
+                bits &= bits - 1;
+                uint32_t seq = ack + 1 + static_cast<uint32_t>(w * 64 + i);
+                if(!RudpSeqBefore(seq, s->snd_nxt)) break;
+                if(RudpSeqBefore(seq, s->snd_una)) continue; // 乱序到达的旧ACK
+                OutPacket& pkt = s->window[seq - s->snd_una];
+                if(!pkt.acked) {
+                    highest_tx = std::max(highest_tx, pkt.tx);
+                    MarkAcked(*s, pkt, now);
+                }
+            }
+        }
+        if(highest_tx == 0) return;
+        // 判丢的时间门限：srtt + 重排窗口srtt/4，至少0.1ms
+        auto reorder = std::chrono::duration<double, std::milli>(std::max(s->srtt_ms * 1.25, 0.1));
+        for(uint32_t seq = s->snd_una; RudpSeqBefore(seq, s->snd_nxt); seq++) {
+            OutPacket& pkt = s->window[seq - s->snd_una];
+            if(pkt.acked or pkt.tx > highest_tx) continue;
+            if(++pkt.skipped < 3 and now - pkt.sent_at < reorder) continue;
+            Add(__fast_retransmits);
+            OnCongestion(*s);
+            Transmit(s, seq, pkt, s->rto_ms);
+        }
+        while(!s->window.empty() and s->window.front().acked) {
+            s->window.pop_front();
+            s->snd_una++;
+        }
+        if(s->in_recovery and !RudpSeqBefore(s->snd_una, s->recover)) s->in_recovery = false;
+        TrySend(s);
+    }
+
+    // ---------------- 接收 ----------------
+
+    // 返回true表示是新消息，需要交付
+    bool AcceptData(Session& s, uint32_t seq) {
+        s.ack_pending = true;
+        if(RudpSeqBefore(seq, s.rcv_nxt) or (seq - s.rcv_nxt < kRudpWindow and s.rcv_mask[seq % kRudpWindow])) {
+            Add(__duplicates);
+            return false;
+        }
+        if(seq - s.rcv_nxt >= kRudpWindow) return false; // 超出接收窗口，丢弃，等对端重传
+        s.rcv_mask.set(seq % kRudpWindow);
+        if(!RudpSeqBefore(seq, s.rcv_max)) s.rcv_max = seq + 1;
+        while(s.rcv_mask[s.rcv_nxt % kRudpWindow]) {
+            s.rcv_mask.reset(s.rcv_nxt % kRudpWindow);
+            s.rcv_nxt++;
+        }
+        return true;
+    }
+
+    void HandlePacket(const sockaddr_in& from, const char* data, size_t len) {
+        if(len < kRudpHeaderSize or static_cast<uint8_t>(data[0]) != kRudpMagic) return;
+        uint8_t type = static_cast<uint8_t>(data[1]);
+        size_t words = static_cast<uint8_t>(data[2]);
+        uint8_t flags = static_cast<uint8_t>(data[3]);
+        size_t header = kRudpHeaderSize + words * 8;
+        if(words > kRudpMaxSackWords or len < header) return;
+        uint32_t conv, seq, ack;
+        memcpy(&conv, data + 4, 4);
+        memcpy(&seq, data + 8, 4);
+        memcpy(&ack, data + 12, 4);
+        conv = ntohl(conv);
+        seq = ntohl(seq);
+        ack = ntohl(ack);
+        Add(__received);
+
+        auto it = __sessions.find(PeerKey(from));
+        SessionPtr s = it == __sessions.end() ? nullptr : it->second;
+        if(type == kRudpReset) {
+            // 只认当前会话的conv：旧conv的包在路上被RST是正常的
+            if(s and s->conv == conv) {
+                Add(__resets_received);
+                TrySend(RestartSession(s, 0));
+            }
+            return;
+        }
+        if(type == kRudpData) {
+            if(!s or s->conv != conv) {
+                if(!(flags & kRudpFlagSyn)) {
+                    SendReset(from, conv); // 对端以为会话还在，序号接不上，让它重建
+                    return;
+                }
+                // 双方同时发起时各自带着SYN：保留conv大的一方，对端收到我们的SYN后会改用我们的conv
+                if(s and !s->established and s->conv > conv) return;
+                s = s ? RestartSession(s, conv) : NewSession(from, conv);
+                s->established = true;
+                TrySend(s);
+            }
+        } else if(type != kRudpAck or !s or s->conv != conv) {
+            return;
+        }
+        s->established = true;
+        s->last_active = Clock::now();
+        HandleAck(s, ack, data + kRudpHeaderSize, words);
+        if(type != kRudpData) return;
+        if(__ack_dirty.empty() or __ack_dirty.back() != s) __ack_dirty.push_back(s);
+        if(AcceptData(*s, seq)) {
+            Add(__delivered);
+            if(__message_cb) __message_cb(s->peer, std::string_view(data + header, len - header));
+        }
+    }
+
+    void HandleRead() {
+        char buf[2048];
+        for(int i = 0; i < 256; i++) { // 每次最多处理256个数据报，避免饿死其他事件
+            sockaddr_in from{};
+            socklen_t addr_len = sizeof(from);
+            ssize_t n = recvfrom(__fd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &addr_len);
+            if(n < 0) {
+                if(errno == EINTR) continue;
+                break; // EAGAIN，或ICMP不可达等错误，交给重传
+            }
+            HandlePacket(from, buf, n);
+        }
+        FlushAcks();
+    }
+
+    // 收到的数据在本轮没有被响应数据捎带确认时，单独回一个ACK
+    void FlushAcks() {
+        for(auto& s : __ack_dirty) {
+            if(!s->dead and s->ack_pending) SendPacket(*s, kRudpAck, 0, {});
+        }
+        __ack_dirty.clear();
+    }
+
+    // ---------------- 时间轮 ----------------
+
+    void OnTick() {
+        __tick_no++;
+        auto& slot = __wheel[__tick_no % kWheelSlots];
+        std::vector<WheelEntry> entries;
+        entries.swap(slot);
+        for(auto& e : entries) {
+            if(e.due_tick > __tick_no) {
+                slot.push_back(std::move(e)); // 还没转到这一圈
+                continue;
+            }
+            Session& s = *e.session;
+            if(s.dead or RudpSeqBefore(e.seq, s.snd_una)) continue;
+            OutPacket& pkt = s.window[e.seq - s.snd_una];
+            if(pkt.acked or pkt.xmit != e.xmit) continue; // 已确认，或已被快速重传取代
+            if(static_cast<int>(pkt.xmit) > __opts.max_retransmits) {
+                DropSession(e.session);
+                continue;
+            }
+            Add(__timeout_retransmits);
+            OnCongestion(s);
+            Transmit(e.session, e.seq, pkt, std::min(pkt.rto_ms * 2, __opts.max_rto_ms));
+        }
+        std::vector<SessionPtr> paced;
+        paced.swap(__paced);
+        for(auto& s : paced) {
+            s->paced = false;
+            TrySend(s);
+        }
+        FlushAcks();
+        if(__tick_no % std::max(1, 1000 / __opts.tick_ms) == 0) ReapIdle(); // 约每秒一次
+    }
+
+    void ReapIdle() {
+        auto now = Clock::now();
+        for(auto it = __sessions.begin(); it != __sessions.end();) {
+            Session& s = *it->second;
+            if(s.window.empty() and s.queue.empty() and now - s.last_active > std::chrono::milliseconds(__opts.idle_timeout_ms)) {
+                s.dead = true;
+                it = __sessions.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void SendInLoop(const sockaddr_in& peer, std::string msg) {
+        auto it = __sessions.find(PeerKey(peer));
+        SessionPtr s = it == __sessions.end() ? NewSession(peer, 0) : it->second;
+        s->last_active = Clock::now();
+        s->queue.push_back(std::move(msg));
+        TrySend(s);
+    }
+
+public:
+    // fd为已绑定的UDP socket（见OpenSocket），由调用者负责关闭
+    RudpEndpoint(EpollEventLoop* loop, int fd, RudpOptions opts = {}) :
+        __loop(loop), __fd(fd), __opts(opts), __channel(fd), __wheel(kWheelSlots) {
+            __opts.tick_ms = std::max(1, __opts.tick_ms);
+            fcntl(__fd, F_SETFL, fcntl(__fd, F_GETFL) | O_NONBLOCK);
+            __channel.SetReadCallBack([this]() { HandleRead(); });
+            __loop->AddChannel(&__channel);
+            __tick_timer = __loop->RunEvery(std::chrono::milliseconds(__opts.tick_ms), [this]() { OnTick(); });
+        }
+
+    ~RudpEndpoint() noexcept {
+        __loop->DelChannel(&__channel);
+        __loop->CancelTimer(__tick_timer);
+    }
+
+    RudpEndpoint(const RudpEndpoint&) = delete;
+    RudpEndpoint& operator=(const RudpEndpoint&) = delete;
+
+    // 创建并绑定非阻塞UDP socket，port为0时由内核分配；失败返回-1
+    static int OpenSocket(uint16_t port) {
+        int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if(fd == -1) return -1;
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = INADDR_ANY;
+        if(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void SetMessageCallback(MessageCallback cb) { __message_cb = std::move(cb); }
+    void SetPeerDownCallback(PeerDownCallback cb) { __peer_down_cb = std::move(cb); }
+
+    // 可在任意线程调用；消息超过kRudpMaxPayload时返回false
+    bool Send(const sockaddr_in& peer, std::string msg) {
+        if(msg.size() > kRudpMaxPayload) return false;
+        if(__loop->IsInLoopThread()) {
+            SendInLoop(peer, std::move(msg));
+        } else {
+            __loop->QueueInLoop([this, peer, msg = std::move(msg)]() mutable { SendInLoop(peer, std::move(msg)); });
+        }
+        return true;
+    }
+
+    size_t SessionCount() const { return __sessions.size(); }
+
+    std::string StatsText() const {
+        std::ostringstream os;
+        os << "packets sent " << __sent.load() << ", received " << __received.load() << ", injected drops "
+           << __injected_drops.load() << ", send errors " << __send_errors.load() << "\n"
+           << "messages delivered " << __delivered.load() << ", duplicates " << __duplicates.load() << "\n"
+           << "retransmits: timeout " << __timeout_retransmits.load() << ", fast " << __fast_retransmits.load() << "\n"
+           << "resets sent " << __resets_sent.load() << ", received " << __resets_received.load() << ", peers down "
+           << __peers_down.load() << "\n";
+        for(auto& [key, s] : __sessions) {
+            os << inet_ntoa(s->peer.sin_addr) << ":" << ntohs(s->peer.sin_port) << " cwnd " << s->cwnd << ", srtt "
+               << s->srtt_ms << "ms, rto " << s->rto_ms << "ms, inflight " << s->inflight << ", queued " << s->queue.size()
+               << "\n";
+        }
+        return os.str();
+    }
+};
+
+#endif // RUDP_H
@@ -0,0 +1,226 @@
+// 可靠UDP回环测试：同一个loop里一个回显端点、一个客户端端点，两端按给定概率丢弃发出的包，
+// 客户端保持depth个在途请求，检查每个请求都恰好收到一次响应，统计吞吐、延迟分位数与重传
+// 最后一项：服务端中途重启（新端点接管同一个socket），客户端应收到RST后换conv继续；之后服务端彻底消失，
+// 客户端应在重传上限后判定对端失联并拆除会话
+// 用法: ./rudp_bench [在途请求数，默认32] [每档秒数，默认2] [丢包率列表(%)，默认0,1,5,10,20]
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rudp.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct LossResult {
+    uint64_t completed = 0;
+    uint64_t bad = 0; // 重复或未知的响应
+    double seconds = 0;
+    std::vector<double> latency_us;
+    std::string server_stats;
+    std::string client_stats;
+};
+
+static LossResult RunLoss(double loss, int depth, int seconds)
+{
+    LossResult r;
+    EpollEventLoop loop;
+    RudpOptions opts;
+    opts.loss_rate = loss;
+    int server_fd = RudpEndpoint::OpenSocket(0);
+    int client_fd = RudpEndpoint::OpenSocket(0);
+    if(server_fd == -1 or client_fd == -1) throw std::runtime_error(std::string("socket failed: ") + strerror(errno));
+    sockaddr_in server_addr{};
+    socklen_t len = sizeof(server_addr);
+    getsockname(server_fd, reinterpret_cast<sockaddr*>(&server_addr), &len);
+    server_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    {
+        RudpEndpoint server(&loop, server_fd, opts);
+        RudpEndpoint client(&loop, client_fd, opts);
+        server.SetMessageCallback([&server](const sockaddr_in& peer, std::string_view msg) {
+            server.Send(peer, std::string(msg));
+        });
+
+        // 请求：8字节id + 填充；响应原样回显
+        std::unordered_map<uint64_t, Clock::time_point> pending;
+        uint64_t next_id = 1;
+        auto start = Clock::now();
+        auto deadline = start + std::chrono::seconds(seconds);
+        std::string filler(56, 'x');
+        auto issue = [&]() {
+            uint64_t id = next_id++;
+            std::string msg(reinterpret_cast<const char*>(&id), 8);
+            msg += filler;
+            pending.emplace(id, Clock::now());
+            client.Send(server_addr, std::move(msg));
+        };
+        client.SetMessageCallback([&](const sockaddr_in&, std::string_view msg) {
+            uint64_t id = 0;
+            if(msg.size() >= 8) memcpy(&id, msg.data(), 8);
+            auto it = pending.find(id);
+            if(it == pending.end()) {
+                r.bad++;
+                return;
+            }
+            auto now = Clock::now();
+            r.completed++;
+            r.latency_us.push_back(std::chrono::duration<double, std::micro>(now - it->second).count());
+            pending.erase(it);
+            if(now < deadline) issue();
+            else if(pending.empty()) loop.stop();
+        });
+        for(int i = 0; i < depth; i++) issue();
+        loop.loop();
+        r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        r.server_stats = server.StatsText();
+        r.client_stats = client.StatsText();
+    }
+    close(server_fd);
+    close(client_fd);
+    std::sort(r.latency_us.begin(), r.latency_us.end());
+    return r;
+}
+
+static void RunRestart(int depth)
+{
+    EpollEventLoop loop;
+    RudpOptions opts;
+    opts.max_rto_ms = 100;
+    opts.max_retransmits = 5;
+    int server_fd = RudpEndpoint::OpenSocket(0);
+    int client_fd = RudpEndpoint::OpenSocket(0);
+    if(server_fd == -1 or client_fd == -1) throw std::runtime_error(std::string("socket failed: ") + strerror(errno));
+    sockaddr_in server_addr{};
+    socklen_t len = sizeof(server_addr);
+    getsockname(server_fd, reinterpret_cast<sockaddr*>(&server_addr), &len);
+    server_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    std::unique_ptr<RudpEndpoint> server;
+    auto start_server = [&]() {
+        server = std::make_unique<RudpEndpoint>(&loop, server_fd, opts);
+        server->SetMessageCallback([&server](const sockaddr_in& peer, std::string_view msg) {
+            server->Send(peer, std::string(msg));
+        });
+    };
+    std::string client_stats;
+    {
+        RudpEndpoint client(&loop, client_fd, opts);
+        start_server();
+
+        enum Phase { kBefore, kAfter, kGone };
+        Phase phase = kBefore;
+        uint64_t next_id = 1, completed[3] = {}, bad = 0;
+        std::unordered_map<uint64_t, Phase> pending;
+        auto issue = [&]() {
+            uint64_t id = next_id++;
+            pending.emplace(id, phase);
+            client.Send(server_addr, std::string(reinterpret_cast<const char*>(&id), 8));
+        };
+        client.SetMessageCallback([&](const sockaddr_in&, std::string_view msg) {
+            uint64_t id = 0;
+            if(msg.size() >= 8) memcpy(&id, msg.data(), 8);
+            auto it = pending.find(id);
+            if(it == pending.end()) {
+                bad++; // 重启前已交付过、重启后又重发的请求会得到第二个响应
+                return;
+            }
+            completed[it->second]++;
+            pending.erase(it);
+            if(phase != kGone) issue();
+        });
+        Clock::time_point gone_at;
+        size_t down_unsent = 0;
+        double down_ms = -1;
+        client.SetPeerDownCallback([&](const sockaddr_in&, size_t unsent) {
+            down_unsent = unsent;
+            down_ms = std::chrono::duration<double, std::milli>(Clock::now() - gone_at).count();
+            loop.stop();
+        });
+        // 端点的析构要在本轮事件分发完之后做：socket的Channel可能就在这一批里
+        loop.RunAfter(std::chrono::milliseconds(500), [&]() {
+            loop.QueueInLoop([&]() {
+                server.reset();
+                start_server();
+                phase = kAfter;
+                // 旧服务端已确认但没来得及回显的请求不会再有响应，补上新的请求保持在途数
+                for(int i = 0; i < depth; i++) issue();
+            });
+        });
+        loop.RunAfter(std::chrono::milliseconds(1000), [&]() {
+            loop.QueueInLoop([&]() {
+                server.reset();
+                phase = kGone;
+                gone_at = Clock::now();
+                for(int i = 0; i < depth; i++) issue(); // 发往已不存在的对端，只能靠重传上限结束
+            });
+        });
+        loop.RunAfter(std::chrono::milliseconds(10000), [&]() { loop.stop(); });
+        for(int i = 0; i < depth; i++) issue();
+        loop.loop();
+
+        size_t lost = 0;
+        for(auto& [id, p] : pending) lost += p == kBefore;
+        std::cout << "\nserver restart at 0.5s, gone at 1.0s\n"
+                  << "  completed before restart " << completed[kBefore] << ", after restart " << completed[kAfter]
+                  << ", lost in restart " << lost << ", duplicate responses " << bad << "\n";
+        if(down_ms < 0) std::cout << "  PEER NOT DECLARED DOWN\n";
+        else std::cout << "  peer down after " << std::fixed << std::setprecision(0) << down_ms << std::defaultfloat
+                       << " ms, " << down_unsent << " messages dropped, sessions left " << client.SessionCount() << "\n";
+        if(completed[kAfter] == 0) std::cout << "  NO PROGRESS AFTER RESTART\n";
+        client_stats = client.StatsText();
+    }
+    close(server_fd);
+    close(client_fd);
+    std::cout << "[client]\n" << client_stats;
+}
+
+int main(int argc, char* argv[])
+{
+    int depth = argc > 1 ? std::stoi(argv[1]) : 32;
+    int seconds = argc > 2 ? std::stoi(argv[2]) : 2;
+    std::vector<double> losses;
+    std::string list = argc > 3 ? argv[3] : "0,1,5,10,20";
+    for(size_t pos = 0; pos < list.size();) {
+        size_t comma = list.find(',', pos);
+        if(comma == std::string::npos) comma = list.size();
+        losses.push_back(std::stod(list.substr(pos, comma - pos)) / 100);
+        pos = comma + 1;
+    }
+
+    std::cout << "reliable UDP loopback, " << depth << " requests in flight, " << seconds << "s per loss rate\n\n"
+              << std::setw(6) << "loss%" << std::setw(12) << "req/s" << std::setw(10) << "p50" << std::setw(10) << "p99"
+              << std::setw(10) << "max" << "  (us)" << std::endl;
+    std::vector<std::pair<double, LossResult>> results;
+    try {
+        for(double loss : losses) {
+            LossResult r = RunLoss(loss, depth, seconds);
+            auto pct = [&r](double p) {
+                return r.latency_us.empty() ? 0.0 : r.latency_us[static_cast<size_t>(p / 100 * (r.latency_us.size() - 1))];
+            };
+            std::cout << std::setw(6) << loss * 100 << std::fixed << std::setprecision(0) << std::setw(12)
+                      << r.completed / r.seconds << std::setw(10) << pct(50) << std::setw(10) << pct(99) << std::setw(10)
+                      << (r.latency_us.empty() ? 0.0 : r.latency_us.back());
+            if(r.bad) std::cout << "  BAD RESPONSES " << r.bad;
+            std::cout << std::defaultfloat << std::endl;
+            results.emplace_back(loss, std::move(r));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    for(auto& [loss, r] : results) {
+        std::cout << "\n--- loss " << loss * 100 << "% ---\n[client]\n" << r.client_stats << "[server]\n" << r.server_stats;
+    }
+    try {
+        RunRestart(depth);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
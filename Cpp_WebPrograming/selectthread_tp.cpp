@@ -4,7 +4,6 @@
 #include <sys/select.h>
 #include <unistd.h>
 #include <string>
-#include <set>
 #include <algorithm>
 #include <thread>
 #include <cerrno>
@@ -19,6 +18,8 @@
 #include <queue>
 #include <functional>
 
+#include "fd_registry.h"
+
 class ThreadPool
 {
 
@@ -107,21 +108,44 @@ public:
 class TCPServer
 {
 private:
-    int max_fd;
     int server_fd;
-    fd_set read_fds;
+    fd_set read_fds;                  // 以下两项只由select线程访问，随registry的变更同步
+    int max_fd;
     std::atomic<bool> is_running;
     const uint16_t server_port;
-    std::set<int,std::greater<int>> client_fds;
-    std::mutex mtx;
+    FdRegistry registry;              // 监听fd和所有客户端fd，增删在两次select之间批量生效
     ThreadPool pool;
 
+    // 把登记的增删同步到fd_set，max_fd由registry维护
+    void apply_changes()
+    {
+        registry.Apply([this](int fd, bool added)
+        {
+            if(added) FD_SET(fd, &read_fds);
+            else FD_CLR(fd, &read_fds);
+        });
+        max_fd = registry.MaxFd();
+    }
+
+    void close_clients()
+    {
+        apply_changes();
+        std::vector<pollfd> fds = registry.PollFds();
+        for(const pollfd& pfd : fds)
+            if(pfd.fd != server_fd) disconnect(pfd.fd);
+        apply_changes();
+    }
+
+    void disconnect(int fd)
+    {
+        close(fd);
+        registry.Remove(fd);
+    }
+
     void error(const std::string& msg, bool CloseServer = true)
     {
-        std::unique_lock<std::mutex> lock(mtx);
         std::cerr << "[Error] " << msg << std::endl;
-        for(int fd : client_fds) if(fd != -1) close(fd);
-        client_fds.clear();
+        close_clients();
         if(CloseServer and server_fd != -1)
         {
             close(server_fd);
@@ -133,7 +157,7 @@ private:
 
 public:
 
-    explicit TCPServer(const uint16_t _port) : server_port(_port), server_fd(-1), max_fd(-1), is_running(true), pool(10)
+    explicit TCPServer(const uint16_t _port) : server_fd(-1), max_fd(-1), is_running(true), server_port(_port), pool(10)
     {
         FD_ZERO(&read_fds);
     }
@@ -141,9 +165,7 @@ public:
     ~TCPServer() noexcept
     {
         stop();
-        std::unique_lock<std::mutex> lock(mtx);
-        for(int fd : client_fds) if(fd != -1) close(fd);
-        client_fds.clear();
+        close_clients();
         if(server_fd != -1) close(server_fd);
     }
 
@@ -177,8 +199,7 @@ public:
             error("Failed to listen on socket!");
         }
 
-        FD_SET(server_fd, &read_fds);
-        max_fd = server_fd;
+        registry.Add(server_fd);
 
         std::cout << "Server is currently listening on port: " << server_port << std::endl; 
     }
@@ -191,13 +212,8 @@ public:
         if(len <= 0)
         {
             std::cout << "[Info] Client " << fd << " disconnected\n";
-            // 加锁修改共享资源
-            std::unique_lock<std::mutex> lock(mtx);
-            close(fd);
-            FD_CLR(fd, &read_fds);
-            client_fds.erase(fd);
-            if(client_fds.empty()) max_fd = server_fd;
-            else max_fd = std::max(server_fd, *client_fds.begin());
+            // 关闭后登记删除，下一次select前生效
+            disconnect(fd);
             return;
         }
         std::string msg(buffer,len);
@@ -212,11 +228,14 @@ public:
     {
         int cfd = accept(server_fd, nullptr, nullptr);
         if(cfd < 0) return;
-        // 加锁修改共享资源
-        std::unique_lock<std::mutex> lock(mtx);
-        FD_SET(cfd, &read_fds);
-        client_fds.insert(cfd);
-        max_fd = std::max(max_fd, cfd);
+        // fd_set只能容纳FD_SETSIZE以内的fd，超出的连接直接拒绝
+        if(cfd >= FD_SETSIZE)
+        {
+            std::cerr << "[Warning] Client fd " << cfd << " exceeds FD_SETSIZE, rejected" << std::endl;
+            close(cfd);
+            return;
+        }
+        registry.Add(cfd);
 
         std::cout << "[Info] New client fd = " << cfd << std::endl;
     }
@@ -225,33 +244,30 @@ public:
     {
         while(is_running)
         {
-            fd_set tmp;
-            int current_max_fd;
-            // 加锁拷贝共享的 read_fds 和 max_fd
-            {
-                std::unique_lock<std::mutex> lock(mtx);
-                tmp = read_fds;
-                current_max_fd = max_fd;
-            }
+            // 上一轮积累的增删在这里统一生效，fd_set和max_fd只由本线程访问，无需加锁
+            apply_changes();
+            fd_set tmp = read_fds;
 
-            int ret = select(current_max_fd + 1, &tmp, nullptr, nullptr, nullptr);
+            int ret = select(max_fd + 1, &tmp, nullptr, nullptr, nullptr);
             if(ret < 0) 
             {
                 if(errno == EINTR) continue; // 处理信号中断
                 break;
             }
 
-            // 遍历 fd 时无需锁（操作的是拷贝后的 tmp）
-            for(int fd=0;fd<=current_max_fd;fd++)
+            // 只遍历已注册的fd，而不是0..max_fd；期间的增删只是登记，不会改动正在遍历的数组
+            for(const pollfd& pfd : registry.PollFds())
             {
-                if(!FD_ISSET(fd, &tmp)) continue;
-                if(fd == server_fd)
+                if(ret == 0) break; // 就绪的fd都处理完了
+                if(!FD_ISSET(pfd.fd, &tmp)) continue;
+                ret--;
+                if(pfd.fd == server_fd)
                 {
-                    accept_client(); // 内部已加锁
+                    accept_client();
                 }
                 else
                 {
-                    handle_client_io(fd); // 内部已加锁
+                    handle_client_io(pfd.fd);
                 }
             }
         }
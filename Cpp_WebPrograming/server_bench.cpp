@@ -0,0 +1,398 @@
+// 服务器横向对比：依次启动各个回显服务器（都监听9999），用loadgen在不同连接数、消息大小下压测，
+// 同时采样服务器进程的CPU时间和常驻内存，输出markdown表格（标准输出及 <前缀>.md）和CSV（<前缀>.csv）
+// 各服务器的回复前缀不同（"Server received: " 等），每种消息大小先探测一次回复长度，再交给loadgen的echo模式计数
+// 用法: ./server_bench [-B 可执行文件目录] [-c 连接数列表] [-s 消息大小列表] [-d 每轮秒数] [-t loadgen线程数]
+//                      [-o 报告文件前缀] [服务器名...]
+// 例:   ./server_bench -c 10,1000,10000 -s 16,512 -d 5 epollserver multithread_reactor
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint16_t kServerPort = 9999;
+constexpr size_t kMaxMessage = 1000; // 各服务器一次recv最多1024字节，超过会被拆成多条回复
+constexpr int kConnsPerSource = 20000; // 单个源地址的临时端口约2.8万个，留出余量
+
+struct ServerSpec {
+    const char* name;
+    int max_conns; // select只能监听FD_SETSIZE以内的fd
+};
+
+static const ServerSpec kServers[] = {
+    {"select", FD_SETSIZE - 16},
+    {"selectthread_tp", FD_SETSIZE - 16},
+    {"pollthread_tp", 0},
+    {"epollserver", 0},
+    {"epollthread_tpet", 0},
+    {"single_reactor", 0},
+    {"reactor_server", 0},
+    {"multithread_reactor", 0},
+};
+
+struct Options {
+    std::string bin_dir = ".";
+    std::vector<int> conns{10, 100, 1000, 10000, 50000};
+    std::vector<size_t> sizes{16, 512};
+    int duration = 5;
+    int threads = 2;
+    std::string output = "server_bench";
+    std::vector<std::string> servers;
+};
+
+struct Result {
+    std::string server;
+    int conns = 0;
+    size_t size = 0;
+    std::string status = "ok";
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    double rps = 0;
+    double mbps = 0;
+    uint64_t p50 = 0, p90 = 0, p99 = 0, p999 = 0, max = 0;
+    double cpu_percent = 0;
+    long rss_kb = 0;
+};
+
+static std::vector<std::string> Split(const std::string& s, char sep)
+{
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while(std::getline(ss, part, sep)) {
+        if(!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+static sockaddr_in ServerAddr()
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kServerPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+static int Connect()
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr = ServerAddr();
+    if(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 发送size字节，收到回复后等对端静默200ms，返回回复总长度；失败返回0
+static size_t ProbeReplyLength(size_t size)
+{
+    int fd = Connect();
+    if(fd == -1) return 0;
+    std::string msg(size, 'x');
+    if(send(fd, msg.data(), msg.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(msg.size())) {
+        close(fd);
+        return 0;
+    }
+    size_t total = 0;
+    char buf[4096];
+    pollfd pfd{fd, POLLIN, 0};
+    int wait_ms = 2000; // 第一个字节最多等2秒
+    while(poll(&pfd, 1, wait_ms) > 0) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if(n <= 0) break;
+        total += n;
+        wait_ms = 200;
+    }
+    close(fd);
+    return total;
+}
+
+// /proc/<pid>/stat 中的 utime+stime，单位秒
+static double ProcessCpuSeconds(pid_t pid)
+{
+    std::ifstream in("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat;
+    std::getline(in, stat);
+    size_t pos = stat.rfind(')'); // 进程名可能含空格，从右括号之后开始按字段切分
+    if(pos == std::string::npos) return 0;
+    std::istringstream fields(stat.substr(pos + 2));
+    std::string field;
+    unsigned long long utime = 0, stime = 0;
+    for(int i = 3; fields >> field; i++) {
+        if(i == 14) utime = std::stoull(field);
+        if(i == 15) {
+            stime = std::stoull(field);
+            break;
+        }
+    }
+    return static_cast<double>(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+static long ProcessRssKb(pid_t pid)
+{
+    std::ifstream in("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while(std::getline(in, line)) {
+        if(line.compare(0, 6, "VmRSS:") == 0) return std::stol(line.substr(6));
+    }
+    return 0;
+}
+
+class ServerProcess {
+private:
+    pid_t __pid = -1;
+
+public:
+    ~ServerProcess() { Stop(); }
+
+    bool Start(const std::string& path) {
+        __pid = fork();
+        if(__pid == 0) {
+            // 服务器每条消息都会打印日志，全部丢弃，避免终端输出成为瓶颈
+            int devnull = open("/dev/null", O_RDWR);
+            dup2(devnull, STDIN_FILENO);
+            dup2(devnull, STDOUT_FILENO);
+            dup2(devnull, STDERR_FILENO);
+            execl(path.c_str(), path.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        if(__pid == -1) return false;
+        for(int i = 0; i < 60; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            if(!Alive()) return false;
+            int fd = Connect();
+            if(fd != -1) {
+                close(fd);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Alive() {
+        if(__pid <= 0) return false;
+        if(waitpid(__pid, nullptr, WNOHANG) == __pid) {
+            __pid = -1;
+            return false;
+        }
+        return true;
+    }
+
+    pid_t Pid() const { return __pid; }
+
+    // 先SIGINT让服务器优雅退出，2秒内没退出再SIGKILL
+    void Stop() {
+        if(__pid <= 0) return;
+        kill(__pid, SIGINT);
+        for(int i = 0; i < 40; i++) {
+            if(waitpid(__pid, nullptr, WNOHANG) == __pid) {
+                __pid = -1;
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        kill(__pid, SIGKILL);
+        waitpid(__pid, nullptr, 0);
+        __pid = -1;
+    }
+};
+
+// 运行一轮loadgen，期间每100ms采样一次服务器RSS取峰值
+static void RunLoad(const Options& opt, ServerProcess& server, size_t reply, Result& r)
+{
+    int sources = (r.conns + kConnsPerSource - 1) / kConnsPerSource;
+    std::string cmd = opt.bin_dir + "/loadgen -C -m echo -p " + std::to_string(kServerPort)
+                    + " -c " + std::to_string(r.conns) + " -t " + std::to_string(opt.threads)
+                    + " -d " + std::to_string(opt.duration) + " -s " + std::to_string(r.size)
+                    + " -r " + std::to_string(reply) + " -b " + std::to_string(sources);
+
+    std::atomic<bool> running{true};
+    long peak_rss = 0;
+    std::thread sampler([&]() {
+        while(running.load()) {
+            peak_rss = std::max(peak_rss, ProcessRssKb(server.Pid()));
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    });
+
+    double cpu0 = ProcessCpuSeconds(server.Pid());
+    auto start = Clock::now();
+    std::string line;
+    if(FILE* pipe = popen(cmd.c_str(), "r")) {
+        char buf[512];
+        while(fgets(buf, sizeof(buf), pipe)) line += buf;
+        pclose(pipe);
+    }
+    double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    double cpu = ProcessCpuSeconds(server.Pid()) - cpu0;
+    running.store(false);
+    sampler.join();
+
+    r.cpu_percent = wall > 0 ? cpu / wall * 100 : 0;
+    r.rss_kb = peak_rss;
+    // mode,conns,depth,size,requests,errors,rps,MB/s,p50,p90,p99,p999,max
+    std::vector<std::string> f = Split(line.substr(0, line.find('\n')), ',');
+    if(f.size() != 13) {
+        r.status = "loadgen failed";
+        return;
+    }
+    r.requests = std::stoull(f[4]);
+    r.errors = std::stoull(f[5]);
+    r.rps = std::stod(f[6]);
+    r.mbps = std::stod(f[7]);
+    r.p50 = std::stoull(f[8]);
+    r.p90 = std::stoull(f[9]);
+    r.p99 = std::stoull(f[10]);
+    r.p999 = std::stoull(f[11]);
+    r.max = std::stoull(f[12]);
+    if(!server.Alive()) r.status = "crashed";
+}
+
+static void BenchServer(const Options& opt, const ServerSpec& spec, rlim_t fd_limit, std::vector<Result>& results,
+                        std::ostream& md)
+{
+    // 每完成一轮就输出一行，同时写到标准输出和报告文件
+    auto emit = [&](const Result& r) {
+        results.push_back(r);
+        std::ostringstream row;
+        row << "| " << r.server << " | " << r.conns << " | " << r.size << " | ";
+        if(r.status != "ok") row << r.status << " | | | | | |\n";
+        else row << std::fixed << std::setprecision(0) << r.rps << " | " << r.p50 << " | " << r.p99 << " | " << r.errors
+           << " | " << std::setprecision(1) << r.cpu_percent << " | " << r.rss_kb / 1024.0 << " |\n";
+        std::cout << row.str() << std::flush;
+        md << row.str() << std::flush;
+    };
+
+    ServerProcess server;
+    bool started = server.Start(opt.bin_dir + "/" + spec.name);
+    for(size_t size : opt.sizes) {
+        size_t reply = started ? ProbeReplyLength(size) : 0;
+        for(int conns : opt.conns) {
+            Result r;
+            r.server = spec.name;
+            r.conns = conns;
+            r.size = size;
+            if(!started) r.status = "failed to start";
+            else if(!server.Alive()) r.status = "crashed";
+            else if(spec.max_conns and conns > spec.max_conns) r.status = "skipped (FD_SETSIZE)";
+            else if(static_cast<rlim_t>(conns) + 64 > fd_limit) r.status = "skipped (fd limit)";
+            else if(reply == 0) r.status = "no reply";
+            else RunLoad(opt, server, reply, r);
+            emit(r);
+            std::this_thread::sleep_for(std::chrono::milliseconds(500)); // 让上一轮的连接关闭完
+        }
+    }
+}
+
+static void Usage(const char* prog)
+{
+    std::cerr << "Usage: " << prog << " [-B bin_dir] [-c conns,...] [-s sizes,...] [-d seconds] [-t loadgen_threads]"
+              << " [-o report_prefix] [server...]\nservers:";
+    for(const ServerSpec& spec : kServers) std::cerr << " " << spec.name;
+    std::cerr << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    signal(SIGPIPE, SIG_IGN);
+    Options opt;
+    std::string self = argv[0];
+    if(self.find('/') != std::string::npos) opt.bin_dir = self.substr(0, self.rfind('/'));
+    int ch;
+    while((ch = getopt(argc, argv, "B:c:s:d:t:o:h")) != -1) {
+        switch(ch) {
+            case 'B': opt.bin_dir = optarg; break;
+            case 'c': {
+                opt.conns.clear();
+                for(const std::string& c : Split(optarg, ',')) opt.conns.push_back(std::max(1, std::stoi(c)));
+                break;
+            }
+            case 's': {
+                opt.sizes.clear();
+                for(const std::string& s : Split(optarg, ',')) opt.sizes.push_back(std::stoul(s));
+                break;
+            }
+            case 'd': opt.duration = std::max(1, std::stoi(optarg)); break;
+            case 't': opt.threads = std::max(1, std::stoi(optarg)); break;
+            case 'o': opt.output = optarg; break;
+            default: Usage(argv[0]); return 1;
+        }
+    }
+    for(int i = optind; i < argc; i++) opt.servers.push_back(argv[i]);
+    for(size_t size : opt.sizes) {
+        if(size == 0 or size > kMaxMessage) {
+            std::cerr << "message size must be in 1.." << kMaxMessage << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<ServerSpec> selected;
+    for(const ServerSpec& spec : kServers) {
+        bool wanted = opt.servers.empty();
+        for(const std::string& name : opt.servers) wanted = wanted or name == spec.name;
+        if(wanted) selected.push_back(spec);
+    }
+    if(selected.size() != (opt.servers.empty() ? std::size(kServers) : opt.servers.size())) {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    // 同一端口上已有服务器时（都设置了SO_REUSEPORT，新进程也能绑定成功）压测结果会混在一起
+    int stale = Connect();
+    if(stale != -1) {
+        close(stale);
+        std::cerr << "port " << kServerPort << " is already in use, stop the running server first" << std::endl;
+        return 1;
+    }
+
+    // 提高fd上限，子进程（服务器与loadgen）继承
+    rlimit lim{};
+    getrlimit(RLIMIT_NOFILE, &lim);
+    lim.rlim_cur = lim.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &lim);
+
+    std::ofstream md_file(opt.output + ".md");
+    std::ostringstream header;
+    header << "# Echo server comparison\n\n"
+           << opt.duration << "s per run, " << opt.threads << " loadgen threads, " << std::thread::hardware_concurrency()
+           << " CPUs, fd limit " << lim.rlim_cur << "\n\n"
+           << "| server | conns | msg bytes | req/s | p50 us | p99 us | errors | server CPU % | peak RSS MB |\n"
+           << "|---|---:|---:|---:|---:|---:|---:|---:|---:|\n";
+    std::cout << header.str() << std::flush;
+    md_file << header.str() << std::flush;
+
+    std::vector<Result> results;
+    for(const ServerSpec& spec : selected) BenchServer(opt, spec, lim.rlim_cur, results, md_file);
+
+    std::ofstream csv(opt.output + ".csv");
+    csv << "server,conns,size,status,requests,errors,rps,mbps,p50_us,p90_us,p99_us,p999_us,max_us,cpu_percent,rss_kb\n";
+    for(const Result& r : results) {
+        csv << r.server << "," << r.conns << "," << r.size << "," << r.status << "," << r.requests << "," << r.errors
+            << "," << std::fixed << std::setprecision(1) << r.rps << "," << std::setprecision(2) << r.mbps << ","
+            << r.p50 << "," << r.p90 << "," << r.p99 << "," << r.p999 << "," << r.max << "," << std::setprecision(1)
+            << r.cpu_percent << "," << r.rss_kb << "\n";
+    }
+    std::cout << "\nReport written to " << opt.output << ".md and " << opt.output << ".csv" << std::endl;
+    return 0;
+}
@@ -0,0 +1,281 @@
+// 共享内存环形队列：memfd + mmap(MAP_SHARED)，fork之后父子进程共用同一块映射；
+// exec之后的进程（如prefork的worker）可以凭继承下来的fd重新 Attach。
+// RingMode::kSPSC：单生产者单消费者，读写位置各占一个缓存行，各自缓存对方位置，无CAS
+// RingMode::kMPSC：多生产者单消费者（Vyukov有界队列），每个槽位带序号，生产者CAS抢占写位置
+// 阻塞等待用futex（非PRIVATE，跨进程有效）：先短暂自旋，仍为空/满时睡眠；
+// 对端只在有人等待时才调用FUTEX_WAKE，常态下收发都不进入内核
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+inline long FutexWait(std::atomic<uint32_t>* addr, uint32_t expected, const timespec* timeout)
+{
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+inline long FutexWake(std::atomic<uint32_t>* addr, int count)
+{
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+enum class RingMode { kSPSC, kMPSC };
+
+template <typename T, RingMode Mode = RingMode::kSPSC>
+class ShmRing {
+    static_assert(std::is_trivially_copyable_v<T>, "ShmRing element must be trivially copyable");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free and std::atomic<uint32_t>::is_always_lock_free,
+                  "cross-process atomics must be lock free");
+    using Clock = std::chrono::steady_clock;
+private:
+    static constexpr uint64_t kMagic = 0x53484d52494e4731ull; // "SHMRING1"
+    static constexpr int kSpin = 200; // 单核机器上自旋只会推迟对端运行，不自旋
+
+    // 等待方登记 waiters 后再检查一次队列，通知方写入数据后检查 waiters：两边之间各有一个全屏障，
+    // 所以要么等待方看到数据，要么通知方看到等待方，不会丢失唤醒。
+    // 通知方还会检查对方是否正等在自己刚改变的位置上，避免对端睡眠期间每次操作都陷入内核
+    struct Event {
+        std::atomic<uint32_t> seq{0};
+        std::atomic<uint32_t> waiters{0};
+    };
+
+    struct Control {
+        uint64_t magic;
+        uint64_t capacity;
+        uint64_t elem_size;
+        alignas(64) std::atomic<uint64_t> tail{0}; // 写位置
+        alignas(64) std::atomic<uint64_t> head{0}; // 读位置
+        alignas(64) Event not_empty;
+        alignas(64) Event not_full;
+    };
+
+    struct MpscSlot {
+        std::atomic<uint64_t> seq;
+        T value;
+    };
+    using Slot = std::conditional_t<Mode == RingMode::kMPSC, MpscSlot, T>;
+
+    int __fd = -1;
+    size_t __map_size = 0;
+    Control* __ctl = nullptr;
+    Slot* __slots = nullptr;
+    uint64_t __mask = 0;
+    // 仅SPSC：本进程缓存的对端位置，减少对共享缓存行的读取
+    uint64_t __cached_head = 0;
+    uint64_t __cached_tail = 0;
+
+    static size_t MapSize(uint64_t capacity) { return sizeof(Control) + sizeof(Slot) * capacity; }
+
+    void Map(int fd, size_t size) {
+        void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(addr == MAP_FAILED) throw std::runtime_error(std::string("ShmRing mmap failed: ") + strerror(errno));
+        __fd = fd;
+        __map_size = size;
+        __ctl = static_cast<Control*>(addr);
+        __slots = reinterpret_cast<Slot*>(static_cast<char*>(addr) + sizeof(Control));
+    }
+
+    void Release() {
+        if(__ctl) munmap(__ctl, __map_size);
+        if(__fd != -1) close(__fd);
+        __ctl = nullptr;
+        __fd = -1;
+    }
+
+    static void Wake(Event& ev, int count) {
+        ev.seq.fetch_add(1, std::memory_order_release);
+        FutexWake(&ev.seq, count);
+    }
+
+    // 自旋后睡眠，直到try_op成功或超时
+    template <typename TryOp>
+    static bool Wait(Event& ev, TryOp try_op, Clock::time_point deadline) {
+        static const int spin = std::thread::hardware_concurrency() > 1 ? kSpin : 0;
+        for(int i = 0; i < spin; i++) {
+            if(try_op()) return true;
+            CpuRelax();
+        }
+        while(true) {
+            uint32_t seq = ev.seq.load(std::memory_order_acquire);
+            ev.waiters.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(try_op()) {
+                ev.waiters.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            timespec ts{}, *timeout = nullptr;
+            if(deadline != Clock::time_point::max()) {
+                auto left = deadline - Clock::now();
+                if(left <= Clock::duration::zero()) {
+                    ev.waiters.fetch_sub(1, std::memory_order_relaxed);
+                    return false;
+                }
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+                ts.tv_sec = ns / 1000000000;
+                ts.tv_nsec = ns % 1000000000;
+                timeout = &ts;
+            }
+            FutexWait(&ev.seq, seq, timeout);
+            ev.waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    ShmRing() = default;
+
+public:
+    // 容量向上取整为2的幂
+    static ShmRing Create(size_t capacity, const char* name = "shmring") {
+        uint64_t cap = 1;
+        while(cap < capacity) cap <<= 1;
+        int fd = memfd_create(name, MFD_CLOEXEC);
+        if(fd == -1) throw std::runtime_error(std::string("memfd_create failed: ") + strerror(errno));
+        size_t size = MapSize(cap);
+        if(ftruncate(fd, size) == -1) {
+            close(fd);
+            throw std::runtime_error(std::string("ftruncate failed: ") + strerror(errno));
+        }
+        ShmRing ring;
+        ring.Map(fd, size);
+        // 新映射的页已清零，只需初始化控制块与MPSC槽位序号
+        new (ring.__ctl) Control();
+        ring.__ctl->capacity = cap;
+        ring.__ctl->elem_size = sizeof(T);
+        if constexpr (Mode == RingMode::kMPSC) {
+            for(uint64_t i = 0; i < cap; i++) ring.__slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+        ring.__mask = cap - 1;
+        std::atomic_thread_fence(std::memory_order_release);
+        ring.__ctl->magic = kMagic;
+        return ring;
+    }
+
+    // exec之后的进程凭继承的fd映射同一队列（需先清除fd的CLOEXEC标志再exec）
+    static ShmRing Attach(int fd) {
+        uint64_t header[3]; // magic, capacity, elem_size
+        if(pread(fd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+           or header[0] != kMagic or header[2] != sizeof(T))
+            throw std::runtime_error("ShmRing attach: bad shared memory header");
+        ShmRing ring;
+        ring.Map(fd, MapSize(header[1]));
+        ring.__mask = header[1] - 1;
+        return ring;
+    }
+
+    ShmRing(ShmRing&& other) noexcept { *this = std::move(other); }
+    ShmRing& operator=(ShmRing&& other) noexcept {
+        if(this != &other) {
+            Release();
+            __fd = std::exchange(other.__fd, -1);
+            __map_size = other.__map_size;
+            __ctl = std::exchange(other.__ctl, nullptr);
+            __slots = other.__slots;
+            __mask = other.__mask;
+            __cached_head = other.__cached_head;
+            __cached_tail = other.__cached_tail;
+        }
+        return *this;
+    }
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+    ~ShmRing() noexcept { Release(); }
+
+    int fd() const { return __fd; }
+    size_t capacity() const { return __mask + 1; }
+    size_t SizeApprox() const {
+        return __ctl->tail.load(std::memory_order_relaxed) - __ctl->head.load(std::memory_order_relaxed);
+    }
+
+    bool TryPush(const T& value) {
+        uint64_t pos = __ctl->tail.load(std::memory_order_relaxed);
+        if constexpr (Mode == RingMode::kSPSC) {
+            if(pos - __cached_head > __mask) {
+                __cached_head = __ctl->head.load(std::memory_order_acquire);
+                if(pos - __cached_head > __mask) return false;
+            }
+            __slots[pos & __mask] = value;
+            __ctl->tail.store(pos + 1, std::memory_order_release);
+        } else {
+            MpscSlot* slot;
+            while(true) {
+                slot = &__slots[pos & __mask];
+                uint64_t seq = slot->seq.load(std::memory_order_acquire);
+                int64_t diff = static_cast<int64_t>(seq - pos);
+                if(diff == 0) {
+                    if(__ctl->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if(diff < 0) {
+                    return false; // 满
+                } else {
+                    pos = __ctl->tail.load(std::memory_order_relaxed);
+                }
+            }
+            slot->value = value;
+            slot->seq.store(pos + 1, std::memory_order_release);
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // 消费者只会等待head处的槽位：刚发布的正是它时才需要唤醒
+        if(__ctl->not_empty.waiters.load(std::memory_order_relaxed) and __ctl->head.load(std::memory_order_relaxed) == pos)
+            Wake(__ctl->not_empty, 1);
+        return true;
+    }
+
+    bool TryPop(T& out) {
+        uint64_t head = __ctl->head.load(std::memory_order_relaxed);
+        if constexpr (Mode == RingMode::kSPSC) {
+            if(head == __cached_tail) {
+                __cached_tail = __ctl->tail.load(std::memory_order_acquire);
+                if(head == __cached_tail) return false;
+            }
+            out = __slots[head & __mask];
+        } else {
+            MpscSlot& slot = __slots[head & __mask];
+            if(slot.seq.load(std::memory_order_acquire) != head + 1) return false;
+            out = slot.value;
+            slot.seq.store(head + __mask + 1, std::memory_order_release);
+        }
+        __ctl->head.store(head + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // 生产者只在队列满时等待：弹出前队列是满的才需要唤醒
+        if(__ctl->not_full.waiters.load(std::memory_order_relaxed) and __ctl->tail.load(std::memory_order_relaxed) - head > __mask)
+            Wake(__ctl->not_full, INT_MAX);
+        return true;
+    }
+
+    // 阻塞版本：队列满/空时先自旋再futex睡眠
+    void Push(const T& value) {
+        Wait(__ctl->not_full, [&]() { return TryPush(value); }, Clock::time_point::max());
+    }
+    void Pop(T& out) {
+        Wait(__ctl->not_empty, [&]() { return TryPop(out); }, Clock::time_point::max());
+    }
+    bool PopFor(T& out, std::chrono::nanoseconds timeout) {
+        return Wait(__ctl->not_empty, [&]() { return TryPop(out); }, Clock::now() + timeout);
+    }
+};
+
+#endif // SHMRING_H
@@ -0,0 +1,204 @@
+// 共享内存环形队列 vs Unix域socket：父子进程（fork）间传递64字节消息
+// 吞吐：子进程连续发送N条，父进程接收，统计 msgs/s（MPSC为4个子进程同时发送）
+// 延迟：父进程发出一条，子进程原样回送，统计往返时间分位数
+// 用法: ./shmring_bench [消息数，默认2000000]
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "shmring.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Message {
+    uint64_t seq;
+    char payload[56];
+};
+
+static constexpr int kProducers = 4;
+
+static void PrintRow(const std::string& name, double msgs_per_sec, const std::vector<double>& rtt_us = {})
+{
+    std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(14) << msgs_per_sec;
+    if(!rtt_us.empty()) {
+        auto pct = [&rtt_us](double p) { return rtt_us[static_cast<size_t>(p / 100 * (rtt_us.size() - 1))]; };
+        std::cout << std::setprecision(2) << std::setw(10) << pct(50) << std::setw(10) << pct(99) << std::setw(10) << pct(99.9);
+    }
+    std::cout << std::endl;
+}
+
+template <typename Child>
+static pid_t ForkChild(Child child)
+{
+    pid_t pid = fork();
+    if(pid == 0) {
+        child();
+        _exit(0);
+    }
+    return pid;
+}
+
+template <RingMode Mode>
+static double RingThroughput(uint64_t count, int producers)
+{
+    auto ring = ShmRing<Message, Mode>::Create(4096);
+    uint64_t per = count / producers;
+    auto start = Clock::now();
+    std::vector<pid_t> children;
+    for(int p = 0; p < producers; p++) {
+        children.push_back(ForkChild([&ring, per, p]() {
+            Message msg{};
+            for(uint64_t i = 0; i < per; i++) {
+                msg.seq = (static_cast<uint64_t>(p) << 56) | i;
+                ring.Push(msg);
+            }
+        }));
+    }
+    Message msg;
+    uint64_t total = per * producers;
+    std::vector<uint64_t> expect(producers, 0);
+    for(uint64_t i = 0; i < total; i++) {
+        ring.Pop(msg);
+        // 每个生产者的消息必须按序到达
+        uint64_t p = msg.seq >> 56, seq = msg.seq & ((1ull << 56) - 1);
+        if(seq != expect[p]++) {
+            std::cerr << "[Error] out of order message from producer " << p << std::endl;
+            break;
+        }
+    }
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    for(pid_t pid : children) waitpid(pid, nullptr, 0);
+    return total / secs;
+}
+
+static std::vector<double> RingLatency(int rounds)
+{
+    auto request = ShmRing<Message>::Create(64);
+    auto response = ShmRing<Message>::Create(64);
+    pid_t child = ForkChild([&request, &response, rounds]() {
+        Message msg;
+        for(int i = 0; i < rounds; i++) {
+            request.Pop(msg);
+            response.Push(msg);
+        }
+    });
+    std::vector<double> rtt;
+    rtt.reserve(rounds);
+    Message msg{};
+    for(int i = 0; i < rounds; i++) {
+        auto t0 = Clock::now();
+        msg.seq = i;
+        request.Push(msg);
+        response.Pop(msg);
+        rtt.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+    }
+    waitpid(child, nullptr, 0);
+    std::sort(rtt.begin(), rtt.end());
+    return rtt;
+}
+
+static bool WriteAll(int fd, const void* data, size_t len)
+{
+    const char* p = static_cast<const char*>(data);
+    while(len > 0) {
+        ssize_t n = write(fd, p, len);
+        if(n <= 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool ReadAll(int fd, void* data, size_t len)
+{
+    char* p = static_cast<char*>(data);
+    while(len > 0) {
+        ssize_t n = read(fd, p, len);
+        if(n <= 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+// 每条消息一次write/read，与队列的逐条Push/Pop对应
+static double SocketThroughput(uint64_t count)
+{
+    int sv[2];
+    socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv);
+    auto start = Clock::now();
+    pid_t child = ForkChild([&sv, count]() {
+        close(sv[0]);
+        Message msg{};
+        for(uint64_t i = 0; i < count; i++) {
+            msg.seq = i;
+            if(!WriteAll(sv[1], &msg, sizeof(msg))) break;
+        }
+    });
+    close(sv[1]);
+    Message msg;
+    uint64_t got = 0;
+    while(got < count and ReadAll(sv[0], &msg, sizeof(msg))) got++;
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    close(sv[0]);
+    waitpid(child, nullptr, 0);
+    return got / secs;
+}
+
+static std::vector<double> SocketLatency(int rounds)
+{
+    int sv[2];
+    socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv);
+    pid_t child = ForkChild([&sv, rounds]() {
+        close(sv[0]);
+        Message msg;
+        for(int i = 0; i < rounds; i++) {
+            if(!ReadAll(sv[1], &msg, sizeof(msg)) or !WriteAll(sv[1], &msg, sizeof(msg))) break;
+        }
+    });
+    close(sv[1]);
+    std::vector<double> rtt;
+    rtt.reserve(rounds);
+    Message msg{};
+    for(int i = 0; i < rounds; i++) {
+        auto t0 = Clock::now();
+        msg.seq = i;
+        if(!WriteAll(sv[0], &msg, sizeof(msg)) or !ReadAll(sv[0], &msg, sizeof(msg))) break;
+        rtt.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+    }
+    close(sv[0]);
+    waitpid(child, nullptr, 0);
+    std::sort(rtt.begin(), rtt.end());
+    return rtt;
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t count = argc > 1 ? std::stoull(argv[1]) : 2000000;
+    int rounds = static_cast<int>(std::min<uint64_t>(count / 20, 200000));
+
+    std::cout << "messages: " << count << " x " << sizeof(Message) << "B, ping-pong rounds: " << rounds << "\n\n"
+              << std::left << std::setw(26) << "transport" << std::right << std::setw(14) << "msgs/s"
+              << std::setw(10) << "rtt p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << "  (us)" << std::endl;
+
+    PrintRow("shm ring SPSC", RingThroughput<RingMode::kSPSC>(count, 1));
+    PrintRow("shm ring MPSC x" + std::to_string(kProducers), RingThroughput<RingMode::kMPSC>(count, kProducers));
+    PrintRow("unix socket", SocketThroughput(count));
+
+    auto start = Clock::now();
+    std::vector<double> ring_rtt = RingLatency(rounds);
+    PrintRow("shm ring ping-pong", rounds / std::chrono::duration<double>(Clock::now() - start).count(), ring_rtt);
+    start = Clock::now();
+    std::vector<double> sock_rtt = SocketLatency(rounds);
+    PrintRow("unix socket ping-pong", rounds / std::chrono::duration<double>(Clock::now() - start).count(), sock_rtt);
+    return 0;
+}
@@ -1,6 +1,9 @@
 // Basic ThreadPool
 // Write By @OxyTheCrack 2025.12.15
 
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
 #include <iostream>
 #include <mutex>
 #include <vector>
@@ -95,4 +98,21 @@ public:
         }
         cv.notify_one();
     } 
-};
\ No newline at end of file
+
+    // 丢弃还在队列里没开始执行的任务，返回丢弃的个数；正在执行的任务不受影响
+    size_t discard_pending()
+    {
+        std::queue<std::function<void()>> dropped;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            dropped.swap(task_queue);
+            if(dropped.empty()) return 0;
+            task_count.fetch_sub(static_cast<int>(dropped.size()));
+        }
+        std::unique_lock<std::mutex> endlock(end_mtx);
+        end_cv.notify_all();
+        return dropped.size();
+    }
+};
+
+#endif // THREADPOOL_H
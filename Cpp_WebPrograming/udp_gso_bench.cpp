@@ -0,0 +1,188 @@
+// UDP大块发送基准（回环）：同样的数据按固定段长切成数据报，比较
+//   sendto    每个数据报一次sendto / recvfrom
+//   mmsg      sendmmsg / recvmmsg 批量（GSO/GRO不可用时的回退路径）
+//   gso       UDP_SEGMENT 发送 + recvmmsg 接收
+//   gso+gro   UDP_SEGMENT 发送 + UDP_GRO 接收
+// 统计发送/接收的数据报速率、丢包率（接收缓冲溢出），以及收发两端各自每GB数据消耗的CPU时间
+// 用法: ./udp_gso_bench [每种模式发送的MB数，默认256] [段长，默认1024]
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "udp_offload.h"
+
+using Clock = std::chrono::steady_clock;
+
+enum class Mode { kSendto, kMmsg, kGso, kGsoGro };
+
+static const char* ModeName(Mode mode)
+{
+    switch(mode) {
+        case Mode::kSendto: return "sendto";
+        case Mode::kMmsg: return "mmsg";
+        case Mode::kGso: return "gso";
+        case Mode::kGsoGro: return "gso+gro";
+    }
+    return "";
+}
+
+static double ThreadCpuSeconds()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct Side {
+    uint64_t datagrams = 0;
+    uint64_t bytes = 0;
+    uint64_t syscalls = 0;
+    double seconds = 0;
+    double cpu = 0;
+    bool offload = false; // 该方向是否真的用上了GSO/GRO
+};
+
+static void Receive(int fd, Mode mode, size_t seg_size, const std::atomic<bool>& sender_done, Side& out)
+{
+    double cpu0 = ThreadCpuSeconds();
+    Clock::time_point first{}, last{};
+    auto count = [&](size_t len) {
+        if(out.datagrams == 0) first = Clock::now();
+        out.datagrams++;
+        out.bytes += len;
+    };
+    if(mode == Mode::kSendto) {
+        std::vector<char> buf(seg_size + 1);
+        while(true) {
+            out.syscalls++;
+            ssize_t n = recv(fd, buf.data(), buf.size(), 0);
+            if(n >= 0) {
+                count(n);
+                last = Clock::now();
+            } else if(errno != EINTR and sender_done.load()) {
+                break; // 接收超时且发送端已结束
+            }
+        }
+    } else {
+        UdpBatchReceiver receiver(fd, mode == Mode::kGsoGro, seg_size + 1);
+        out.offload = receiver.GroEnabled();
+        while(true) {
+            int n = receiver.Receive([&](const sockaddr_in&, const char*, size_t len) { count(len); }, MSG_WAITFORONE);
+            if(n > 0) last = Clock::now();
+            else if(sender_done.load()) break;
+        }
+        out.syscalls = receiver.Syscalls();
+    }
+    out.cpu = ThreadCpuSeconds() - cpu0;
+    out.seconds = std::chrono::duration<double>(last - first).count();
+}
+
+static void Send(int fd, const sockaddr_in& to, Mode mode, size_t total, size_t seg_size, Side& out)
+{
+    // 每次交给发送路径的一块数据：GSO单次上限附近，回退路径同样按这个粒度批量
+    std::string block(std::min(kUdpMaxSegments, kUdpMaxPayload / seg_size) * seg_size, 'x');
+    double cpu0 = ThreadCpuSeconds();
+    auto start = Clock::now();
+    if(mode == Mode::kSendto) {
+        for(size_t off = 0; off < total; off += seg_size) {
+            out.syscalls++;
+            if(sendto(fd, block.data(), seg_size, 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to)) < 0) {
+                if(errno == EINTR) continue;
+                throw std::runtime_error(std::string("sendto failed: ") + strerror(errno));
+            }
+            out.datagrams++;
+            out.bytes += seg_size;
+        }
+    } else {
+        UdpBulkSender sender(fd, mode != Mode::kMmsg);
+        out.offload = sender.GsoEnabled();
+        for(size_t off = 0; off < total; off += block.size()) {
+            ssize_t n = sender.Send(to, block.data(), block.size(), seg_size);
+            if(n < 0) throw std::runtime_error(std::string("send failed: ") + strerror(errno));
+            out.datagrams += n;
+            out.bytes += block.size();
+        }
+        out.offload = sender.GsoEnabled(); // 发送中遇到EIO会关闭GSO
+        out.syscalls = sender.Syscalls();
+    }
+    out.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    out.cpu = ThreadCpuSeconds() - cpu0;
+}
+
+static void RunMode(Mode mode, size_t total, size_t seg_size)
+{
+    int rfd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    int sfd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if(rfd == -1 or sfd == -1) throw std::runtime_error(std::string("socket failed: ") + strerror(errno));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(bind(rfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1)
+        throw std::runtime_error(std::string("bind failed: ") + strerror(errno));
+    socklen_t len = sizeof(addr);
+    getsockname(rfd, reinterpret_cast<sockaddr*>(&addr), &len);
+    // 尽量放大接收缓冲（FORCE需要CAP_NET_ADMIN，否则受rmem_max限制）
+    int rcvbuf = 32 * 1024 * 1024;
+    if(setsockopt(rfd, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf)) == -1)
+        setsockopt(rfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    timeval tv{0, 200 * 1000};
+    setsockopt(rfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    Side tx, rx;
+    std::atomic<bool> done{false};
+    std::thread receiver([&]() { Receive(rfd, mode, seg_size, done, rx); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // 等接收端完成GRO设置
+    try {
+        Send(sfd, addr, mode, total, seg_size, tx);
+    } catch(...) {
+        done.store(true);
+        receiver.join();
+        close(rfd);
+        close(sfd);
+        throw;
+    }
+    done.store(true);
+    receiver.join();
+    close(rfd);
+    close(sfd);
+
+    double gb = tx.bytes / 1e9;
+    auto rate = [](const Side& s) { return s.seconds > 0 ? s.datagrams / s.seconds : 0.0; };
+    std::string name = ModeName(mode);
+    if((mode == Mode::kGso or mode == Mode::kGsoGro) and !tx.offload) name += "(fallback)";
+    if(mode == Mode::kGsoGro and !rx.offload) name += "(no gro)";
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << rate(tx) << std::setw(12) << rate(rx) << std::setprecision(2) << std::setw(8)
+              << 100.0 * (tx.datagrams - std::min(tx.datagrams, rx.datagrams)) / std::max<uint64_t>(tx.datagrams, 1)
+              << std::setw(10) << tx.cpu / gb << std::setw(10) << rx.cpu / gb << std::setprecision(0) << std::setw(12)
+              << tx.syscalls / gb / 1000 << std::setw(12) << rx.syscalls / gb / 1000 << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t total = (argc > 1 ? std::stoul(argv[1]) : 256) * 1024 * 1024;
+    size_t seg_size = argc > 2 ? std::stoul(argv[2]) : 1024;
+    if(seg_size == 0 or seg_size > 8192) {
+        std::cerr << "segment size must be in 1..8192" << std::endl;
+        return 1;
+    }
+
+    std::cout << "UDP loopback bulk send, " << total / (1024 * 1024) << "MB per mode, " << seg_size << "B datagrams\n\n"
+              << std::left << std::setw(18) << "mode" << std::right << std::setw(12) << "tx dgram/s" << std::setw(12)
+              << "rx dgram/s" << std::setw(8) << "loss%" << std::setw(10) << "tx s/GB" << std::setw(10) << "rx s/GB"
+              << std::setw(12) << "tx k-sc/GB" << std::setw(12) << "rx k-sc/GB" << std::endl;
+    try {
+        for(Mode mode : {Mode::kSendto, Mode::kMmsg, Mode::kGso, Mode::kGsoGro}) RunMode(mode, total, seg_size);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "\ns/GB: CPU seconds per GB sent on that side; k-sc/GB: thousands of syscalls per GB" << std::endl;
+    return 0;
+}
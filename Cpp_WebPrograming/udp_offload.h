@@ -0,0 +1,215 @@
+// UDP分段卸载：大块数据按固定大小切成很多数据报收发时，把每个数据报一次系统调用变成每64个左右一次
+// - 发送：UDP_SEGMENT（GSO，Linux 4.18+）一次sendmsg交给内核最多64段，由内核（或网卡）切成数据报；
+//   内核不支持或发送返回EIO（出口设备不支持校验和卸载）时，回退到sendmmsg，每次系统调用仍可发出多个数据报；
+//   段长超过路径MTU时GSO返回EINVAL（较新的内核为EMSGSIZE，GSO不做IP分片），这一批改用sendmmsg发送，由IP层分片
+// - 接收：UDP_GRO（Linux 5.0+）让内核把同一流的连续数据报合并成一次交付，控制消息里带着原始段长，由这里切回数据报；
+//   不支持时回退到recvmmsg批量接收
+// 两个方向都保持数据报语义，调用者看不出是否启用了卸载
+
+#ifndef UDP_OFFLOAD_H
+#define UDP_OFFLOAD_H
+
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+constexpr size_t kUdpMaxSegments = 64;        // 内核 UDP_MAX_SEGMENTS
+constexpr size_t kUdpMaxPayload = 65507;      // 单个UDP数据报（含GSO合并前的总长）的上限
+constexpr size_t kUdpGroBufferSize = 65536;   // GRO合并后的一次交付不会超过64KB
+
+// setsockopt本身就是探测：老内核返回ENOPROTOOPT
+inline bool UdpEnableGro(int fd)
+{
+    int one = 1;
+    return setsockopt(fd, SOL_UDP, UDP_GRO, &one, sizeof(one)) == 0;
+}
+
+inline bool UdpGsoAvailable(int fd)
+{
+    int zero = 0; // 0 表示不设默认段长，每次发送用控制消息指定
+    return setsockopt(fd, SOL_UDP, UDP_SEGMENT, &zero, sizeof(zero)) == 0;
+}
+
+class UdpBulkSender {
+private:
+    int __fd;
+    bool __gso;
+    std::vector<mmsghdr> __msgs;
+    std::vector<iovec> __iovs;
+    std::atomic<uint64_t> __syscalls{0};
+
+    // 一次sendmsg发出 [data, data+len)，内核按seg_size切段；返回发出的字节数
+    ssize_t SendGso(const sockaddr_in& addr, const char* data, size_t len, size_t seg_size) {
+        iovec iov{const_cast<char*>(data), len};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+        msghdr msg{};
+        msg.msg_name = const_cast<sockaddr_in*>(&addr);
+        msg.msg_namelen = sizeof(addr);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if(len > seg_size) { // 只有一段时不带控制消息，与普通发送一致
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+            cm->cmsg_level = SOL_UDP;
+            cm->cmsg_type = UDP_SEGMENT;
+            cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            uint16_t gso_size = static_cast<uint16_t>(seg_size);
+            memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+        }
+        __syscalls.fetch_add(1, std::memory_order_relaxed);
+        return sendmsg(__fd, &msg, 0);
+    }
+
+    // 回退路径：每段一个mmsghdr，一次sendmmsg最多kUdpMaxSegments个；返回发出的字节数
+    ssize_t SendBatch(const sockaddr_in& addr, const char* data, size_t len, size_t seg_size) {
+        size_t count = 0;
+        for(size_t off = 0; off < len and count < kUdpMaxSegments; off += seg_size, count++) {
+            __iovs[count] = iovec{const_cast<char*>(data + off), std::min(seg_size, len - off)};
+            __msgs[count] = mmsghdr{};
+            __msgs[count].msg_hdr.msg_name = const_cast<sockaddr_in*>(&addr);
+            __msgs[count].msg_hdr.msg_namelen = sizeof(addr);
+            __msgs[count].msg_hdr.msg_iov = &__iovs[count];
+            __msgs[count].msg_hdr.msg_iovlen = 1;
+        }
+        __syscalls.fetch_add(1, std::memory_order_relaxed);
+        int n = sendmmsg(__fd, __msgs.data(), count, 0);
+        if(n <= 0) return n;
+        size_t bytes = 0;
+        for(int i = 0; i < n; i++) bytes += __iovs[i].iov_len;
+        return static_cast<ssize_t>(bytes);
+    }
+
+public:
+    explicit UdpBulkSender(int fd, bool try_gso = true) :
+        __fd(fd), __gso(try_gso and UdpGsoAvailable(fd)), __msgs(kUdpMaxSegments), __iovs(kUdpMaxSegments) {}
+
+    bool GsoEnabled() const { return __gso; }
+    uint64_t Syscalls() const { return __syscalls.load(std::memory_order_relaxed); }
+
+    // 把 [data, data+len) 按seg_size切成数据报发往addr，最后一段可以短于seg_size
+    // 返回发出的数据报数；阻塞socket上全部发完才返回，非阻塞socket遇到EAGAIN时返回已发出的部分；
+    // 一个都没发出就出错时返回-1（errno保留）
+    ssize_t Send(const sockaddr_in& addr, const char* data, size_t len, size_t seg_size) {
+        if(seg_size == 0 or seg_size > kUdpMaxPayload) {
+            errno = EINVAL;
+            return -1;
+        }
+        // 每次GSO发送的总长受段数和UDP长度字段两方面限制
+        size_t chunk = std::min(kUdpMaxSegments, kUdpMaxPayload / seg_size) * seg_size;
+        size_t off = 0;
+        ssize_t datagrams = 0;
+        while(off < len) {
+            size_t n = std::min(chunk, len - off);
+            ssize_t sent = __gso ? SendGso(addr, data + off, n, seg_size) : SendBatch(addr, data + off, n, seg_size);
+            if(sent < 0 and __gso and (errno == EINVAL or errno == EMSGSIZE) and n > seg_size) {
+                sent = SendBatch(addr, data + off, n, seg_size); // 段长超过路径MTU：只有这一批回退，换小段长后仍可GSO
+            }
+            if(sent < 0) {
+                if(errno == EINTR) continue;
+                if(__gso and errno == EIO) { // 出口设备不支持分段卸载：此后一直走回退路径
+                    __gso = false;
+                    continue;
+                }
+                return datagrams > 0 ? datagrams : -1;
+            }
+            off += sent;
+            datagrams += (sent + seg_size - 1) / seg_size;
+        }
+        return datagrams;
+    }
+};
+
+class UdpBatchReceiver {
+private:
+    int __fd;
+    bool __gro;
+    size_t __slot_size;
+    std::vector<char> __buf;
+    std::vector<mmsghdr> __msgs;
+    std::vector<iovec> __iovs;
+    std::vector<sockaddr_in> __addrs;
+    std::vector<char> __control;
+    std::atomic<uint64_t> __syscalls{0};
+
+    static constexpr size_t kControlSize = CMSG_SPACE(sizeof(int));
+
+public:
+    // 不启用GRO时每个槽收一个数据报（max_datagram字节）；启用后每个槽要容纳合并后的整块（64KB），槽数相应减少
+    explicit UdpBatchReceiver(int fd, bool try_gro = true, size_t max_datagram = 2048, size_t batch = 64) :
+        __fd(fd), __gro(try_gro and UdpEnableGro(fd)) {
+            __slot_size = __gro ? kUdpGroBufferSize : max_datagram;
+            size_t slots = __gro ? std::max<size_t>(1, batch / 8) : batch;
+            __buf.resize(slots * __slot_size);
+            __msgs.resize(slots);
+            __iovs.resize(slots);
+            __addrs.resize(slots);
+            __control.resize(slots * kControlSize);
+        }
+
+    bool GroEnabled() const { return __gro; }
+    uint64_t Syscalls() const { return __syscalls.load(std::memory_order_relaxed); }
+
+    // 收取一批，对每个原始数据报调用 fn(const sockaddr_in&, const char*, size_t)
+    // 返回数据报数；非阻塞socket上暂无数据返回0；出错返回-1
+    // flags 透传给recvmmsg，阻塞socket上常用 MSG_WAITFORONE（收到第一个后不再等待凑满一批）
+    template<typename F>
+    int Receive(F&& fn, int flags = 0) {
+        for(size_t i = 0; i < __msgs.size(); i++) {
+            __iovs[i] = iovec{__buf.data() + i * __slot_size, __slot_size};
+            __msgs[i] = mmsghdr{};
+            __msgs[i].msg_hdr.msg_name = &__addrs[i];
+            __msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            __msgs[i].msg_hdr.msg_iov = &__iovs[i];
+            __msgs[i].msg_hdr.msg_iovlen = 1;
+            if(__gro) {
+                __msgs[i].msg_hdr.msg_control = __control.data() + i * kControlSize;
+                __msgs[i].msg_hdr.msg_controllen = kControlSize;
+            }
+        }
+        int n;
+        do {
+            __syscalls.fetch_add(1, std::memory_order_relaxed);
+            n = recvmmsg(__fd, __msgs.data(), __msgs.size(), flags, nullptr);
+        } while(n < 0 and errno == EINTR);
+        if(n < 0) return errno == EAGAIN or errno == EWOULDBLOCK ? 0 : -1;
+        int datagrams = 0;
+        for(int i = 0; i < n; i++) {
+            const char* data = static_cast<const char*>(__iovs[i].iov_base);
+            size_t len = __msgs[i].msg_len;
+            size_t seg = len;
+            for(cmsghdr* cm = CMSG_FIRSTHDR(&__msgs[i].msg_hdr); cm; cm = CMSG_NXTHDR(&__msgs[i].msg_hdr, cm)) {
+                if(cm->cmsg_level == SOL_UDP and cm->cmsg_type == UDP_GRO) {
+                    int gso_size;
+                    memcpy(&gso_size, CMSG_DATA(cm), sizeof(gso_size));
+                    if(gso_size > 0) seg = static_cast<size_t>(gso_size);
+                }
+            }
+            // 合并交付时除最后一段外每段都是seg字节；len为0的空数据报也算一个
+            size_t off = 0;
+            do {
+                size_t part = std::min(seg, len - off);
+                fn(__addrs[i], data + off, part);
+                off += part;
+                datagrams++;
+            } while(off < len);
+        }
+        return datagrams;
+    }
+};
+
+#endif // UDP_OFFLOAD_H